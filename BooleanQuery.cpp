@@ -0,0 +1,432 @@
+/*
+ * The MIT License
+ *
+ * Copyright 2017 Theomeli.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+/* 
+ * File:   BooleanQuery.cpp
+ * Author: Theomeli
+ * 
+ * Created on October 26, 2026, 2:40 PM
+ */
+
+#include "BooleanQuery.h"
+#include "DocumentSets.h"
+#include "ProcessFiles.h"
+#include "TokenNormalizer.h"
+#include <algorithm>
+#include <numeric>
+
+/**
+ * it checks if a token is an operator which joins operands
+ */
+static bool isOperator(string_view token) {
+    size_t distance;
+    
+    return token == "AND" || token == "OR" || token == "NOT" || BooleanQuery::isNearOperator(token, distance);
+}
+
+
+/**
+ * it removes the parentheses which open a token and counts the ones which close it
+ * @param token is the token, set to what is left
+ * @param nOpening is set to the number of opening parentheses
+ * @param nClosing is set to the number of closing parentheses
+ */
+static void peelParentheses(string_view& token, size_t& nOpening, size_t& nClosing) {
+    nOpening = 0;
+    nClosing = 0;
+    while (!token.empty() && token.front() == '(') {
+        token.remove_prefix(1);
+        nOpening++;
+    }
+    while (!token.empty() && token.back() == ')') {
+        token.remove_suffix(1);
+        nClosing++;
+    }
+}
+
+
+BooleanQuery::BooleanQuery(string_view text, const Lexicon& lexicon, const TermDictionary* dictionary)
+    :next(0), depth(0), isParsed(true), root(NONE) {
+    //a phrase is one token, a double quote and its normalized words
+    //separated by blanks
+    string scratch, phrase;
+    vector<uint32_t> expansions;
+    bool isInPhrase = false;
+    size_t position = 0, nOpening, nClosing;
+    string_view token;
+    size_t nTokens = 0;
+    while (ProcessFiles::nextToken(text, position, text.size(), token)) {
+        if (++nTokens > MAX_TOKENS) {
+            isParsed = false;
+            tokens.clear();
+            return;
+        }
+        peelParentheses(token, nOpening, nClosing);
+        for (size_t i = 0; i < nOpening && !isInPhrase; i++)
+            tokens.push_back("(");
+        if (!isInPhrase && isOperator(token))
+            tokens.push_back(string(token));
+        else if (!token.empty()) {
+            bool isOpening = !isInPhrase && token.front() == '"';
+            bool isClosing = (isInPhrase || (isOpening && token.size() > 1)) && token.back() == '"';
+            string_view word = TokenNormalizer::normalize(token, scratch);
+            if (isOpening)
+                phrase = "\"";
+            if (isInPhrase || isOpening) {
+                if (!word.empty())
+                    phrase.append(phrase.size() > 1 ? " " : "").append(word);
+                if (isClosing && phrase.size() > 1)
+                    tokens.push_back(phrase);
+            }
+            //a prefix is the OR of its terms in parentheses, or a word
+            //which no document contains if it has none
+            else if (dictionary != nullptr && TermDictionary::isWildcard(word)) {
+                dictionary->findPrefix(word.substr(0, word.size() - 1), expansions);
+                tokens.push_back(expansions.empty() ? string(word) : "(");
+                for (size_t i = 0; i < expansions.size(); i++) {
+                    if (i > 0)
+                        tokens.push_back("OR");
+                    tokens.push_back(string(lexicon.getTerm(expansions[i])));
+                }
+                if (!expansions.empty())
+                    tokens.push_back(")");
+            }
+            else if (!word.empty())
+                tokens.push_back(string(word));
+            isInPhrase = (isInPhrase || isOpening) && !isClosing;
+        }
+        for (size_t i = 0; i < nClosing && !isInPhrase; i++)
+            tokens.push_back(")");
+    }
+    if (isInPhrase && phrase.size() > 1)
+        tokens.push_back(phrase);
+    
+    //a closing parenthesis which opens none ends an expression, and the
+    //expressions around it are joined by AND
+    vector<size_t> parts;
+    while (next < tokens.size()) {
+        size_t part = parseOr(lexicon, false);
+        if (part != NONE)
+            parts.push_back(part);
+        if (next < tokens.size() && tokens[next] == ")")
+            next++;
+    }
+    if (!isParsed) {
+        nodes.clear();
+        words.clear();
+    }
+    else if (parts.size() == 1)
+        root = parts[0];
+    else if (parts.size() > 1)
+        root = addNode(AND, parts);
+}
+
+
+BooleanQuery::~BooleanQuery() {
+}
+
+
+bool BooleanQuery::isNearOperator(string_view token, size_t& distance) {
+    const string_view prefix = "NEAR/";
+    if (token.size() <= prefix.size() || token.substr(0, prefix.size()) != prefix)
+        return false;
+    distance = 0;
+    for (auto const c : token.substr(prefix.size())) {
+        if (c < '0' || c > '9')
+            return false;
+        distance = distance * 10 + (c - '0');
+    }
+    
+    return true;
+}
+
+
+bool BooleanQuery::isBoolean(string_view text) {
+    size_t position = 0, nOpening, nClosing;
+    string_view token;
+    while (ProcessFiles::nextToken(text, position, text.size(), token)) {
+        peelParentheses(token, nOpening, nClosing);
+        if (token == "AND" || token == "OR" || token == "NOT")
+            return true;
+    }
+    
+    return false;
+}
+
+
+size_t BooleanQuery::addNode(Type type, vector<size_t> children, uint32_t termId, size_t distance) {
+    nodes.push_back(Node{ type, termId, distance, move(children) });
+    
+    return nodes.size() - 1;
+}
+
+
+size_t BooleanQuery::parseOr(const Lexicon& lexicon, bool isNegated) {
+    vector<size_t> children;
+    size_t child = parseAnd(lexicon, isNegated);
+    if (child != NONE)
+        children.push_back(child);
+    while (next < tokens.size() && tokens[next] == "OR") {
+        next++;
+        child = parseAnd(lexicon, isNegated);
+        if (child != NONE)
+            children.push_back(child);
+    }
+    if (children.empty())
+        return NONE;
+    
+    return children.size() == 1 ? children[0] : addNode(OR, children);
+}
+
+
+size_t BooleanQuery::parseAnd(const Lexicon& lexicon, bool isNegated) {
+    vector<size_t> children;
+    while (next < tokens.size() && tokens[next] != "OR" && tokens[next] != ")") {
+        if (tokens[next] == "AND") {
+            next++;
+            continue;
+        }
+        size_t child = parseNot(lexicon, isNegated);
+        if (child != NONE)
+            children.push_back(child);
+    }
+    if (children.empty())
+        return NONE;
+    
+    return children.size() == 1 ? children[0] : addNode(AND, children);
+}
+
+
+size_t BooleanQuery::parseNot(const Lexicon& lexicon, bool isNegated) {
+    //NOT NOT x is x, so only the parity of a chain is kept
+    bool isOdd = false;
+    for (; next < tokens.size() && tokens[next] == "NOT"; next++)
+        isOdd = !isOdd;
+    size_t child = parseNear(lexicon, isNegated != isOdd);
+    
+    return child == NONE || !isOdd ? child : addNode(NOT, vector<size_t>(1, child));
+}
+
+
+size_t BooleanQuery::parseNear(const Lexicon& lexicon, bool isNegated) {
+    size_t left = parsePrimary(lexicon, isNegated), distance;
+    //a NEAR/k of expressions which are not words or phrases is an AND,
+    //and a chain of them holds for each pair of neighbours
+    vector<size_t> pairs;
+    while (left != NONE && next < tokens.size() && isNearOperator(tokens[next], distance)) {
+        next++;
+        size_t right = parsePrimary(lexicon, isNegated);
+        if (right == NONE)
+            break;
+        bool isPositional = nodes[left].type <= PHRASE && nodes[right].type <= PHRASE;
+        pairs.push_back(addNode(isPositional ? NEAR : AND, vector<size_t>{ left, right }, 0, distance));
+        left = right;
+    }
+    if (pairs.empty())
+        return left;
+    
+    return pairs.size() == 1 ? pairs[0] : addNode(AND, pairs);
+}
+
+
+size_t BooleanQuery::parsePrimary(const Lexicon& lexicon, bool isNegated) {
+    if (next >= tokens.size())
+        return NONE;
+    const string& token = tokens[next++];
+    if (token == "(") {
+        if (++depth > MAX_DEPTH) {
+            isParsed = false;
+            next = tokens.size();
+            return NONE;
+        }
+        size_t node = parseOr(lexicon, isNegated);
+        if (next < tokens.size() && tokens[next] == ")")
+            next++;
+        depth--;
+        return node;
+    }
+    //an operator where an operand should be is left out
+    if (token == ")" || isOperator(token))
+        return NONE;
+    if (!isNegated)
+        words.append(token[0] == '"' ? token.substr(1) : token).append(" ");
+    if (token[0] != '"')
+        return addNode(TERM, vector<size_t>(), lexicon.find(token));
+    
+    vector<size_t> children;
+    size_t position = 1;
+    string_view word;
+    while (ProcessFiles::nextToken(token, position, token.size(), word))
+        children.push_back(addNode(TERM, vector<size_t>(), lexicon.find(word)));
+    
+    return addNode(PHRASE, children);
+}
+
+
+vector<uint32_t> BooleanQuery::getTermIds(size_t node) const {
+    vector<uint32_t> termIds;
+    if (nodes[node].type == TERM)
+        termIds.push_back(nodes[node].termId);
+    else
+        for (auto const child : nodes[node].children)
+            termIds.push_back(nodes[child].termId);
+    
+    return termIds;
+}
+
+
+void BooleanQuery::evaluate(const InvertedIndex& index, const PositionalIndex* positions, vector<uint32_t>& docIds) const {
+    docIds.clear();
+    if (root != NONE)
+        evaluate(root, index, positions, docIds);
+}
+
+
+void BooleanQuery::evaluate(size_t node, const InvertedIndex& index, const PositionalIndex* positions, 
+    vector<uint32_t>& docIds) const {
+    const Node& n = nodes[node];
+    vector<uint32_t> child, temp;
+    switch (n.type) {
+        case TERM:
+            if (n.termId < index.getNTerms())
+                index.getDocIds(n.termId, docIds);
+            else
+                docIds.clear();
+            break;
+        case PHRASE:
+            if (positions != nullptr && n.children.size() > 1)
+                docIds = positions->findPhrase(getTermIds(node));
+            else
+                evaluateAnd(n.children, index, positions, docIds);
+            break;
+        case NEAR:
+            if (positions != nullptr)
+                docIds = positions->findNear(getTermIds(n.children[0]), getTermIds(n.children[1]), n.distance);
+            else
+                evaluateAnd(n.children, index, positions, docIds);
+            break;
+        case AND:
+            evaluateAnd(n.children, index, positions, docIds);
+            break;
+        case OR:
+            docIds.clear();
+            for (auto const c : n.children) {
+                evaluate(c, index, positions, child);
+                DocumentSets::unite(docIds, child, temp);
+                docIds.swap(temp);
+            }
+            break;
+        case NOT:
+            evaluate(n.children[0], index, positions, child);
+            temp.resize(index.getNDocuments());
+            iota(temp.begin(), temp.end(), 1);
+            DocumentSets::subtract(temp, child, docIds);
+            break;
+    }
+}
+
+
+/**
+ * it keeps the documents which are or are not in a postings list, moving a
+ * cursor over the list to each of them, so that the blocks between are
+ * passed by their headers without being decoded
+ * @param cursor is the cursor on the list's first posting
+ * @param docIds are the ascending ids of the documents
+ * @param isFound is true to keep the documents in the list, false the others
+ */
+static void probe(PostingsCursor cursor, vector<uint32_t>& docIds, bool isFound) {
+    size_t n = 0;
+    for (auto const docId : docIds) {
+        cursor.nextGeq(docId);
+        if ((cursor.getDocId() == docId) == isFound)
+            docIds[n++] = docId;
+    }
+    docIds.resize(n);
+}
+
+
+void BooleanQuery::evaluateAnd(const vector<size_t>& children, const InvertedIndex& index, 
+    const PositionalIndex* positions, vector<uint32_t>& docIds) const {
+    //the negated children are subtracted once the others are intersected
+    vector<size_t> positives, negatives;
+    for (auto const c : children)
+        if (nodes[c].type == NOT)
+            negatives.push_back(nodes[c].children[0]);
+        else
+            positives.push_back(c);
+    
+    //a word's size is the length of its list, known without decoding it,
+    //and the other children are evaluated first to know theirs
+    vector<vector<uint32_t>> evaluated(positives.size());
+    vector<pair<size_t, size_t>> sizes;
+    for (size_t i = 0; i < positives.size(); i++) {
+        const Node& n = nodes[positives[i]];
+        if (n.type != TERM)
+            evaluate(positives[i], index, positions, evaluated[i]);
+        size_t size = n.type != TERM ? evaluated[i].size() : n.termId < index.getNTerms() ? index.getDocumentFrequency(n.termId) : 0;
+        sizes.push_back(make_pair(size, i));
+    }
+    sort(sizes.begin(), sizes.end());
+    
+    vector<uint32_t> list, temp;
+    if (sizes.empty()) {
+        docIds.resize(index.getNDocuments());
+        iota(docIds.begin(), docIds.end(), 1);
+    }
+    else if (nodes[positives[sizes[0].second]].type == TERM && sizes[0].first > 0)
+        index.getDocIds(nodes[positives[sizes[0].second]].termId, docIds);
+    else
+        docIds.swap(evaluated[sizes[0].second]);
+    for (size_t k = 1; k < sizes.size() && !docIds.empty(); k++) {
+        const Node& n = nodes[positives[sizes[k].second]];
+        //a much longer list is probed for the documents found so far
+        if (n.type == TERM && docIds.size() * DocumentSets::GALLOP_RATIO < sizes[k].first) {
+            probe(index.getCursor(n.termId), docIds, true);
+            continue;
+        }
+        if (n.type == TERM)
+            index.getDocIds(n.termId, list);
+        else
+            list.swap(evaluated[sizes[k].second]);
+        DocumentSets::intersect(docIds, list, temp);
+        docIds.swap(temp);
+    }
+    
+    for (size_t k = 0; k < negatives.size() && !docIds.empty(); k++) {
+        const Node& n = nodes[negatives[k]];
+        if (n.type == TERM && n.termId >= index.getNTerms())
+            continue;
+        if (n.type == TERM && docIds.size() * DocumentSets::GALLOP_RATIO < index.getDocumentFrequency(n.termId)) {
+            probe(index.getCursor(n.termId), docIds, false);
+            continue;
+        }
+        if (n.type == TERM)
+            index.getDocIds(n.termId, list);
+        else
+            evaluate(negatives[k], index, positions, list);
+        DocumentSets::subtract(docIds, list, temp);
+        docIds.swap(temp);
+    }
+}
@@ -0,0 +1,190 @@
+/*
+ * The MIT License
+ *
+ * Copyright 2017 Theomeli.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+/* 
+ * File:   BooleanQuery.h
+ * Author: Theomeli
+ *
+ * Created on October 26, 2026, 2:40 PM
+ */
+
+#ifndef BOOLEANQUERY_H
+#define BOOLEANQUERY_H
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "Lexicon.h"
+#include "TermDictionary.h"
+#include "InvertedIndex.h"
+#include "PositionalIndex.h"
+
+using namespace std;
+
+/**
+ * a query of Boolean operators over words, "quoted phrases" and words or
+ * phrases NEAR/k each other, such as (information OR data) AND NOT "data 
+ * mining". NOT binds tighter than AND and AND tighter than OR, and operands
+ * with no operator between them are joined by AND. A word ending with * may
+ * stand for the terms beginning with what comes before it, joined by OR. The query selects the
+ * documents which satisfy it from the postings lists, and they are ranked
+ * by their cosines to its words which are not negated. The lists of an AND
+ * are taken by ascending length, and each next one is probed for the
+ * documents found so far, skipping its blocks by their headers, when it is
+ * much longer, or decoded and intersected by DocumentSets otherwise
+ */
+class BooleanQuery {
+public:
+    //the most tokens of a text and the most parentheses open
+    //at once, beyond which a query is not parsed
+    static const size_t MAX_TOKENS = 1024;
+    static const size_t MAX_DEPTH = 64;
+    
+    /**
+     * it parses a query
+     * @param text is the text of the query
+     * @param lexicon gives the ids of the words
+     * @param dictionary gives the terms of the words ending with *, each
+     * such word standing for the OR of them, or nullptr to take them as words
+     */
+    BooleanQuery(string_view text, const Lexicon& lexicon, const TermDictionary* dictionary = nullptr);
+    BooleanQuery(const BooleanQuery& orig) = delete;
+    BooleanQuery& operator =(const BooleanQuery& rightSide) = delete;
+    virtual ~BooleanQuery();
+    
+    /**
+     * it checks if a text is a Boolean query, holding AND, OR or NOT
+     * @param text is the text
+     * @return true if one of its tokens, out of parentheses, is an operator
+     */
+    static bool isBoolean(string_view text);
+    
+    /**
+     * it checks if a token is a NEAR/k operator
+     * @param token is the token, not normalized
+     * @param distance is set to k
+     * @return true if the token is NEAR/ followed by digits
+     */
+    static bool isNearOperator(string_view token, size_t& distance);
+    
+    /**
+     * getter for private member isParsed
+     * @return false if the query has too many tokens or parentheses, when
+     * it selects no documents
+     */
+     bool getIsParsed() const { return isParsed; }
+    
+    /**
+     * getter for private member words
+     * @return the normalized words which are not negated, each followed
+     * by a blank
+     */
+     const string& getWords() const { return words; }
+    
+    /**
+     * it finds the documents which satisfy the query. Without positions a
+     * phrase or NEAR/k selects the documents which contain all their words
+     * @param index is the inverted index of the documents
+     * @param positions is the positional index of the documents or nullptr
+     * @param docIds is set to the ascending ids of the documents
+     */
+    void evaluate(const InvertedIndex& index, const PositionalIndex* positions, vector<uint32_t>& docIds) const;
+private:
+    //the kinds of the nodes of a query
+    enum Type { TERM, PHRASE, NEAR, AND, OR, NOT };
+    
+    /**
+     * a node of a query: a word, a phrase, whose children are its words, or
+     * an operator over its children. NEAR has two children, words or phrases
+     */
+    struct Node {
+        Type type;
+        uint32_t termId;
+        size_t distance;
+        vector<size_t> children;
+    };
+    
+    //the id of no node
+    static const size_t NONE = SIZE_MAX;
+    
+    //the tokens of the text, with the parentheses apart
+    vector<string>								tokens;
+    //the token being parsed
+    size_t									next;
+    //the parentheses open at the token being parsed
+    size_t									depth;
+    //false if the text is beyond MAX_TOKENS or MAX_DEPTH
+    bool									isParsed;
+    //the nodes of the query and the root among them
+    vector<Node>								nodes;
+    size_t									root;
+    //the normalized words which are not negated, each
+    //followed by a blank
+    string									words;
+    
+    /**
+     * they parse an OR of ANDs, an AND of negations, a negation, words or
+     * phrases NEAR/k each other and a word, a phrase or an expression in
+     * parentheses, from the token next on. A chain of NOT is parsed in a
+     * loop, and the parentheses deeper than MAX_DEPTH fail the query, so
+     * that the recursion is bounded
+     * @param isNegated is true under an odd number of NOT
+     * @return the node or NONE if there is nothing to parse
+     */
+    size_t parseOr(const Lexicon& lexicon, bool isNegated);
+    size_t parseAnd(const Lexicon& lexicon, bool isNegated);
+    size_t parseNot(const Lexicon& lexicon, bool isNegated);
+    size_t parseNear(const Lexicon& lexicon, bool isNegated);
+    size_t parsePrimary(const Lexicon& lexicon, bool isNegated);
+    
+    /**
+     * it adds a node
+     * @return its id
+     */
+    size_t addNode(Type type, vector<size_t> children = vector<size_t>(), uint32_t termId = 0, size_t distance = 0);
+    
+    /**
+     * it finds the documents which satisfy a node
+     * @param node is the id of the node
+     * @param docIds is set to their ascending ids
+     */
+    void evaluate(size_t node, const InvertedIndex& index, const PositionalIndex* positions, vector<uint32_t>& docIds) const;
+    
+    /**
+     * it finds the documents which satisfy all the children of an AND, the
+     * shortest lists first
+     */
+    void evaluateAnd(const vector<size_t>& children, const InvertedIndex& index, const PositionalIndex* positions, 
+        vector<uint32_t>& docIds) const;
+    
+    /**
+     * it finds the term ids of a word or a phrase
+     */
+    vector<uint32_t> getTermIds(size_t node) const;
+};
+
+#endif /* BOOLEANQUERY_H */
+
@@ -33,8 +33,13 @@
 
 using namespace std;
 
+/**
+ * it orders pairs document id - cosine as they are returned: by descending
+ * cosine and, for equal cosines, by ascending document id. As the comparison
+ * of a heap it keeps the pair returned last on top
+ */
 struct Compare {
-	bool operator()(pair<int, double> lhs, pair<int, double> rhs) const {
-		return lhs.second < rhs.second;
+	bool operator()(const pair<size_t, double>& lhs, const pair<size_t, double>& rhs) const {
+		return lhs.second > rhs.second || (lhs.second == rhs.second && lhs.first < rhs.first);
     }
 };
@@ -0,0 +1,172 @@
+/*
+ * The MIT License
+ *
+ * Copyright 2017 Theomeli.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+/* 
+ * File:   DocumentSets.cpp
+ * Author: Theomeli
+ * 
+ * Created on October 26, 2026, 10:05 AM
+ */
+
+#include "DocumentSets.h"
+#include <algorithm>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+DocumentSets::Kernel DocumentSets::kernel = DocumentSets::detectKernel();
+
+
+DocumentSets::Kernel DocumentSets::detectKernel() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse2"))
+        return SSE2;
+#endif
+    return SCALAR;
+}
+
+
+void DocumentSets::setKernel(Kernel k) {
+    Kernel best = detectKernel();
+    kernel = k < best ? k : best;
+}
+
+
+const uint32_t* DocumentSets::gallop(const uint32_t* begin, const uint32_t* end, uint32_t target) {
+    if (begin == end || *begin >= target)
+        return begin;
+    const uint32_t* low = begin;
+    size_t step = 1;
+    while (step < size_t(end - low) && low[step] < target) {
+        low += step;
+        step *= 2;
+    }
+    
+    return lower_bound(low + 1, step < size_t(end - low) ? low + step : end, target);
+}
+
+
+void DocumentSets::intersect(const vector<uint32_t>& a, const vector<uint32_t>& b, vector<uint32_t>& out) {
+    out.resize(min(a.size(), b.size()));
+    size_t n;
+    if (a.size() > b.size() * GALLOP_RATIO)
+        n = intersectGallop(b.data(), b.size(), a.data(), a.size(), out.data());
+    else if (b.size() > a.size() * GALLOP_RATIO)
+        n = intersectGallop(a.data(), a.size(), b.data(), b.size(), out.data());
+#if defined(__x86_64__) || defined(__i386__)
+    else if (kernel == SSE2)
+        n = intersectSse2(a.data(), a.size(), b.data(), b.size(), out.data());
+#endif
+    else
+        n = intersectScalar(a.data(), a.size(), b.data(), b.size(), out.data());
+    out.resize(n);
+}
+
+
+void DocumentSets::unite(const vector<uint32_t>& a, const vector<uint32_t>& b, vector<uint32_t>& out) {
+    out.resize(a.size() + b.size());
+    out.erase(set_union(a.begin(), a.end(), b.begin(), b.end(), out.begin()), out.end());
+}
+
+
+void DocumentSets::subtract(const vector<uint32_t>& a, const vector<uint32_t>& b, vector<uint32_t>& out) {
+    out.clear();
+    //the ids of a are galloped to in a much larger b
+    if (b.size() > a.size() * GALLOP_RATIO) {
+        const uint32_t* position = b.data();
+        const uint32_t* end = b.data() + b.size();
+        for (auto const docId : a) {
+            position = gallop(position, end, docId);
+            if (position == end || *position != docId)
+                out.push_back(docId);
+        }
+        return;
+    }
+    out.resize(a.size());
+    out.erase(set_difference(a.begin(), a.end(), b.begin(), b.end(), out.begin()), out.end());
+}
+
+
+size_t DocumentSets::intersectGallop(const uint32_t* small, size_t nSmall, const uint32_t* large, size_t nLarge, 
+    uint32_t* out) {
+    size_t o = 0;
+    const uint32_t* position = large;
+    const uint32_t* end = large + nLarge;
+    for (size_t i = 0; i < nSmall && position != end; i++) {
+        position = gallop(position, end, small[i]);
+        if (position != end && *position == small[i])
+            out[o++] = small[i];
+    }
+    
+    return o;
+}
+
+
+size_t DocumentSets::intersectScalar(const uint32_t* a, size_t nA, const uint32_t* b, size_t nB, uint32_t* out) {
+    size_t i = 0, j = 0, o = 0;
+    while (i < nA && j < nB) {
+        if (a[i] < b[j])
+            i++;
+        else if (b[j] < a[i])
+            j++;
+        else {
+            out[o++] = a[i];
+            i++;
+            j++;
+        }
+    }
+    
+    return o;
+}
+
+
+#if defined(__x86_64__) || defined(__i386__)
+__attribute__((target("sse2")))
+size_t DocumentSets::intersectSse2(const uint32_t* a, size_t nA, const uint32_t* b, size_t nB, uint32_t* out) {
+    size_t i = 0, j = 0, o = 0;
+    //a block of four ids of a is compared with the four rotations of a
+    //block of b, and the block whose last id is less is passed
+    while (i + 4 <= nA && j + 4 <= nB) {
+        __m128i va = _mm_loadu_si128((const __m128i*)(a + i));
+        __m128i vb = _mm_loadu_si128((const __m128i*)(b + j));
+        __m128i equal = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi32(va, vb), _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(0, 3, 2, 1)))),
+            _mm_or_si128(_mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(1, 0, 3, 2))), 
+                _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(2, 1, 0, 3)))));
+        unsigned mask = _mm_movemask_ps(_mm_castsi128_ps(equal));
+        for (size_t k = 0; mask != 0; k++, mask >>= 1)
+            if (mask & 1)
+                out[o++] = a[i + k];
+        uint32_t lastA = a[i + 3], lastB = b[j + 3];
+        if (lastA <= lastB)
+            i += 4;
+        if (lastB <= lastA)
+            j += 4;
+    }
+    
+    return o + intersectScalar(a + i, nA - i, b + j, nB - j, out + o);
+}
+#endif
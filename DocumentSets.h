@@ -0,0 +1,138 @@
+/*
+ * The MIT License
+ *
+ * Copyright 2017 Theomeli.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+/* 
+ * File:   DocumentSets.h
+ * Author: Theomeli
+ *
+ * Created on October 26, 2026, 10:05 AM
+ */
+
+#ifndef DOCUMENTSETS_H
+#define DOCUMENTSETS_H
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+using namespace std;
+
+/**
+ * it intersects, unites and subtracts sets of documents, each the ascending
+ * ids of its documents without repeats. When one set is much smaller than
+ * the other its ids are galloped to in the larger one, so that the cost
+ * follows the smaller set. Sets of similar sizes are merged instead, on x86
+ * comparing blocks of four ids of each set at once with SSE2, chosen once
+ * at runtime
+ */
+class DocumentSets {
+public:
+    //the ratio of the sizes of two sets above which the
+    //smaller one is galloped to in the larger
+    static const size_t GALLOP_RATIO = 32;
+    
+    //the kernels which may merge two sets
+    enum Kernel { SCALAR, SSE2 };
+    
+    /**
+     * getter for the kernel chosen for this processor
+     * @return the kernel used by intersect
+     */
+     static Kernel getKernel() { return kernel; }
+    
+    /**
+     * it chooses the kernel used by intersect. A kernel the processor does
+     * not support falls back to the best one it supports
+     * @param k is the kernel to be used
+     */
+    static void setKernel(Kernel k);
+    
+    /**
+     * it finds the first of ascending values which is not less than target,
+     * doubling its steps from begin before a binary search between the last
+     * two, so that it costs the logarithm of the distance it moves
+     * @param begin is the first value
+     * @param end is the end of the values
+     * @param target is the value looked for
+     * @return the value's position or end
+     */
+    static const uint32_t* gallop(const uint32_t* begin, const uint32_t* end, uint32_t target);
+    
+    /**
+     * it finds the documents of both sets
+     * @param a is a set
+     * @param b is a set
+     * @param out is set to the intersection. It must be neither a nor b
+     */
+    static void intersect(const vector<uint32_t>& a, const vector<uint32_t>& b, vector<uint32_t>& out);
+    
+    /**
+     * it finds the documents of either set
+     * @param a is a set
+     * @param b is a set
+     * @param out is set to the union. It must be neither a nor b
+     */
+    static void unite(const vector<uint32_t>& a, const vector<uint32_t>& b, vector<uint32_t>& out);
+    
+    /**
+     * it finds the documents of a set which are not in another
+     * @param a is the set
+     * @param b is the set of the documents left out
+     * @param out is set to the difference. It must be neither a nor b
+     */
+    static void subtract(const vector<uint32_t>& a, const vector<uint32_t>& b, vector<uint32_t>& out);
+private:
+    //the kernel chosen for this processor
+    static Kernel								kernel;
+    
+    /**
+     * it intersects a small set with a much larger one by galloping
+     * @param small are the ids of the small set
+     * @param nSmall is their number
+     * @param large are the ids of the large set
+     * @param nLarge is their number
+     * @param out is where the common ids are written
+     * @return the number of common ids
+     */
+    static size_t intersectGallop(const uint32_t* small, size_t nSmall, const uint32_t* large, size_t nLarge, 
+        uint32_t* out);
+    
+    /**
+     * the kernels of intersect for sets of similar sizes, with the same
+     * parameters as intersectGallop
+     */
+    static size_t intersectScalar(const uint32_t* a, size_t nA, const uint32_t* b, size_t nB, uint32_t* out);
+#if defined(__x86_64__) || defined(__i386__)
+    static size_t intersectSse2(const uint32_t* a, size_t nA, const uint32_t* b, size_t nB, uint32_t* out);
+#endif
+    
+    /**
+     * it finds the best kernel the processor supports
+     * @return the kernel
+     */
+    static Kernel detectKernel();
+};
+
+#endif /* DOCUMENTSETS_H */
+
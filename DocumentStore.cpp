@@ -0,0 +1,197 @@
+/*
+ * The MIT License
+ *
+ * Copyright 2017 Theomeli.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+/* 
+ * File:   DocumentStore.cpp
+ * Author: Theomeli
+ * 
+ * Created on October 22, 2026, 11:30 AM
+ */
+
+#include "DocumentStore.h"
+#include "TextCodec.h"
+#include "Instrumentation.h"
+#include <algorithm>
+
+DocumentStore::DocumentStore(): nDocuments(0), nBlocks(0), offsets(1, 0), blockDocuments(1, 0), blockOffsets(1, 0), 
+    isAttached(false), clock(0) {
+    refreshViews();
+}
+
+
+DocumentStore::DocumentStore(DocumentStore&& orig): DocumentStore() {
+    *this = move(orig);
+}
+
+
+DocumentStore& DocumentStore::operator =(DocumentStore&& rightSide) {
+    nDocuments = rightSide.nDocuments;
+    nBlocks = rightSide.nBlocks;
+    offsets = move(rightSide.offsets);
+    blockDocuments = move(rightSide.blockDocuments);
+    blockOffsets = move(rightSide.blockOffsets);
+    data = move(rightSide.data);
+    isAttached = rightSide.isAttached;
+    offsetsView = rightSide.offsetsView;
+    blockDocumentsView = rightSide.blockDocumentsView;
+    blockOffsetsView = rightSide.blockOffsetsView;
+    dataView = rightSide.dataView;
+    if (!isAttached)
+        refreshViews();
+    {
+        lock_guard<mutex> guard(lock);
+        cache.clear();
+    }
+    //the moved store is left empty
+    rightSide.nDocuments = 0;
+    rightSide.nBlocks = 0;
+    rightSide.offsets.assign(1, 0);
+    rightSide.blockDocuments.assign(1, 0);
+    rightSide.blockOffsets.assign(1, 0);
+    rightSide.data.clear();
+    rightSide.isAttached = false;
+    rightSide.refreshViews();
+    lock_guard<mutex> guard(rightSide.lock);
+    rightSide.cache.clear();
+    
+    return *this;
+}
+
+
+DocumentStore::~DocumentStore() {
+}
+
+
+void DocumentStore::refreshViews() {
+    offsetsView = offsets.data();
+    blockDocumentsView = blockDocuments.data();
+    blockOffsetsView = blockOffsets.data();
+    dataView = data.data();
+}
+
+
+size_t DocumentStore::getMemoryUsage() const {
+    size_t bytes = (offsets.capacity() + blockDocuments.capacity() + blockOffsets.capacity()) * sizeof(uint64_t) 
+        + data.capacity();
+    lock_guard<mutex> guard(lock);
+    for (auto const &cached : cache)
+        bytes += sizeof(CachedBlock) + cached.text.capacity();
+    
+    return bytes;
+}
+
+
+void DocumentStore::build(const TokenArena& texts, QueryExecutor& executor) {
+    INSTRUMENT_PHASE(BUILD_DOCUMENT_STORE);
+    nDocuments = texts.size();
+    offsets.assign(texts.getOffsets(), texts.getOffsets() + nDocuments + 1);
+    blockDocuments.assign(1, 0);
+    for (size_t docId = 0; docId < nDocuments; docId++)
+        if (offsets[docId + 1] - offsets[blockDocuments.back()] >= BLOCK_SIZE)
+            blockDocuments.push_back(docId + 1);
+    if (blockDocuments.back() != nDocuments)
+        blockDocuments.push_back(nDocuments);
+    nBlocks = blockDocuments.size() - 1;
+    
+    vector<vector<uint8_t>> blocks(nBlocks);
+    string_view characters = texts.getCharacters();
+    executor.run(nBlocks, [&](size_t block, size_t /*worker*/) {
+        uint64_t start = offsets[blockDocuments[block]], end = offsets[blockDocuments[block + 1]];
+        TextCodec::compress(characters.data() + start, end - start, blocks[block]);
+    });
+    blockOffsets.assign(nBlocks + 1, 0);
+    for (size_t block = 0; block < nBlocks; block++)
+        blockOffsets[block + 1] = blockOffsets[block] + blocks[block].size();
+    data.clear();
+    data.reserve(blockOffsets[nBlocks]);
+    for (auto &block : blocks) {
+        data.insert(data.end(), block.begin(), block.end());
+        vector<uint8_t>().swap(block);
+    }
+    isAttached = false;
+    refreshViews();
+    lock_guard<mutex> guard(lock);
+    cache.clear();
+}
+
+
+void DocumentStore::attach(size_t nDocuments, size_t nBlocks, const uint64_t* offsets, const uint64_t* blockDocuments, 
+    const uint64_t* blockOffsets, const uint8_t* data) {
+    this->nDocuments = nDocuments;
+    this->nBlocks = nBlocks;
+    vector<uint64_t>().swap(this->offsets);
+    vector<uint64_t>().swap(this->blockDocuments);
+    vector<uint64_t>().swap(this->blockOffsets);
+    vector<uint8_t>().swap(this->data);
+    isAttached = true;
+    offsetsView = offsets;
+    blockDocumentsView = blockDocuments;
+    blockOffsetsView = blockOffsets;
+    dataView = data;
+    lock_guard<mutex> guard(lock);
+    cache.clear();
+}
+
+
+string_view DocumentStore::getDocument(size_t docId, string& text) const {
+    text.clear();
+    if (docId >= nDocuments)
+        return text;
+    size_t block = upper_bound(blockDocumentsView, blockDocumentsView + nBlocks + 1, docId) - blockDocumentsView - 1;
+    uint64_t blockStart = offsetsView[blockDocumentsView[block]];
+    uint64_t start = offsetsView[docId] - blockStart, length = offsetsView[docId + 1] - offsetsView[docId];
+    {
+        lock_guard<mutex> guard(lock);
+        for (auto &cached : cache)
+            if (cached.block == block) {
+                cached.lastUse = ++clock;
+                text.assign(cached.text, start, length);
+                return text;
+            }
+    }
+    
+    //the block is decompressed out of the lock, so that the threads
+    //reading other blocks do not wait for it
+    INSTRUMENT_COUNT(BLOCKS_DECOMPRESSED, 1);
+    string decompressed(offsetsView[blockDocumentsView[block + 1]] - blockStart, '\0');
+    if (!TextCodec::decompress(dataView + blockOffsetsView[block], blockOffsetsView[block + 1] - blockOffsetsView[block], 
+        &decompressed[0], decompressed.size()))
+        return text;
+    text.assign(decompressed, start, length);
+    
+    lock_guard<mutex> guard(lock);
+    for (auto const &cached : cache)
+        if (cached.block == block)
+            return text;
+    CachedBlock fresh = { block, move(decompressed), ++clock };
+    if (cache.size() < N_CACHED_BLOCKS)
+        cache.push_back(move(fresh));
+    else
+        *min_element(cache.begin(), cache.end(), [](const CachedBlock& a, const CachedBlock& b) { 
+            return a.lastUse < b.lastUse; 
+        }) = move(fresh);
+    
+    return text;
+}
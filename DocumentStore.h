@@ -0,0 +1,170 @@
+/*
+ * The MIT License
+ *
+ * Copyright 2017 Theomeli.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+/* 
+ * File:   DocumentStore.h
+ * Author: Theomeli
+ *
+ * Created on October 22, 2026, 11:30 AM
+ */
+
+#ifndef DOCUMENTSTORE_H
+#define DOCUMENTSTORE_H
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "TokenArena.h"
+#include "QueryExecutor.h"
+
+using namespace std;
+
+/**
+ * the texts of the documents, kept only to be displayed with the results.
+ * The documents are cut in blocks of consecutive ids, of at least BLOCK_SIZE
+ * bytes each unless they are the last ones, and each block is compressed by
+ * TextCodec. An offset table holds the start of each document in the texts
+ * one after the other and the first document of each block, so a document is
+ * read by decompressing the block which holds it only. The last blocks read
+ * are kept decompressed in a small cache, shared by the threads reading them
+ */
+class DocumentStore {
+public:
+    //the least number of bytes of the texts of a block
+    static const size_t BLOCK_SIZE = 1 << 14;
+    //the number of decompressed blocks which are kept
+    static const size_t N_CACHED_BLOCKS = 16;
+    
+    DocumentStore();
+    DocumentStore(const DocumentStore& orig) = delete;
+    DocumentStore& operator =(const DocumentStore& rightSide) = delete;
+    DocumentStore(DocumentStore&& orig);
+    DocumentStore& operator =(DocumentStore&& rightSide);
+    virtual ~DocumentStore();
+    
+    /**
+     * getter for private member nDocuments
+     * @return the number of documents, document 0 included
+     */
+     size_t size() const { return nDocuments; }
+    
+    /**
+     * getter for private member nBlocks
+     * @return the number of blocks
+     */
+     size_t getNBlocks() const { return nBlocks; }
+    
+    /**
+     * getters for the storage of the store, so that it can be written to a
+     * file and attached again. Offsets have size() + 1 entries, the start of
+     * each document in the uncompressed texts and their end, block documents 
+     * and block offsets getNBlocks() + 1, the first document of each block
+     * and size(), and the start of each block in the compressed data and
+     * its end
+     */
+     const uint64_t* getOffsets() const { return offsetsView; }
+     const uint64_t* getBlockDocuments() const { return blockDocumentsView; }
+     const uint64_t* getBlockOffsets() const { return blockOffsetsView; }
+     const uint8_t* getData() const { return dataView; }
+     size_t getDataSize() const { return blockOffsetsView[nBlocks]; }
+    
+    /**
+     * it computes the bytes which the store takes, the cache included
+     * @return the bytes of its storage
+     */
+    size_t getMemoryUsage() const;
+    
+    /**
+     * it compresses the texts of a finished arena, a block of them by
+     * each task of executor
+     * @param texts are the texts of the documents by document id
+     * @param executor is the pool of threads which compresses the blocks
+     */
+    void build(const TokenArena& texts, QueryExecutor& executor);
+    
+    /**
+     * it makes the store use storage which it does not own, such as a
+     * memory mapped index file, without copying it. The storage must
+     * outlive the store and have the layout of the getters above
+     */
+    void attach(size_t nDocuments, size_t nBlocks, const uint64_t* offsets, const uint64_t* blockDocuments, 
+        const uint64_t* blockOffsets, const uint8_t* data);
+    
+    /**
+     * it reads the text of a document, decompressing its block unless
+     * the block is cached. It may be called by many threads at once
+     * @param docId is the id of the document
+     * @param text is set to the text of the document
+     * @return a view of text, empty if the block is corrupted
+     */
+    string_view getDocument(size_t docId, string& text) const;
+private:
+    //a decompressed block
+    struct CachedBlock {
+        size_t								block;
+        string								text;
+        //the value of clock when it was last read
+        uint64_t							lastUse;
+    };
+    
+    //number of documents, document 0 included
+    size_t									nDocuments;
+    //number of blocks
+    size_t									nBlocks;
+    //the start of each document in the uncompressed
+    //texts followed by the end of the last one
+    vector<uint64_t>							offsets;
+    //the first document of each block followed by nDocuments
+    vector<uint64_t>							blockDocuments;
+    //the start of each block in data followed by the
+    //end of the last one
+    vector<uint64_t>							blockOffsets;
+    //the compressed blocks one after the other
+    vector<uint8_t>								data;
+    //true if the views below point to storage which
+    //the store does not own
+    bool									isAttached;
+    //the storage which reads use, either the members
+    //above or an attached one
+    const uint64_t*								offsetsView;
+    const uint64_t*								blockDocumentsView;
+    const uint64_t*								blockOffsetsView;
+    const uint8_t*								dataView;
+    //it guards the cache
+    mutable mutex								lock;
+    //the blocks read last
+    mutable vector<CachedBlock>						cache;
+    //it counts the reads of the cache
+    mutable uint64_t							clock;
+    
+    /**
+     * it points the views to the store's own storage
+     */
+    void refreshViews();
+};
+
+#endif /* DOCUMENTSTORE_H */
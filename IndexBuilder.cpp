@@ -0,0 +1,142 @@
+/*
+ * The MIT License
+ *
+ * Copyright 2017 Theomeli.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/* 
+ * File:   IndexBuilder.cpp
+ * Author: Theomeli
+ * 
+ * Created on October 17, 2026, 11:05 AM
+ */
+
+#include "IndexBuilder.h"
+#include <algorithm>
+
+IndexBuilder::IndexBuilder(): nDocuments(0), currentDocId(0), isOpen(false), isUnsorted(false) {
+}
+
+
+IndexBuilder::~IndexBuilder() {
+}
+
+
+void IndexBuilder::setNDocuments(size_t nDocuments) {
+    this->nDocuments = nDocuments;
+    currentDocId = 0;
+    isOpen = false;
+    isUnsorted = false;
+    lexicon = Lexicon();
+    currentFrequencies.clear();
+    currentTerms.clear();
+    termFrequencies.clear();
+    maxFrequencies.clear();
+    maxFrequencies.reserve(nDocuments);
+}
+
+
+Lexicon IndexBuilder::releaseLexicon() {
+    return move(lexicon);
+}
+
+
+vector<vector<pair<size_t, size_t>>> IndexBuilder::releaseTermFrequencies() {
+    vector<vector<pair<size_t, size_t>>> released;
+    released.swap(termFrequencies);
+    return released;
+}
+
+
+void IndexBuilder::clear() {
+    setNDocuments(0);
+    vector<size_t>().swap(currentFrequencies);
+    vector<uint32_t>().swap(currentTerms);
+    vector<vector<pair<size_t, size_t>>>().swap(termFrequencies);
+    vector<pair<size_t, size_t>>().swap(maxFrequencies);
+}
+
+
+void IndexBuilder::startDocument(size_t docId) {
+    if (isOpen)
+        closeDocument();
+    if (docId < currentDocId)
+        isUnsorted = true;
+    currentDocId = docId;
+    isOpen = true;
+}
+
+
+void IndexBuilder::addToken(string_view token) {
+    //tokens before the first document id belong to no document
+    if (!isOpen)
+        return;
+    
+    uint32_t termId = lexicon.intern(token);
+    if (termId >= currentFrequencies.size()) {
+        currentFrequencies.resize(lexicon.size(), 0);
+        termFrequencies.resize(lexicon.size());
+    }
+    if (currentFrequencies[termId]++ == 0)
+        currentTerms.push_back(termId);
+}
+
+
+void IndexBuilder::finish() {
+    if (isOpen)
+        closeDocument();
+    isOpen = false;
+    
+    if (isUnsorted)
+        for (auto &ent1 : termFrequencies)
+            sort(ent1.begin(), ent1.end());
+}
+
+
+void IndexBuilder::merge(const IndexBuilder& partial) {
+    const Lexicon& terms = partial.getLexicon();
+    for (uint32_t termId = 0; termId < terms.size(); termId++) {
+        uint32_t globalId = lexicon.intern(terms.getTerm(termId));
+        if (globalId >= termFrequencies.size())
+            termFrequencies.resize(lexicon.size());
+        
+        const vector<pair<size_t, size_t>>& pairs = partial.getTermFrequencies()[termId];
+        vector<pair<size_t, size_t>>& globalPairs = termFrequencies[globalId];
+        if (!globalPairs.empty() && !pairs.empty() && pairs.front().first < globalPairs.back().first)
+            isUnsorted = true;
+        globalPairs.insert(globalPairs.end(), pairs.begin(), pairs.end());
+    }
+    
+    maxFrequencies.insert(maxFrequencies.end(), partial.getMaxFrequencies().begin(), partial.getMaxFrequencies().end());
+}
+
+
+void IndexBuilder::closeDocument() {
+    //the most often term of an empty document counts as one
+    size_t maxFrequency = 1;
+    for (auto const &termId : currentTerms) {
+        termFrequencies[termId].push_back(make_pair(currentDocId, currentFrequencies[termId]));
+        maxFrequency = max(currentFrequencies[termId], maxFrequency);
+        currentFrequencies[termId] = 0;
+    }
+    currentTerms.clear();
+    maxFrequencies.push_back(make_pair(currentDocId, maxFrequency));
+}
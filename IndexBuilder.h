@@ -0,0 +1,156 @@
+/*
+ * The MIT License
+ *
+ * Copyright 2017 Theomeli.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/* 
+ * File:   IndexBuilder.h
+ * Author: Theomeli
+ *
+ * Created on October 17, 2026, 11:05 AM
+ */
+
+#ifndef INDEXBUILDER_H
+#define INDEXBUILDER_H
+#include "Lexicon.h"
+#include <string>
+#include <vector>
+
+using namespace std;
+
+class IndexBuilder {
+public:
+    IndexBuilder();
+    virtual ~IndexBuilder();
+    
+    /**
+     * getter for private member nDocuments
+     * @return the number of documents
+     */
+     size_t getNDocuments() const { return nDocuments; }
+    
+    /**
+     * getter for private member lexicon
+     * @return the lexicon of the documents' terms
+     */
+     const Lexicon& getLexicon() const { return lexicon; }
+    
+    /**
+     * getter for private member termFrequencies
+     * @return for each term id the pairs document id - frequency
+     */
+     const vector<vector<pair<size_t, size_t>>>& getTermFrequencies() const { return termFrequencies; }
+    
+    /**
+     * getter for private member maxFrequencies
+     * @return the pairs document id - frequency of its most often term,
+     * in the order the documents were read
+     */
+     const vector<pair<size_t, size_t>>& getMaxFrequencies() const { return maxFrequencies; }
+    
+    /**
+     * it sets the number of documents which will be streamed and resets
+     * the counts of a previous stream. A partial builder which counts a 
+     * part of the documents may be given zero
+     * @param nDocuments is the number of documents
+     */
+    void setNDocuments(size_t nDocuments);
+    
+    /**
+     * it closes the current document, if any, and starts counting the
+     * tokens of a new one
+     * @param docId is the id of the new document
+     */
+    void startDocument(size_t docId);
+    
+    /**
+     * it counts a token of the current document
+     * @param token is the normalized token
+     */
+    void addToken(string_view token);
+    
+    /**
+     * it closes the last document. Every term's pairs are sorted by 
+     * document id after it is called, so the document frequency of a
+     * term is the number of its pairs
+     */
+    void finish();
+    
+    /**
+     * it appends the counts of a finished partial builder. The partial 
+     * builder's term ids are mapped to this builder's lexicon, so merging
+     * the partials in the order of their documents gives the same ids as
+     * counting all documents with one builder. finish must be called 
+     * after the last merge
+     * @param partial is the builder which counted a part of the documents
+     */
+    void merge(const IndexBuilder& partial);
+    
+    /**
+     * it moves the lexicon out of the builder, which is left without terms
+     * @return the lexicon of the documents' terms
+     */
+    Lexicon releaseLexicon();
+    
+    /**
+     * it moves the pairs of every term out of the builder, which is left 
+     * without them, so that the postings are not copied into the index
+     * @return for each term id the pairs document id - frequency
+     */
+    vector<vector<pair<size_t, size_t>>> releaseTermFrequencies();
+    
+    /**
+     * it frees all the counts, once the index has been built from them
+     */
+    void clear();
+private:
+    //number of documents
+    size_t									nDocuments;
+    //the id of the document whose tokens are counted
+    size_t									currentDocId;
+    //true if a document has been started and not closed
+    bool									isOpen;
+    //true if documents arrived out of order
+    bool									isUnsorted;
+    //it gives an id to each term of the documents
+    Lexicon									lexicon;
+    //for each term id its frequency in the current
+    //document
+    vector<size_t>								currentFrequencies;
+    //the ids of the terms of the current document
+    vector<uint32_t>							currentTerms;
+    //for each term id the pairs document id - frequency
+    //of the documents which contain it
+    vector<vector<pair<size_t, size_t>>>					termFrequencies;
+    //for each document the pair document id - 
+    //frequency of its most often appeared term
+    vector<pair<size_t, size_t>>						maxFrequencies;
+    
+    /**
+     * it moves the counts of the current document to termFrequencies 
+     * and maxFrequencies
+     */
+    void closeDocument();
+};
+
+#endif /* INDEXBUILDER_H */
+
@@ -0,0 +1,189 @@
+/*
+ * The MIT License
+ *
+ * Copyright 2017 Theomeli.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/* 
+ * File:   IndexFile.cpp
+ * Author: Theomeli
+ * 
+ * Created on October 18, 2026, 2:10 PM
+ */
+
+#include "IndexFile.h"
+#include <cstddef>
+#include <cstring>
+#include <fstream>
+
+//the magic bytes every index file starts with
+static const char MAGIC[8] = { 'T', 'R', 'E', 'I', 'N', 'D', 'E', 'X' };
+//the byte order mark, read back reversed on a machine of other byte order
+static const uint32_t ORDER_MARK = 0x01020304;
+//sections start at offsets which are a multiple of this
+static const size_t ALIGNMENT = 64;
+
+
+IndexFile::IndexFile(): header(nullptr) {
+}
+
+
+IndexFile::~IndexFile() {
+}
+
+
+uint64_t IndexFile::checksum(const char* data, size_t size) {
+    uint64_t h = 14695981039346656037ULL;
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        uint64_t word;
+        memcpy(&word, data + i, 8);
+        h = (h ^ word) * 1099511628211ULL;
+    }
+    for (; i < size; i++)
+        h = (h ^ (unsigned char)data[i]) * 1099511628211ULL;
+    
+    return h;
+}
+
+
+bool IndexFile::save(const string& fileName, const Lexicon& lexicon, const InvertedIndex& index, 
+    const DocumentStore& documents) {
+    size_t nDocuments = index.getNDocuments();
+    size_t nTerms = index.getNTerms();
+    
+    string_view characters = lexicon.getCharacters();
+    struct { const char* data; size_t size; } contents[N_SECTIONS] = {
+        { characters.data(), characters.size() },
+        { (const char*)lexicon.getOffsets(), (lexicon.size() + 1) * sizeof(uint64_t) },
+        { (const char*)lexicon.getSlots(), lexicon.getNSlots() * sizeof(uint32_t) },
+        { (const char*)index.getOffsets(), (nTerms + 1) * sizeof(uint64_t) },
+        { (const char*)index.getDocumentFrequencies(), nTerms * sizeof(uint32_t) },
+        { (const char*)index.getMaxImpacts(), nTerms * sizeof(float) },
+        { (const char*)index.getPostingsData(), index.getPostingsSize() },
+        { (const char*)index.getNorms(), (nDocuments + 1) * sizeof(double) },
+        { (const char*)index.getIdfs(), nTerms * sizeof(double) },
+        { (const char*)index.getMaxFrequencies(), (nDocuments + 1) * sizeof(uint64_t) },
+        { (const char*)documents.getOffsets(), (documents.size() + 1) * sizeof(uint64_t) },
+        { (const char*)documents.getBlockDocuments(), (documents.getNBlocks() + 1) * sizeof(uint64_t) },
+        { (const char*)documents.getBlockOffsets(), (documents.getNBlocks() + 1) * sizeof(uint64_t) },
+        { (const char*)documents.getData(), documents.getDataSize() }
+    };
+    
+    Header temp;
+    memset(&temp, 0, sizeof(temp));
+    memcpy(temp.magic, MAGIC, sizeof(MAGIC));
+    temp.version = VERSION;
+    temp.byteOrder = ORDER_MARK;
+    temp.nDocuments = nDocuments;
+    temp.nTerms = nTerms;
+    temp.postingsSize = index.getPostingsSize();
+    temp.nSlots = lexicon.getNSlots();
+    temp.nStoredDocuments = documents.size();
+    temp.nBlocks = documents.getNBlocks();
+    uint64_t offset = (sizeof(Header) + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+    for (size_t i = 0; i < N_SECTIONS; i++) {
+        temp.sections[i].offset = offset;
+        temp.sections[i].size = contents[i].size;
+        temp.sections[i].checksum = checksum(contents[i].data, contents[i].size);
+        offset = (offset + contents[i].size + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+    }
+    temp.checksum = checksum((const char*)&temp, offsetof(Header, checksum));
+    
+    ofstream stream(fileName, ios::binary | ios::trunc);
+    if (stream.fail())
+        return false;
+    const char padding[ALIGNMENT] = { 0 };
+    stream.write((const char*)&temp, sizeof(temp));
+    stream.write(padding, temp.sections[0].offset - sizeof(temp));
+    for (size_t i = 0; i < N_SECTIONS; i++) {
+        stream.write(contents[i].data, contents[i].size);
+        uint64_t end = i + 1 < N_SECTIONS ? temp.sections[i + 1].offset : offset;
+        stream.write(padding, end - temp.sections[i].offset - contents[i].size);
+    }
+    stream.close();
+    
+    return !stream.fail();
+}
+
+
+bool IndexFile::load(const string& fileName, bool isVerified) {
+    header = nullptr;
+    mapping.open(fileName);
+    if (mapping.fail()) {
+        error = "index file opening failed.";
+        return false;
+    }
+    
+    string_view file = mapping.getView();
+    const Header* temp = reinterpret_cast<const Header*>(file.data());
+    if (file.size() < sizeof(Header) || memcmp(temp->magic, MAGIC, sizeof(MAGIC)) != 0) {
+        error = "not an index file.";
+        return false;
+    }
+    if (temp->byteOrder != ORDER_MARK) {
+        error = "index file written with another byte order.";
+        return false;
+    }
+    if (temp->version != VERSION) {
+        error = "index file of version " + to_string(temp->version) + ", expected " + to_string(VERSION) + '.';
+        return false;
+    }
+    if (temp->checksum != checksum(file.data(), offsetof(Header, checksum))) {
+        error = "index file header is corrupted.";
+        return false;
+    }
+    
+    //every section must lie in the file and be as large as the header says
+    uint64_t expected[N_SECTIONS] = {
+        temp->sections[TERM_CHARACTERS].size, (temp->nTerms + 1) * sizeof(uint64_t), temp->nSlots * sizeof(uint32_t), 
+        (temp->nTerms + 1) * sizeof(uint64_t), temp->nTerms * sizeof(uint32_t), temp->nTerms * sizeof(float), 
+        temp->postingsSize, (temp->nDocuments + 1) * sizeof(double), temp->nTerms * sizeof(double), 
+        (temp->nDocuments + 1) * sizeof(uint64_t), (temp->nStoredDocuments + 1) * sizeof(uint64_t), 
+        (temp->nBlocks + 1) * sizeof(uint64_t), (temp->nBlocks + 1) * sizeof(uint64_t), temp->sections[DOCUMENT_TEXTS].size
+    };
+    for (size_t i = 0; i < N_SECTIONS; i++) {
+        const SectionEntry& section = temp->sections[i];
+        if (section.offset % ALIGNMENT != 0 || section.offset > file.size() || section.size > file.size() - section.offset 
+            || section.size != expected[i]) {
+            error = "index file is truncated or corrupted.";
+            return false;
+        }
+        if (isVerified && section.checksum != checksum(file.data() + section.offset, section.size)) {
+            error = "index file is corrupted.";
+            return false;
+        }
+    }
+    header = temp;
+    
+    return true;
+}
+
+
+void IndexFile::attach(Lexicon& lexicon, InvertedIndex& index, DocumentStore& documents) const {
+    lexicon.attach(getSection<char>(TERM_CHARACTERS), getSection<uint64_t>(TERM_OFFSETS), header->nTerms, 
+        getSection<uint32_t>(TERM_SLOTS), header->nSlots);
+    index.attach(header->nTerms, header->nDocuments, getSection<uint64_t>(POSTING_OFFSETS), 
+        getSection<uint32_t>(DOCUMENT_FREQUENCIES), getSection<float>(MAX_IMPACTS), getSection<uint8_t>(POSTINGS), 
+        getSection<double>(NORMS), getSection<double>(IDFS), getSection<uint64_t>(MAX_FREQUENCIES));
+    documents.attach(header->nStoredDocuments, header->nBlocks, getSection<uint64_t>(DOCUMENT_OFFSETS), 
+        getSection<uint64_t>(DOCUMENT_BLOCKS), getSection<uint64_t>(BLOCK_OFFSETS), getSection<uint8_t>(DOCUMENT_TEXTS));
+}
@@ -0,0 +1,164 @@
+/*
+ * The MIT License
+ *
+ * Copyright 2017 Theomeli.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/* 
+ * File:   IndexFile.h
+ * Author: Theomeli
+ *
+ * Created on October 18, 2026, 2:10 PM
+ */
+
+#ifndef INDEXFILE_H
+#define INDEXFILE_H
+#include "Lexicon.h"
+#include "InvertedIndex.h"
+#include "MappedFile.h"
+#include "DocumentStore.h"
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace std;
+
+/**
+ * a built index saved to a file. The file starts with a header holding
+ * the sizes of the index and a table of sections, each one an array laid
+ * out exactly as the lexicon and the inverted index keep it in memory. 
+ * Sections are found by their offset from the start of the file, so the
+ * file is mapped and the lexicon and the index are attached to it with no
+ * pass over its content. The header and every section have a checksum
+ */
+class IndexFile {
+public:
+    //the version of the format written by save
+    static const uint32_t VERSION = 4;
+    
+    IndexFile();
+    IndexFile(const IndexFile& orig) = delete;
+    IndexFile& operator =(const IndexFile& rightSide) = delete;
+    virtual ~IndexFile();
+    
+    /**
+     * getter for private member error
+     * @return why the last load failed
+     */
+     const string& getError() const { return error; }
+    
+    /**
+     * getter for the number of documents of the loaded index
+     * @return the number of documents
+     */
+     size_t getNDocuments() const { return header->nDocuments; }
+    
+    /**
+     * it writes an index to a file
+     * @param fileName is the path of the file
+     * @param lexicon is the lexicon of the documents' terms
+     * @param index is the finished inverted index of the documents
+     * @param documents is the compressed normalized text of each document
+     * @return false if the file could not be written
+     */
+    static bool save(const string& fileName, const Lexicon& lexicon, const InvertedIndex& index, 
+        const DocumentStore& documents);
+    
+    /**
+     * it maps an index file and checks its header. The sections' checksums
+     * need a pass over the whole file, so they are only checked on demand
+     * @param fileName is the path of the file
+     * @param isVerified if true the checksums of the sections are checked
+     * @return false if the file cannot be used, with the reason in error
+     */
+    bool load(const string& fileName, bool isVerified);
+    
+    /**
+     * it attaches a lexicon, an inverted index and a document store to the
+     * loaded file. They read the file in place, so it must outlive them
+     * @param lexicon is the lexicon to be attached
+     * @param index is the inverted index to be attached
+     * @param documents is the document store to be attached
+     */
+    void attach(Lexicon& lexicon, InvertedIndex& index, DocumentStore& documents) const;
+private:
+    //the sections of the file
+    enum Section { TERM_CHARACTERS, TERM_OFFSETS, TERM_SLOTS, POSTING_OFFSETS, DOCUMENT_FREQUENCIES, MAX_IMPACTS, POSTINGS, NORMS, IDFS, 
+        MAX_FREQUENCIES, DOCUMENT_OFFSETS, DOCUMENT_BLOCKS, BLOCK_OFFSETS, DOCUMENT_TEXTS, N_SECTIONS };
+    
+    //the place of a section in the file
+    struct SectionEntry {
+        uint64_t offset;
+        uint64_t size;
+        uint64_t checksum;
+    };
+    
+    //the start of the file
+    struct Header {
+        char magic[8];
+        uint32_t version;
+        //it tells whether the file was written with the
+        //same byte order
+        uint32_t byteOrder;
+        uint64_t nDocuments;
+        uint64_t nTerms;
+        //the bytes of the compressed postings lists
+        uint64_t postingsSize;
+        uint64_t nSlots;
+        //the documents of the store, document 0 included,
+        //and its blocks
+        uint64_t nStoredDocuments;
+        uint64_t nBlocks;
+        SectionEntry sections[N_SECTIONS];
+        //the checksum of the header's bytes above
+        uint64_t checksum;
+    };
+    
+    //the mapping of the loaded file
+    MappedFile								mapping;
+    //the header of the loaded file
+    const Header*								header;
+    //why the last load failed
+    string									error;
+    
+    /**
+     * getter for the start of a section of the loaded file
+     * @param section is the section
+     * @return a pointer into the mapping
+     */
+    template<class T>
+    const T* getSection(Section section) const {
+        return reinterpret_cast<const T*>(mapping.getView().data() + header->sections[section].offset);
+    }
+    
+    /**
+     * it computes the checksum of some bytes, FNV-1a taken over 8 bytes
+     * at a time
+     * @param data is the start of the bytes
+     * @param size is the number of bytes
+     * @return the checksum
+     */
+    static uint64_t checksum(const char* data, size_t size);
+};
+
+#endif /* INDEXFILE_H */
+
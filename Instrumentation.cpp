@@ -0,0 +1,166 @@
+/*
+ * The MIT License
+ *
+ * Copyright 2017 Theomeli.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/* 
+ * File:   Instrumentation.cpp
+ * Author: Theomeli
+ * 
+ * Created on October 20, 2026, 3:10 PM
+ */
+
+#include "Instrumentation.h"
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <sys/resource.h>
+
+atomic<uint64_t> Instrumentation::counters[N_COUNTERS];
+atomic<bool> Instrumentation::isTracing(false);
+mutex Instrumentation::lock;
+vector<unique_ptr<Instrumentation::ThreadPhases>> Instrumentation::threadPhases;
+map<string, size_t> Instrumentation::bytes;
+chrono::steady_clock::time_point Instrumentation::origin = chrono::steady_clock::now();
+
+/**
+ * the names of the counters in the report
+ */
+static const char* counterNames[] = { "tokensParsed", "postingsScanned", "documentsScored", "heapOperations", 
+    "queriesEvaluated", "blocksDecompressed" };
+
+/**
+ * the names of the phases in the report and the trace
+ */
+static const char* phaseNames[] = { "readDocumentsFile", "readDocumentsRange", "readQueriesFile", "loadIndex", 
+    "computeFrequencies", "initializeIdfs", "buildIndex", "buildDocumentStore", "computeQueryWeights", "saveIndex", 
+    "quantizeIndex", "indexPositions", "buildDictionary", "addDocument", "refreshSegments", "mergeSegments", 
+    "exchangeStatistics", "computeResults", "evaluateBatch", "evaluateQuery", "search", "writeResults", 
+    "displayResults" };
+
+Instrumentation::ScopedTimer::ScopedTimer(Phase phase): phase(phase), start(chrono::steady_clock::now()) {
+}
+
+
+Instrumentation::ScopedTimer::~ScopedTimer() {
+    record(phase, start, chrono::steady_clock::now());
+}
+
+
+Instrumentation::ThreadPhases& Instrumentation::getThreadPhases() {
+    thread_local ThreadPhases* own = nullptr;
+    if (own == nullptr) {
+        lock_guard<mutex> guard(lock);
+        threadPhases.push_back(unique_ptr<ThreadPhases>(new ThreadPhases()));
+        own = threadPhases.back().get();
+        own->threadId = threadPhases.size() - 1;
+    }
+    
+    return *own;
+}
+
+
+void Instrumentation::record(Phase phase, chrono::steady_clock::time_point start, chrono::steady_clock::time_point end) {
+    double seconds = chrono::duration<double>(end - start).count();
+    ThreadPhases& own = getThreadPhases();
+    lock_guard<mutex> guard(own.lock);
+    PhaseTotals& totals = own.totals[phase];
+    totals.count++;
+    totals.seconds += seconds;
+    totals.maxSeconds = max(totals.maxSeconds, seconds);
+    if (isTracing.load(memory_order_relaxed)) {
+        Event event = { phase, chrono::duration<double, micro>(start - origin).count(), 
+            chrono::duration<double, micro>(end - origin).count() };
+        own.events.push_back(event);
+    }
+}
+
+
+void Instrumentation::setBytes(const string& structure, size_t n) {
+    lock_guard<mutex> guard(lock);
+    bytes[structure] = n;
+}
+
+
+void Instrumentation::setTracing(bool isTracing) {
+    Instrumentation::isTracing.store(isTracing, memory_order_relaxed);
+}
+
+
+bool Instrumentation::writeReport(const string& fileName) {
+    ofstream file(fileName);
+    file << fixed << setprecision(3);
+    lock_guard<mutex> guard(lock);
+    //the threads' totals are merged only here
+    PhaseTotals phases[N_PHASES];
+    for (auto const &ent1 : threadPhases) {
+        lock_guard<mutex> threadGuard(ent1->lock);
+        for (size_t phase = 0; phase < N_PHASES; phase++) {
+            phases[phase].count += ent1->totals[phase].count;
+            phases[phase].seconds += ent1->totals[phase].seconds;
+            phases[phase].maxSeconds = max(phases[phase].maxSeconds, ent1->totals[phase].maxSeconds);
+        }
+    }
+    file << "{\n  \"phases\": [";
+    size_t i = 0;
+    for (size_t phase = 0; phase < N_PHASES; phase++)
+        if (phases[phase].count > 0)
+            file << (i++ > 0 ? "," : "") << "\n    { \"name\": \"" << phaseNames[phase] << "\", \"count\": " 
+                << phases[phase].count << ", \"totalMs\": " << phases[phase].seconds * 1e3 << ", \"maxMs\": " 
+                << phases[phase].maxSeconds * 1e3 << " }";
+    file << "\n  ],\n  \"counters\": {";
+    for (i = 0; i < N_COUNTERS; i++)
+        file << (i > 0 ? "," : "") << "\n    \"" << counterNames[i] << "\": " << get(Counter(i));
+    file << "\n  },\n  \"bytes\": {";
+    i = 0;
+    size_t total = 0;
+    for (auto const &ent1 : bytes) {
+        file << (i++ > 0 ? "," : "") << "\n    \"" << ent1.first << "\": " << ent1.second;
+        total += ent1.second;
+    }
+    //ru_maxrss is in kilobytes on Linux
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    file << "\n  },\n  \"totalBytes\": " << total << ",\n  \"peakResidentBytes\": " << size_t(usage.ru_maxrss) * 1024 
+        << "\n}\n";
+    
+    return file.good();
+}
+
+
+bool Instrumentation::writeTrace(const string& fileName) {
+    ofstream file(fileName);
+    file << fixed << setprecision(3);
+    lock_guard<mutex> guard(lock);
+    file << "{\"traceEvents\":[";
+    size_t i = 0;
+    for (auto const &ent1 : threadPhases) {
+        lock_guard<mutex> threadGuard(ent1->lock);
+        for (auto const &ent2 : ent1->events)
+            file << (i++ > 0 ? "," : "") << "\n{\"name\":\"" << phaseNames[ent2.phase] << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" 
+                << ent1->threadId << ",\"ts\":" << ent2.start << ",\"dur\":" << ent2.end - ent2.start << "}";
+    }
+    file << "\n],\"displayTimeUnit\":\"ms\"}\n";
+    
+    return file.good();
+}
+
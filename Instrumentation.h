@@ -0,0 +1,238 @@
+/*
+ * The MIT License
+ *
+ * Copyright 2017 Theomeli.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/* 
+ * File:   Instrumentation.h
+ * Author: Theomeli
+ *
+ * Created on October 20, 2026, 3:10 PM
+ */
+
+#ifndef INSTRUMENTATION_H
+#define INSTRUMENTATION_H
+#include <cstddef>
+#include <cstdint>
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/**
+ * it measures where a run spends its time and memory: the phases timed by
+ * scoped timers, counters of the work done and the bytes of the major
+ * structures. The measures are reported as JSON and the phases may also be
+ * written as a trace which Chrome's trace viewer (chrome://tracing) shows 
+ * thread by thread. The code is instrumented with the macros below, which
+ * are compiled out when NO_INSTRUMENTATION is defined. Counters of the work
+ * done in loops are summed locally and added once, so that the cost of the
+ * instrumentation does not depend on the size of the input. The phases are
+ * known in advance and each thread records its own in a buffer of its own,
+ * which the report merges, so the timers of different threads neither wait
+ * for each other nor look their names up
+ */
+class Instrumentation {
+public:
+    //the counters of the work done
+    enum Counter {
+        TOKENS_PARSED,
+        POSTINGS_SCANNED,
+        DOCUMENTS_SCORED,
+        HEAP_OPERATIONS,
+        QUERIES_EVALUATED,
+        BLOCKS_DECOMPRESSED,
+        N_COUNTERS
+    };
+    
+    //the phases timed, in the order of a run
+    enum Phase {
+        READ_DOCUMENTS_FILE,
+        READ_DOCUMENTS_RANGE,
+        READ_QUERIES_FILE,
+        LOAD_INDEX,
+        COMPUTE_FREQUENCIES,
+        INITIALIZE_IDFS,
+        BUILD_INDEX,
+        BUILD_DOCUMENT_STORE,
+        COMPUTE_QUERY_WEIGHTS,
+        SAVE_INDEX,
+        QUANTIZE_INDEX,
+        INDEX_POSITIONS,
+        BUILD_DICTIONARY,
+        ADD_DOCUMENT,
+        REFRESH_SEGMENTS,
+        MERGE_SEGMENTS,
+        EXCHANGE_STATISTICS,
+        COMPUTE_RESULTS,
+        EVALUATE_BATCH,
+        EVALUATE_QUERY,
+        SEARCH,
+        WRITE_RESULTS,
+        DISPLAY_RESULTS,
+        N_PHASES
+    };
+    
+    /**
+     * it times a phase from its construction to its destruction
+     */
+    class ScopedTimer {
+    public:
+        /**
+         * @param phase is the phase
+         */
+        ScopedTimer(Phase phase);
+        ScopedTimer(const ScopedTimer& orig) = delete;
+        ScopedTimer& operator =(const ScopedTimer& rightSide) = delete;
+        virtual ~ScopedTimer();
+    private:
+        //the phase
+        Phase									phase;
+        //the time the phase started
+        chrono::steady_clock::time_point					start;
+    };
+    
+    /**
+     * it adds to a counter
+     * @param counter is the counter
+     * @param n is the number to add
+     */
+    static void add(Counter counter, uint64_t n) { counters[counter].fetch_add(n, memory_order_relaxed); }
+    
+    /**
+     * getter for a counter
+     * @param counter is the counter
+     * @return the sum of what was added to it
+     */
+    static uint64_t get(Counter counter) { return counters[counter].load(memory_order_relaxed); }
+    
+    /**
+     * it records the bytes which a structure takes, replacing the ones
+     * recorded before for it
+     * @param structure is the name of the structure
+     * @param bytes is the number of bytes
+     */
+    static void setBytes(const string& structure, size_t bytes);
+    
+    /**
+     * it makes the timers keep each phase they time, so that they can
+     * be written as a trace, besides adding it to the totals of its name
+     * @param isTracing true to keep the phases
+     */
+    static void setTracing(bool isTracing);
+    
+    /**
+     * it writes the totals of the phases by name, the counters, the bytes
+     * of the structures and the peak resident memory of the process as JSON
+     * @param fileName is the path of the file
+     * @return false if the file could not be written
+     */
+    static bool writeReport(const string& fileName);
+    
+    /**
+     * it writes the phases kept since setTracing(true) in the trace event
+     * format of Chrome
+     * @param fileName is the path of the file
+     * @return false if the file could not be written
+     */
+    static bool writeTrace(const string& fileName);
+private:
+    //the totals of the phases of a name
+    struct PhaseTotals {
+        uint64_t							count = 0;
+        double								seconds = 0;
+        double								maxSeconds = 0;
+    };
+    
+    //a phase kept for the trace
+    struct Event {
+        Phase								phase;
+        //the microseconds from the first timer to the start
+        //and the end of the phase
+        double								start;
+        double								end;
+    };
+    
+    //the phases which a thread recorded
+    struct ThreadPhases {
+        //a small number for the thread, in the order the
+        //threads recorded their first phase
+        size_t								threadId = 0;
+        //it protects the members below, only the thread
+        //and the report take it
+        mutex								lock;
+        //the totals of each phase
+        PhaseTotals							totals[N_PHASES];
+        //the phases kept
+        vector<Event>							events;
+    };
+    
+    //the counters
+    static atomic<uint64_t>							counters[N_COUNTERS];
+    //true if the phases are kept
+    static atomic<bool>							isTracing;
+    //it protects the members below
+    static mutex								lock;
+    //the phases of each thread which recorded one, by
+    //thread id, kept after the thread ends
+    static vector<unique_ptr<ThreadPhases>>					threadPhases;
+    //the bytes of the structures by name
+    static map<string, size_t>						bytes;
+    //the time which the trace starts from
+    static chrono::steady_clock::time_point					origin;
+    
+    /**
+     * it gives the phases of the calling thread, adding them the first time
+     * @return the phases of the calling thread
+     */
+    static ThreadPhases& getThreadPhases();
+    
+    /**
+     * it adds a phase which ended to the totals and to the trace of the
+     * calling thread
+     * @param phase is the phase
+     * @param start is the time the phase started
+     * @param end is the time the phase ended
+     */
+    static void record(Phase phase, chrono::steady_clock::time_point start, chrono::steady_clock::time_point end);
+};
+
+#ifdef NO_INSTRUMENTATION
+#define INSTRUMENT_PHASE(phase)
+#define INSTRUMENT_COUNT(counter, n)
+#define INSTRUMENT_BYTES(structure, n)
+#else
+//it times the rest of the enclosing scope as a phase
+#define INSTRUMENT_PHASE(phase) Instrumentation::ScopedTimer instrumentationTimer(Instrumentation::phase)
+//it adds n to a counter
+#define INSTRUMENT_COUNT(counter, n) Instrumentation::add(Instrumentation::counter, n)
+//it records the bytes of a structure
+#define INSTRUMENT_BYTES(structure, n) Instrumentation::setBytes(structure, n)
+#endif
+
+#endif /* INSTRUMENTATION_H */
+
@@ -0,0 +1,270 @@
+/*
+ * The MIT License
+ *
+ * Copyright 2017 Theomeli.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/* 
+ * File:   InvertedIndex.cpp
+ * Author: Theomeli
+ * 
+ * Created on October 17, 2026, 10:12 AM
+ */
+
+#include "InvertedIndex.h"
+#include <algorithm>
+#include <cmath>
+
+InvertedIndex::InvertedIndex(): nTerms(0), nDocuments(0), offsets(1, 0), norms(1, 0), maxFrequencies(1, 1), 
+    isAttached(false) {
+    refreshViews();
+}
+
+
+InvertedIndex::InvertedIndex(size_t nTerms, size_t nDocuments)
+    :nTerms(nTerms), nDocuments(nDocuments), lists(nTerms), offsets(nTerms + 1, 0), 
+    documentFrequencies(nTerms, 0), maxImpacts(nTerms, 0), norms(nDocuments + 1, 0), 
+    idfs(nTerms, 0), maxFrequencies(nDocuments + 1, 1), isAttached(false) {
+    refreshViews();
+}
+
+
+InvertedIndex::InvertedIndex(const InvertedIndex& orig)
+    :nTerms(orig.nTerms), nDocuments(orig.nDocuments), lists(orig.lists), offsets(orig.offsets), 
+    documentFrequencies(orig.documentFrequencies), maxImpacts(orig.maxImpacts), postings(orig.postings), norms(orig.norms), idfs(orig.idfs), maxFrequencies(orig.maxFrequencies), 
+    isAttached(orig.isAttached), offsetsView(orig.offsetsView), 
+    documentFrequenciesView(orig.documentFrequenciesView), maxImpactsView(orig.maxImpactsView), postingsView(orig.postingsView), 
+    normsView(orig.normsView), idfsView(orig.idfsView), maxFrequenciesView(orig.maxFrequenciesView) {
+    if (!isAttached)
+        refreshViews();
+}
+
+
+InvertedIndex& InvertedIndex::operator =(const InvertedIndex& rightSide) {
+    nTerms = rightSide.nTerms;
+    nDocuments = rightSide.nDocuments;
+    lists = rightSide.lists;
+    offsets = rightSide.offsets;
+    documentFrequencies = rightSide.documentFrequencies;
+    maxImpacts = rightSide.maxImpacts;
+    postings = rightSide.postings;
+    norms = rightSide.norms;
+    idfs = rightSide.idfs;
+    maxFrequencies = rightSide.maxFrequencies;
+    isAttached = rightSide.isAttached;
+    offsetsView = rightSide.offsetsView;
+    documentFrequenciesView = rightSide.documentFrequenciesView;
+    maxImpactsView = rightSide.maxImpactsView;
+    postingsView = rightSide.postingsView;
+    normsView = rightSide.normsView;
+    idfsView = rightSide.idfsView;
+    maxFrequenciesView = rightSide.maxFrequenciesView;
+    if (!isAttached)
+        refreshViews();
+    
+    return *this;
+}
+
+
+InvertedIndex::~InvertedIndex() {
+}
+
+
+void InvertedIndex::refreshViews() {
+    offsetsView = offsets.data();
+    documentFrequenciesView = documentFrequencies.data();
+    maxImpactsView = maxImpacts.data();
+    postingsView = postings.data();
+    normsView = norms.data();
+    idfsView = idfs.data();
+    maxFrequenciesView = maxFrequencies.data();
+}
+
+
+void InvertedIndex::addPosting(size_t termId, size_t docId, size_t frequency) {
+    Posting posting = { uint32_t(docId), uint32_t(frequency) };
+    lists[termId].push_back(posting);
+}
+
+
+void InvertedIndex::setIdfs(const vector<double>& idfs) {
+    this->idfs.assign(idfs.begin(), idfs.begin() + min(idfs.size(), nTerms));
+    this->idfs.resize(nTerms, 0);
+    refreshViews();
+}
+
+
+void InvertedIndex::setMaxFrequencies(const vector<size_t>& maxFrequencies) {
+    this->maxFrequencies.assign(maxFrequencies.begin(), maxFrequencies.begin() + min(maxFrequencies.size(), nDocuments + 1));
+    this->maxFrequencies.resize(nDocuments + 1, 1);
+    refreshViews();
+}
+
+
+void InvertedIndex::finish() {
+    fill(norms.begin(), norms.end(), 0);
+    for (size_t termId = 0; termId < nTerms; termId++)
+        for (auto const &posting : lists[termId]) {
+            double weight = getWeight(termId, posting.docId, posting.frequency);
+            norms[posting.docId] += weight * weight;
+        }
+    for (size_t i = 0; i < norms.size(); i++)
+        norms[i] = sqrt(norms[i]);
+    
+    postings.clear();
+    vector<uint32_t> docIds, frequencies;
+    vector<double> impacts;
+    for (size_t termId = 0; termId < nTerms; termId++) {
+        offsets[termId] = postings.size();
+        documentFrequencies[termId] = lists[termId].size();
+        docIds.clear();
+        frequencies.clear();
+        impacts.clear();
+        double maxImpact = 0;
+        for (auto const &posting : lists[termId]) {
+            docIds.push_back(posting.docId);
+            frequencies.push_back(posting.frequency);
+            double norm = norms[posting.docId];
+            impacts.push_back(norm > 0 ? getWeight(termId, posting.docId, posting.frequency) / norm : 0);
+            maxImpact = max(maxImpact, impacts.back());
+        }
+        maxImpacts[termId] = PostingsCodec::roundUp(maxImpact);
+        PostingsCodec::encode(docIds.data(), frequencies.data(), impacts.data(), docIds.size(), postings);
+        vector<Posting>().swap(lists[termId]);
+    }
+    offsets[nTerms] = postings.size();
+    postings.shrink_to_fit();
+    vector<vector<Posting>>().swap(lists);
+    refreshViews();
+}
+
+
+void InvertedIndex::attach(size_t nTerms, size_t nDocuments, const uint64_t* offsets, const uint32_t* documentFrequencies, 
+    const float* maxImpacts, const uint8_t* postings, const double* norms, const double* idfs, const uint64_t* maxFrequencies) {
+    this->nTerms = nTerms;
+    this->nDocuments = nDocuments;
+    vector<vector<Posting>>().swap(lists);
+    vector<uint64_t>().swap(this->offsets);
+    vector<uint32_t>().swap(this->documentFrequencies);
+    vector<float>().swap(this->maxImpacts);
+    vector<uint8_t>().swap(this->postings);
+    vector<double>().swap(this->norms);
+    vector<double>().swap(this->idfs);
+    vector<uint64_t>().swap(this->maxFrequencies);
+    isAttached = true;
+    offsetsView = offsets;
+    documentFrequenciesView = documentFrequencies;
+    maxImpactsView = maxImpacts;
+    postingsView = postings;
+    normsView = norms;
+    idfsView = idfs;
+    maxFrequenciesView = maxFrequencies;
+}
+
+
+void InvertedIndex::getDocIds(size_t termId, vector<uint32_t>& docIds) const {
+    uint32_t frequencies[PostingsCodec::BLOCK_SIZE];
+    const uint8_t* block = postingsView + offsetsView[termId];
+    size_t n = documentFrequenciesView[termId];
+    docIds.resize(n);
+    uint32_t previous = 0;
+    for (size_t start = 0; start < n; start += PostingsCodec::BLOCK_SIZE) {
+        size_t count = min(PostingsCodec::BLOCK_SIZE, n - start);
+        block = PostingsCodec::decode(block, count, previous, docIds.data() + start, frequencies);
+        previous = docIds[start + count - 1];
+    }
+}
+
+
+PostingsCursor::PostingsCursor(const uint8_t* data, size_t n)
+    :block(data), previous(0), remaining(n), isDecoded(false), position(0), count(0), docId(END) {
+    if (remaining > 0)
+        decode();
+}
+
+
+void PostingsCursor::decode() {
+    count = min(PostingsCodec::BLOCK_SIZE, remaining);
+    PostingsCodec::decode(block, count, previous, docIds, frequencies);
+    isDecoded = true;
+    position = 0;
+    docId = docIds[0];
+}
+
+
+void PostingsCursor::nextBlock() {
+    if (docId == END)
+        return;
+    if (remaining <= PostingsCodec::BLOCK_SIZE) {
+        docId = END;
+        return;
+    }
+    previous = PostingsCodec::getLastDocId(block);
+    block = PostingsCodec::skip(block);
+    remaining -= PostingsCodec::BLOCK_SIZE;
+    decode();
+}
+
+
+float PostingsCursor::getMaxImpact(uint32_t last) const {
+    const uint8_t* temp = block;
+    float impact = PostingsCodec::getMaxImpact(temp);
+    for (size_t n = remaining; PostingsCodec::getLastDocId(temp) < last && n > PostingsCodec::BLOCK_SIZE; 
+        n -= PostingsCodec::BLOCK_SIZE) {
+        temp = PostingsCodec::skip(temp);
+        impact = max(impact, PostingsCodec::getMaxImpact(temp));
+    }
+    
+    return impact;
+}
+
+
+bool PostingsCursor::nextBlock(uint32_t target) {
+    if (docId == END)
+        return false;
+    //all the blocks but the last are full, so they can be skipped
+    while (PostingsCodec::getLastDocId(block) < target) {
+        if (remaining <= PostingsCodec::BLOCK_SIZE) {
+            docId = END;
+            position = count;
+            return false;
+        }
+        previous = PostingsCodec::getLastDocId(block);
+        block = PostingsCodec::skip(block);
+        remaining -= PostingsCodec::BLOCK_SIZE;
+        isDecoded = false;
+    }
+    
+    return true;
+}
+
+
+void PostingsCursor::nextGeq(uint32_t target) {
+    if (docId >= target && isDecoded)
+        return;
+    if (!nextBlock(target))
+        return;
+    if (!isDecoded)
+        decode();
+    while (docIds[position] < target)
+        position++;
+    docId = docIds[position];
+}
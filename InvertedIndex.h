@@ -0,0 +1,362 @@
+/*
+ * The MIT License
+ *
+ * Copyright 2017 Theomeli.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/* 
+ * File:   InvertedIndex.h
+ * Author: Theomeli
+ *
+ * Created on October 17, 2026, 10:12 AM
+ */
+
+#ifndef INVERTEDINDEX_H
+#define INVERTEDINDEX_H
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <vector>
+#include "PostingsCodec.h"
+
+using namespace std;
+
+/**
+ * an entry of a postings list while it is built: the id of a document
+ * which contains the term and the frequency of the term in it
+ */
+struct Posting {
+    uint32_t docId;
+    uint32_t frequency;
+};
+
+/**
+ * a cursor over a compressed postings list, moving by ascending document
+ * id. Blocks are decoded only when a posting of them is read, so a cursor
+ * moved far ahead skips the blocks between by their headers
+ */
+class PostingsCursor {
+public:
+    //the document id of a cursor past the end of its list
+    static const uint32_t END = UINT32_MAX;
+    
+    /**
+     * it places the cursor on the first posting of a list
+     * @param data is the start of the compressed list
+     * @param n is the number of postings of the list
+     */
+    PostingsCursor(const uint8_t* data, size_t n);
+    
+    /**
+     * getter for private member docId
+     * @return the id of the current document or END
+     */
+     uint32_t getDocId() const { return docId; }
+    
+    /**
+     * getter for the frequency of the term in the current document
+     * @return the frequency
+     */
+     uint32_t getFrequency() const { return frequencies[position]; }
+    
+    /**
+     * getter for the greatest impact of the current block
+     * @return the impact
+     */
+     float getBlockMaxImpact() const { return PostingsCodec::getMaxImpact(block); }
+    
+    /**
+     * it finds the greatest impact of the blocks from the current one to
+     * the one which would hold last, reading only the blocks' headers
+     * @param last is the document id
+     * @return the impact
+     */
+    float getMaxImpact(uint32_t last) const;
+    
+    /**
+     * it moves the cursor to the next posting
+     */
+    void next() {
+        if (++position < count)
+            docId = docIds[position];
+        else
+            nextBlock();
+    }
+    
+    /**
+     * it finds the postings from the current one to the end of the
+     * current block whose document ids are less than end
+     * @param end is the document id
+     * @param ids is set to the document ids of the postings
+     * @param values is set to the frequencies of the postings
+     * @return the number of postings, which advance moves past
+     */
+    size_t getRun(uint64_t end, const uint32_t*& ids, const uint32_t*& values) const {
+        ids = docIds + position;
+        values = frequencies + position;
+        if (docId >= end)
+            return 0;
+        return lower_bound(ids, docIds + count, end) - ids;
+    }
+    
+    /**
+     * it moves the cursor past some postings of the current block
+     * @param n is the number of postings, at most the ones left in the block
+     */
+    void advance(size_t n) {
+        position += n;
+        if (position < count)
+            docId = docIds[position];
+        else
+            nextBlock();
+    }
+    
+    /**
+     * it moves the cursor to the first posting whose document id is
+     * not less than target
+     * @param target is the document id
+     */
+    void nextGeq(uint32_t target);
+    
+    /**
+     * it moves the cursor to the block which would hold target, reading
+     * only the blocks' headers. It must be followed by nextGeq before the
+     * current posting is read again
+     * @param target is the document id
+     * @return false if no posting of the list has an id not less than target
+     */
+    bool nextBlock(uint32_t target);
+private:
+    //the current block
+    const uint8_t*								block;
+    //the id of the last document of the previous block
+    uint32_t								previous;
+    //the postings of the current block and the ones after it
+    size_t									remaining;
+    //true if the current block is decoded to the buffers
+    bool									isDecoded;
+    //the position of the current posting in the buffers
+    size_t									position;
+    //the number of postings of the current block
+    size_t									count;
+    //the id of the current document
+    uint32_t								docId;
+    //the decoded postings of the current block
+    uint32_t								docIds[PostingsCodec::BLOCK_SIZE];
+    uint32_t								frequencies[PostingsCodec::BLOCK_SIZE];
+    
+    /**
+     * it decodes the current block and moves to its first posting
+     */
+    void decode();
+    
+    /**
+     * it moves the cursor past the last posting of the current block
+     */
+    void nextBlock();
+};
+
+/**
+ * the inverted index of the documents. The postings lists hold the ids of
+ * the documents and the frequencies of the terms, compressed by PostingsCodec,
+ * and the weights are computed from them when a list is read
+ */
+class InvertedIndex {
+public:
+    InvertedIndex();
+    InvertedIndex(size_t nTerms, size_t nDocuments);
+    InvertedIndex(const InvertedIndex& orig);
+    InvertedIndex& operator =(const InvertedIndex& rightSide);
+    virtual ~InvertedIndex();
+    
+    /**
+     * getter for private member nDocuments
+     * @return the number of documents of the index
+     */
+     size_t getNDocuments() const { return nDocuments; }
+    
+    /**
+     * getter for private member nTerms
+     * @return the number of terms of the index
+     */
+     size_t getNTerms() const { return nTerms; }
+    
+    /**
+     * getter for the number of documents which contain a term
+     * @param termId is the id of the term
+     * @return the length of the term's postings list
+     */
+     size_t getDocumentFrequency(size_t termId) const { return documentFrequenciesView[termId]; }
+    
+    /**
+     * getter for the weight of a term in a document, computed with the formula
+     * TF * IDF, where TF = ft,d / maxx(fx,d) and IDF = ln(N/nt)/ln(N)
+     * @param termId is the id of the term
+     * @param docId is the id of the document
+     * @param frequency is the frequency of the term in the document
+     * @return the weight
+     */
+     double getWeight(size_t termId, size_t docId, uint32_t frequency) const {
+         return frequency / double(maxFrequenciesView[docId]) * idfsView[termId];
+     }
+    
+    /**
+     * getter for the greatest impact of a term, its weight in a document
+     * divided by the document's norm, over the documents containing it
+     * @param termId is the id of the term
+     * @return the impact, rounded up to a float
+     */
+     float getMaxImpact(size_t termId) const { return maxImpactsView[termId]; }
+    
+    /**
+     * getter for a cursor over the postings list of a term
+     * @param termId is the id of the term
+     * @return the cursor on the first posting
+     */
+     PostingsCursor getCursor(size_t termId) const { 
+         return PostingsCursor(postingsView + offsetsView[termId], documentFrequenciesView[termId]); 
+     }
+    
+    /**
+     * getter for the Euclidean norm of a document's weights vector
+     * @param docId is the id of the document
+     * @return the norm of the document
+     */
+     double getNorm(size_t docId) const { return normsView[docId]; }
+    
+    /**
+     * getter for the idf which a term had in the documents' weights
+     * @param termId is the id of the term
+     * @return the idf of the term
+     */
+     double getIdf(size_t termId) const { return idfsView[termId]; }
+    
+    /**
+     * getter for the frequency of the most often term of a document
+     * @param docId is the id of the document
+     * @return the greatest frequency of the document
+     */
+     uint64_t getMaxFrequency(size_t docId) const { return maxFrequenciesView[docId]; }
+    
+    /**
+     * getters for the storage of the index, so that it can be written to
+     * a file and attached again. Offsets have nTerms + 1 entries, the byte
+     * offset of each compressed list and the end of the last one, documents'
+     * frequencies, maxImpacts and idfs nTerms and norms and maxFrequencies
+     * nDocuments + 1
+     */
+     const uint64_t* getOffsets() const { return offsetsView; }
+     const uint32_t* getDocumentFrequencies() const { return documentFrequenciesView; }
+     const float* getMaxImpacts() const { return maxImpactsView; }
+     const uint8_t* getPostingsData() const { return postingsView; }
+     size_t getPostingsSize() const { return offsetsView[nTerms]; }
+     const double* getNorms() const { return normsView; }
+     const double* getIdfs() const { return idfsView; }
+     const uint64_t* getMaxFrequencies() const { return maxFrequenciesView; }
+    
+    /**
+     * it appends a posting to the postings list of a term. Documents
+     * must be added in ascending order of their ids
+     * @param termId is the id of the term
+     * @param docId is the id of the document which contains the term
+     * @param frequency is the frequency of the term in the document
+     */
+    void addPosting(size_t termId, size_t docId, size_t frequency);
+    
+    /**
+     * it keeps the idfs which the documents' weights were computed with
+     * @param idfs is the idf of each term
+     */
+    void setIdfs(const vector<double>& idfs);
+    
+    /**
+     * it keeps the greatest term frequency of each document
+     * @param maxFrequencies is indexed by document id
+     */
+    void setMaxFrequencies(const vector<size_t>& maxFrequencies);
+    
+    /**
+     * it computes the Euclidean norm of each document from the weights of
+     * the postings and compresses the postings lists one after the other, with
+     * the bounds of their impacts. It must be called once all the postings, 
+     * the idfs and the maxFrequencies have been added
+     */
+    void finish();
+    
+    /**
+     * it makes the index use storage which it does not own, such as a
+     * memory mapped index file, without copying it. The storage must
+     * outlive the index and have the layout of the getters above
+     */
+    void attach(size_t nTerms, size_t nDocuments, const uint64_t* offsets, const uint32_t* documentFrequencies, 
+        const float* maxImpacts, const uint8_t* postings, const double* norms, const double* idfs, const uint64_t* maxFrequencies);
+    
+    /**
+     * it decodes the ids of the documents of a term's postings list
+     * @param termId is the id of the term
+     * @param docIds is set to the ascending ids
+     */
+    void getDocIds(size_t termId, vector<uint32_t>& docIds) const;
+private:
+    //number of terms of the index
+    size_t									nTerms;
+    //number of documents of the collection
+    size_t									nDocuments;
+    //for each term id the list of documents containing
+    //the term while the postings are added
+    vector<vector<Posting>>							lists;
+    //the start of each term's list in postings followed
+    //by the end of the last list
+    vector<uint64_t>							offsets;
+    //the length of each term's list
+    vector<uint32_t>							documentFrequencies;
+    //the greatest impact of each term
+    vector<float>								maxImpacts;
+    //the compressed postings lists one after the other
+    vector<uint8_t>								postings;
+    //the Euclidean norm of each document's weights
+    //vector, indexed by document id
+    vector<double>								norms;
+    //the idf of each term in the documents' weights
+    vector<double>								idfs;
+    //the greatest term frequency of each document
+    vector<uint64_t>							maxFrequencies;
+    //true if the views below point to storage which
+    //the index does not own
+    bool									isAttached;
+    //the storage which queries read, either the members
+    //above or an attached one
+    const uint64_t*								offsetsView;
+    const uint32_t*								documentFrequenciesView;
+    const float*								maxImpactsView;
+    const uint8_t*								postingsView;
+    const double*								normsView;
+    const double*								idfsView;
+    const uint64_t*								maxFrequenciesView;
+    
+    /**
+     * it points the views to the index's own storage
+     */
+    void refreshViews();
+};
+
+#endif /* INVERTEDINDEX_H */
+
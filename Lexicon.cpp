@@ -0,0 +1,182 @@
+/*
+ * The MIT License
+ *
+ * Copyright 2017 Theomeli.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/* 
+ * File:   Lexicon.cpp
+ * Author: Theomeli
+ * 
+ * Created on October 17, 2026, 12:40 PM
+ */
+
+#include "Lexicon.h"
+
+Lexicon::Lexicon(): offsets(1, 0), slots(16, NOT_FOUND), isAttached(false) {
+    refreshViews();
+}
+
+
+Lexicon::Lexicon(const Lexicon& orig)
+    :characters(orig.characters), offsets(orig.offsets), slots(orig.slots), isAttached(orig.isAttached), 
+    charactersView(orig.charactersView), offsetsView(orig.offsetsView), slotsView(orig.slotsView), 
+    nTerms(orig.nTerms), nSlots(orig.nSlots) {
+    if (!isAttached)
+        refreshViews();
+}
+
+
+Lexicon& Lexicon::operator =(const Lexicon& rightSide) {
+    characters = rightSide.characters;
+    offsets = rightSide.offsets;
+    slots = rightSide.slots;
+    isAttached = rightSide.isAttached;
+    charactersView = rightSide.charactersView;
+    offsetsView = rightSide.offsetsView;
+    slotsView = rightSide.slotsView;
+    nTerms = rightSide.nTerms;
+    nSlots = rightSide.nSlots;
+    if (!isAttached)
+        refreshViews();
+    
+    return *this;
+}
+
+
+Lexicon::Lexicon(Lexicon&& orig): Lexicon() {
+    *this = move(orig);
+}
+
+
+Lexicon& Lexicon::operator =(Lexicon&& rightSide) {
+    characters = move(rightSide.characters);
+    offsets = move(rightSide.offsets);
+    slots = move(rightSide.slots);
+    isAttached = rightSide.isAttached;
+    charactersView = rightSide.charactersView;
+    offsetsView = rightSide.offsetsView;
+    slotsView = rightSide.slotsView;
+    nTerms = rightSide.nTerms;
+    nSlots = rightSide.nSlots;
+    //the characters of a short string move out of its own buffer
+    if (!isAttached)
+        refreshViews();
+    //the moved lexicon is left empty
+    rightSide.characters.clear();
+    rightSide.offsets.assign(1, 0);
+    rightSide.slots.assign(16, NOT_FOUND);
+    rightSide.isAttached = false;
+    rightSide.refreshViews();
+    
+    return *this;
+}
+
+
+Lexicon::~Lexicon() {
+}
+
+
+uint64_t Lexicon::hash(string_view term) {
+    uint64_t h = 14695981039346656037ULL;
+    for (unsigned char c : term) {
+        h ^= c;
+        h *= 1099511628211ULL;
+    }
+    
+    return h;
+}
+
+
+size_t Lexicon::findSlot(string_view term, uint64_t h) const {
+    size_t mask = nSlots - 1;
+    size_t slot = h & mask;
+    while (slotsView[slot] != NOT_FOUND && getTerm(slotsView[slot]) != term)
+        slot = (slot + 1) & mask;
+    
+    return slot;
+}
+
+
+uint32_t Lexicon::find(string_view term) const {
+    return slotsView[findSlot(term, hash(term))];
+}
+
+
+uint32_t Lexicon::intern(string_view term) {
+    uint64_t h = hash(term);
+    size_t slot = findSlot(term, h);
+    if (slotsView[slot] != NOT_FOUND)
+        return slotsView[slot];
+    
+    if (isAttached)
+        detach();
+    uint32_t termId = size();
+    characters.append(term.data(), term.size());
+    offsets.push_back(characters.size());
+    slots[slot] = termId;
+    refreshViews();
+    //the table is kept at most half full
+    if (2 * size() > slots.size())
+        grow();
+    
+    return termId;
+}
+
+
+void Lexicon::attach(const char* characters, const uint64_t* offsets, size_t nTerms, const uint32_t* slots, size_t nSlots) {
+    this->characters.clear();
+    this->offsets.clear();
+    this->slots.clear();
+    isAttached = true;
+    charactersView = characters;
+    offsetsView = offsets;
+    slotsView = slots;
+    this->nTerms = nTerms;
+    this->nSlots = nSlots;
+}
+
+
+void Lexicon::detach() {
+    characters.assign(getCharacters());
+    offsets.assign(offsetsView, offsetsView + nTerms + 1);
+    slots.assign(slotsView, slotsView + nSlots);
+    isAttached = false;
+    refreshViews();
+}
+
+
+void Lexicon::refreshViews() {
+    charactersView = characters.data();
+    offsetsView = offsets.data();
+    slotsView = slots.data();
+    nTerms = offsets.size() - 1;
+    nSlots = slots.size();
+}
+
+
+void Lexicon::grow() {
+    vector<uint32_t> temp(2 * slots.size(), NOT_FOUND);
+    slots.swap(temp);
+    refreshViews();
+    for (uint32_t termId = 0; termId < size(); termId++)
+        slots[findSlot(getTerm(termId), hash(getTerm(termId)))] = termId;
+}
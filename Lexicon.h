@@ -0,0 +1,159 @@
+/*
+ * The MIT License
+ *
+ * Copyright 2017 Theomeli.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/* 
+ * File:   Lexicon.h
+ * Author: Theomeli
+ *
+ * Created on October 17, 2026, 12:40 PM
+ */
+
+#ifndef LEXICON_H
+#define LEXICON_H
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace std;
+
+class Lexicon {
+public:
+    //the id returned by find for a term which is not in the lexicon
+    static const uint32_t NOT_FOUND = UINT32_MAX;
+    
+    Lexicon();
+    Lexicon(const Lexicon& orig);
+    Lexicon& operator =(const Lexicon& rightSide);
+    Lexicon(Lexicon&& orig);
+    Lexicon& operator =(Lexicon&& rightSide);
+    virtual ~Lexicon();
+    
+    /**
+     * getter for the number of terms of the lexicon
+     * @return the number of terms
+     */
+     size_t size() const { return nTerms; }
+    
+    /**
+     * getter for the text of a term
+     * @param termId is the id of the term
+     * @return a view to the term, valid until the next call of intern
+     */
+     string_view getTerm(uint32_t termId) const {
+         return string_view(charactersView + offsetsView[termId], offsetsView[termId + 1] - offsetsView[termId]);
+     }
+    
+    /**
+     * getters for the storage of the lexicon, so that it can be written
+     * to a file and attached again
+     */
+     string_view getCharacters() const { return string_view(charactersView, offsetsView[nTerms]); }
+     const uint64_t* getOffsets() const { return offsetsView; }
+     const uint32_t* getSlots() const { return slotsView; }
+     size_t getNSlots() const { return nSlots; }
+    
+    /**
+     * it returns the id of a term, adding the term to the lexicon if it is 
+     * not already there. Ids are dense and given in order of appearance
+     * starting from zero. An attached lexicon is copied to its own storage
+     * before a term is added
+     * @param term is the term to be interned
+     * @return the id of the term
+     */
+    uint32_t intern(string_view term);
+    
+    /**
+     * it makes the lexicon use storage which it does not own, such as a
+     * memory mapped index file, without copying it. The storage must 
+     * outlive the lexicon and have the layout of getCharacters, getOffsets
+     * and getSlots
+     * @param characters is the characters of the terms
+     * @param offsets is the nTerms + 1 offsets of the terms in characters
+     * @param nTerms is the number of terms
+     * @param slots is the open addressing table
+     * @param nSlots is the size of slots, a power of two
+     */
+    void attach(const char* characters, const uint64_t* offsets, size_t nTerms, const uint32_t* slots, size_t nSlots);
+    
+    /**
+     * it searches for the id of a term without adding it
+     * @param term is the term to be searched
+     * @return the id of the term or NOT_FOUND
+     */
+    uint32_t find(string_view term) const;
+private:
+    //the characters of all terms, one after the other
+    string									characters;
+    //the start of each term in characters followed
+    //by the end of the last term
+    vector<uint64_t>							offsets;
+    //the open addressing table with linear probing,
+    //each slot holds a term id or NOT_FOUND if empty.
+    //Its size is a power of two
+    vector<uint32_t>							slots;
+    //true if the views below point to storage which
+    //the lexicon does not own
+    bool									isAttached;
+    //the storage which lookups read, either the members
+    //above or an attached one
+    const char*								charactersView;
+    const uint64_t*								offsetsView;
+    const uint32_t*								slotsView;
+    size_t									nTerms;
+    size_t									nSlots;
+    
+    /**
+     * it computes the FNV-1a hash of a term
+     * @param term is the term to be hashed
+     * @return the hash of the term
+     */
+    static uint64_t hash(string_view term);
+    
+    /**
+     * it searches for the slot of a term
+     * @param term is the term to be searched
+     * @param h is the hash of the term
+     * @return the slot holding the term or the empty slot where it belongs
+     */
+    size_t findSlot(string_view term, uint64_t h) const;
+    
+    /**
+     * it doubles the slots and places the terms again
+     */
+    void grow();
+    
+    /**
+     * it points the views to the lexicon's own storage
+     */
+    void refreshViews();
+    
+    /**
+     * it copies an attached storage to the lexicon's own storage
+     */
+    void detach();
+};
+
+#endif /* LEXICON_H */
+
@@ -0,0 +1,109 @@
+/*
+ * The MIT License
+ *
+ * Copyright 2017 Theomeli.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/* 
+ * File:   MappedFile.cpp
+ * Author: Theomeli
+ * 
+ * Created on October 17, 2026, 4:30 PM
+ */
+
+#include "MappedFile.h"
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <utility>
+
+MappedFile::MappedFile(): data(nullptr), size(0), isFailed(false) {
+}
+
+
+MappedFile::MappedFile(const string& fileName): data(nullptr), size(0), isFailed(false) {
+    open(fileName);
+}
+
+
+MappedFile::MappedFile(MappedFile&& orig): MappedFile() {
+    *this = move(orig);
+}
+
+
+MappedFile& MappedFile::operator =(MappedFile&& rightSide) {
+    //the mapping changes hands, so its views stay valid
+    if (this != &rightSide) {
+        close();
+        data = rightSide.data;
+        size = rightSide.size;
+        isFailed = rightSide.isFailed;
+        rightSide.data = nullptr;
+        rightSide.size = 0;
+        rightSide.isFailed = false;
+    }
+    
+    return *this;
+}
+
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+
+void MappedFile::open(const string& fileName) {
+    close();
+    isFailed = true;
+    int fd = ::open(fileName.c_str(), O_RDONLY);
+    if (fd < 0)
+        return;
+    
+    struct stat status;
+    if (fstat(fd, &status) == 0) {
+        size = status.st_size;
+        //an empty file cannot be mapped, it is an empty view
+        if (size == 0)
+            isFailed = false;
+        else {
+            void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapping != MAP_FAILED) {
+                //the files are walked from start to end
+                madvise(mapping, size, MADV_SEQUENTIAL);
+                data = static_cast<const char*>(mapping);
+                isFailed = false;
+            }
+            else
+                size = 0;
+        }
+    }
+    //the mapping stays valid after the descriptor is closed
+    ::close(fd);
+}
+
+
+void MappedFile::close() {
+    if (data != nullptr)
+        munmap(const_cast<char*>(data), size);
+    data = nullptr;
+    size = 0;
+}
@@ -0,0 +1,82 @@
+/*
+ * The MIT License
+ *
+ * Copyright 2017 Theomeli.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/* 
+ * File:   MappedFile.h
+ * Author: Theomeli
+ *
+ * Created on October 17, 2026, 4:30 PM
+ */
+
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+using namespace std;
+
+class MappedFile {
+public:
+    MappedFile();
+    MappedFile(const string& fileName);
+    MappedFile(const MappedFile& orig) = delete;
+    MappedFile& operator =(const MappedFile& rightSide) = delete;
+    MappedFile(MappedFile&& orig);
+    MappedFile& operator =(MappedFile&& rightSide);
+    virtual ~MappedFile();
+    
+    /**
+     * it checks if the file could not be mapped, like ifstream::fail
+     * @return true if the file could not be opened or mapped
+     */
+     bool fail() const { return isFailed; }
+    
+    /**
+     * getter for the content of the file
+     * @return a view to the mapped bytes, valid while the object lives
+     */
+     string_view getView() const { return string_view(data, size); }
+    
+    /**
+     * it maps a file read only, unmapping the previous one if any
+     * @param fileName is the path of the file
+     */
+    void open(const string& fileName);
+    
+    /**
+     * it unmaps the file
+     */
+    void close();
+private:
+    //the start of the mapping
+    const char*								data;
+    //the size of the file
+    size_t									size;
+    //true if the last open failed
+    bool									isFailed;
+};
+
+#endif /* MAPPEDFILE_H */
+
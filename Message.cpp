@@ -0,0 +1,184 @@
+/*
+ * The MIT License
+ *
+ * Copyright 2017 Theomeli.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+/* 
+ * File:   Message.cpp
+ * Author: Theomeli
+ * 
+ * Created on October 23, 2026, 10:05 AM
+ */
+
+#include "Message.h"
+#include <cerrno>
+#include <cstring>
+#include <unistd.h>
+#include <sys/socket.h>
+
+Message::Message(): position(0), isOverrun(false) {
+}
+
+
+Message::~Message() {
+}
+
+
+void Message::putNumber(uint64_t value) {
+    bytes.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+
+void Message::putDouble(double value) {
+    bytes.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+
+void Message::putString(string_view value) {
+    putNumber(value.size());
+    bytes.append(value.data(), value.size());
+}
+
+
+void Message::getBytes(void* target, size_t n) {
+    if (n > bytes.size() - position) {
+        memset(target, 0, n);
+        position = bytes.size();
+        isOverrun = true;
+        return;
+    }
+    memcpy(target, bytes.data() + position, n);
+    position += n;
+}
+
+
+uint64_t Message::getNumber() {
+    uint64_t value;
+    getBytes(&value, sizeof(value));
+    
+    return value;
+}
+
+
+double Message::getDouble() {
+    double value;
+    getBytes(&value, sizeof(value));
+    
+    return value;
+}
+
+
+string_view Message::getString() {
+    uint64_t n = getNumber();
+    if (n > bytes.size() - position) {
+        position = bytes.size();
+        isOverrun = true;
+        return string_view();
+    }
+    string_view value(bytes.data() + position, n);
+    position += n;
+    
+    return value;
+}
+
+
+void Message::setBytes(string_view fields) {
+    bytes.assign(fields.data(), fields.size());
+    position = 0;
+    isOverrun = false;
+}
+
+
+void Message::appendTo(string& buffer) const {
+    uint64_t length = bytes.size();
+    buffer.append(reinterpret_cast<const char*>(&length), sizeof(length));
+    buffer += bytes;
+}
+
+
+bool Message::isComplete(string_view buffer, uint64_t& size) {
+    if (buffer.size() < HEADER_SIZE)
+        return false;
+    memcpy(&size, buffer.data(), HEADER_SIZE);
+    
+    return buffer.size() - HEADER_SIZE >= size;
+}
+
+
+/**
+ * it writes all the bytes of a buffer to a socket
+ * @return false if the socket failed
+ */
+static bool writeAll(int fd, const char* data, size_t n) {
+    while (n > 0) {
+        //a closed peer fails the call instead of raising SIGPIPE
+        ssize_t written = send(fd, data, n, MSG_NOSIGNAL);
+        if (written < 0 && errno == EINTR)
+            continue;
+        if (written <= 0)
+            return false;
+        data += written;
+        n -= written;
+    }
+    
+    return true;
+}
+
+
+/**
+ * it reads a number of bytes from a socket to a buffer
+ * @return false if the socket failed or was closed before
+ */
+static bool readAll(int fd, char* data, size_t n) {
+    while (n > 0) {
+        ssize_t nRead = recv(fd, data, n, 0);
+        if (nRead < 0 && errno == EINTR)
+            continue;
+        if (nRead <= 0)
+            return false;
+        data += nRead;
+        n -= nRead;
+    }
+    
+    return true;
+}
+
+
+bool Message::write(int fd) const {
+    uint64_t length = bytes.size();
+    
+    return writeAll(fd, reinterpret_cast<const char*>(&length), sizeof(length)) && writeAll(fd, bytes.data(), bytes.size());
+}
+
+
+bool Message::read(int fd) {
+    uint64_t length;
+    bytes.clear();
+    position = 0;
+    isOverrun = false;
+    if (!readAll(fd, reinterpret_cast<char*>(&length), sizeof(length)))
+        return false;
+    bytes.resize(length);
+    
+    return readAll(fd, &bytes[0], length);
+}
@@ -0,0 +1,145 @@
+/*
+ * The MIT License
+ *
+ * Copyright 2017 Theomeli.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+/* 
+ * File:   Message.h
+ * Author: Theomeli
+ *
+ * Created on October 23, 2026, 10:05 AM
+ */
+
+#ifndef MESSAGE_H
+#define MESSAGE_H
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+using namespace std;
+
+/**
+ * a message exchanged by processes over a stream socket. Its fields are
+ * appended to a byte buffer and read back in the same order, numbers and 
+ * doubles as 8 bytes in the byte order of the machine and strings prefixed
+ * by their length, and the whole buffer is sent prefixed by its length, so
+ * the processes must run on the same machine
+ */
+class Message {
+public:
+    Message();
+    virtual ~Message();
+    
+    /**
+     * getter for private member bytes
+     * @return the fields of the message one after the other
+     */
+     const string& getBytes() const { return bytes; }
+    
+    /**
+     * it checks if a field was read past the end of the message
+     * @return true if all the fields read were in the message
+     */
+     bool isValid() const { return !isOverrun; }
+    
+    /**
+     * it appends a field to the message
+     * @param value is the field
+     */
+    void putNumber(uint64_t value);
+    void putDouble(double value);
+    void putString(string_view value);
+    
+    /**
+     * it reads the next field of the message. A field past the end of the
+     * message is read as 0 or an empty string and makes the message invalid
+     * @return the field
+     */
+    uint64_t getNumber();
+    double getDouble();
+    
+    /**
+     * it reads the next field of the message as getNumber does
+     * @return a view of the string into the message, valid until it changes
+     */
+    string_view getString();
+    
+    /**
+     * it takes the fields of a message, in place of the fields of this one,
+     * to be read from the first
+     * @param fields are the fields of the message, without its length
+     */
+    void setBytes(string_view fields);
+    
+    /**
+     * it appends the message to a buffer prefixed by its length, as write
+     * sends it, for a socket which is written when it is ready
+     * @param buffer is the buffer
+     */
+    void appendTo(string& buffer) const;
+    
+    /**
+     * it finds the size of the first message of a buffer read from a socket
+     * @param buffer are the bytes read
+     * @param size is set to the size of the message's fields, once its
+     * length is in the buffer
+     * @return true if the whole message is in the buffer
+     */
+    static bool isComplete(string_view buffer, uint64_t& size);
+    
+    /**
+     * it writes the message to a socket, prefixed by its length, waiting
+     * until the whole message is written
+     * @param fd is the descriptor of the socket
+     * @return false if the socket failed or was closed
+     */
+    bool write(int fd) const;
+    
+    /**
+     * it reads a message written by write from a socket, in place of the
+     * fields of this message, waiting until the whole message is read
+     * @param fd is the descriptor of the socket
+     * @return false if the socket failed or was closed
+     */
+    bool read(int fd);
+    
+    //the bytes of the length which prefixes a message
+    static const size_t HEADER_SIZE = sizeof(uint64_t);
+private:
+    //the fields of the message
+    string									bytes;
+    //the position of the next field to be read
+    size_t									position;
+    //true if a field was read past the end
+    bool									isOverrun;
+    
+    /**
+     * it reads the bytes of the next field
+     * @param target is the field
+     * @param n is the size of the field
+     */
+    void getBytes(void* target, size_t n);
+};
+
+#endif /* MESSAGE_H */
@@ -0,0 +1,331 @@
+/*
+ * The MIT License
+ *
+ * Copyright 2017 Theomeli.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+/* 
+ * File:   PositionalIndex.cpp
+ * Author: Theomeli
+ * 
+ * Created on October 25, 2026, 2:30 PM
+ */
+
+#include "PositionalIndex.h"
+#include "DocumentSets.h"
+#include <algorithm>
+
+/**
+ * it appends a value as a variable-byte number, seven bits per byte
+ * starting from the lowest, with the high bit set on all but the last byte
+ */
+static void putVariableByte(uint32_t value, vector<uint8_t>& out) {
+    while (value >= 0x80) {
+        out.push_back(uint8_t(value) | 0x80);
+        value >>= 7;
+    }
+    out.push_back(uint8_t(value));
+}
+
+
+/**
+ * it reads a variable-byte number and moves in past it
+ */
+static uint32_t getVariableByte(const uint8_t*& in) {
+    uint32_t value = 0;
+    for (unsigned shift = 0; ; shift += 7) {
+        uint8_t byte = *in++;
+        value |= uint32_t(byte & 0x7F) << shift;
+        if (byte < 0x80)
+            return value;
+    }
+}
+
+
+/**
+ * it finds the positions at which a phrase starts in a document
+ * @param lists are the ascending positions of each of the phrase's terms
+ * @param starts is set to the ascending positions of the phrase's first term
+ */
+static void findStarts(const vector<const vector<uint32_t>*>& lists, vector<uint32_t>& starts) {
+    starts.clear();
+    //the positions of the rarest term lead, the others are galloped to
+    size_t rarest = 0;
+    for (size_t i = 1; i < lists.size(); i++)
+        if (lists[i]->size() < lists[rarest]->size())
+            rarest = i;
+    vector<const uint32_t*> cursors(lists.size());
+    for (size_t i = 0; i < lists.size(); i++)
+        cursors[i] = lists[i]->data();
+    for (auto const position : *lists[rarest]) {
+        if (position < rarest)
+            continue;
+        uint32_t start = position - rarest;
+        bool isFound = true;
+        for (size_t i = 0; i < lists.size() && isFound; i++) {
+            if (i == rarest)
+                continue;
+            const uint32_t* end = lists[i]->data() + lists[i]->size();
+            cursors[i] = DocumentSets::gallop(cursors[i], end, start + i);
+            isFound = cursors[i] != end && *cursors[i] == start + i;
+        }
+        if (isFound)
+            starts.push_back(start);
+    }
+}
+
+
+PositionsCursor::PositionsCursor(const uint8_t* data, const PositionsSkip* skips, size_t n)
+    :data(data), skips(skips), n(n), group(0), rank(0), in(nullptr), docId(END), count(0), positions(nullptr) {
+    if (n > 0)
+        moveToGroup(0);
+}
+
+
+void PositionsCursor::decode(uint32_t previous) {
+    docId = previous + getVariableByte(in);
+    count = getVariableByte(in);
+    uint32_t nBytes = getVariableByte(in);
+    positions = in;
+    in += nBytes;
+}
+
+
+void PositionsCursor::moveToGroup(size_t g) {
+    group = g;
+    rank = 0;
+    in = data + skips[g].offset;
+    decode(g == 0 ? 0 : skips[g - 1].lastDocId);
+}
+
+
+void PositionsCursor::getPositions(vector<uint32_t>& positions) const {
+    positions.clear();
+    const uint8_t* temp = this->positions;
+    uint32_t position = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        position += getVariableByte(temp);
+        positions.push_back(position);
+    }
+}
+
+
+void PositionsCursor::next() {
+    if (docId == END)
+        return;
+    if (group * PositionalIndex::SKIP_INTERVAL + rank + 1 >= n) {
+        docId = END;
+        return;
+    }
+    if (rank + 1 == PositionalIndex::SKIP_INTERVAL) {
+        moveToGroup(group + 1);
+        return;
+    }
+    rank++;
+    decode(docId);
+}
+
+
+void PositionsCursor::nextGeq(uint32_t target) {
+    if (docId >= target)
+        return;
+    //the groups are galloped over by their last documents
+    if (skips[group].lastDocId < target) {
+        size_t nGroups = (n + PositionalIndex::SKIP_INTERVAL - 1) / PositionalIndex::SKIP_INTERVAL;
+        size_t low = group, step = 1;
+        while (low + step < nGroups && skips[low + step].lastDocId < target) {
+            low += step;
+            step *= 2;
+        }
+        const PositionsSkip* found = lower_bound(skips + low + 1, skips + min(low + step, nGroups), target, 
+            [](const PositionsSkip& skip, uint32_t id) { return skip.lastDocId < id; });
+        if (found == skips + nGroups) {
+            docId = END;
+            return;
+        }
+        moveToGroup(found - skips);
+    }
+    while (docId < target)
+        next();
+}
+
+
+PositionalIndex::PositionalIndex(size_t nTerms, size_t nDocuments)
+    :nTerms(nTerms), nDocuments(nDocuments), lists(nTerms), listSkips(nTerms), lastDocIds(nTerms, 0), 
+    documentFrequencies(nTerms, 0), skipOffsets(nTerms + 1, 0) {
+}
+
+
+PositionalIndex::~PositionalIndex() {
+}
+
+
+void PositionalIndex::addDocument(uint32_t docId, const vector<uint32_t>& termIds) {
+    //the pairs term id - position of the document, by term
+    vector<pair<uint32_t, uint32_t>> occurrences;
+    for (size_t position = 0; position < termIds.size(); position++)
+        if (termIds[position] < nTerms)
+            occurrences.push_back(make_pair(termIds[position], uint32_t(position)));
+    sort(occurrences.begin(), occurrences.end());
+    
+    vector<uint8_t> encoded;
+    for (size_t i = 0, end; i < occurrences.size(); i = end) {
+        uint32_t termId = occurrences[i].first;
+        encoded.clear();
+        uint32_t previous = 0;
+        for (end = i; end < occurrences.size() && occurrences[end].first == termId; end++) {
+            putVariableByte(occurrences[end].second - previous, encoded);
+            previous = occurrences[end].second;
+        }
+        
+        //a group's first document is a gap from the last one of the group before
+        vector<uint8_t>& list = lists[termId];
+        if (documentFrequencies[termId] % SKIP_INTERVAL == 0)
+            listSkips[termId].push_back(PositionsSkip{ list.size(), 0 });
+        putVariableByte(docId - lastDocIds[termId], list);
+        putVariableByte(uint32_t(end - i), list);
+        putVariableByte(uint32_t(encoded.size()), list);
+        list.insert(list.end(), encoded.begin(), encoded.end());
+        lastDocIds[termId] = docId;
+        listSkips[termId].back().lastDocId = docId;
+        documentFrequencies[termId]++;
+    }
+}
+
+
+void PositionalIndex::finish() {
+    postings.clear();
+    skips.clear();
+    for (size_t termId = 0; termId < nTerms; termId++) {
+        skipOffsets[termId] = skips.size();
+        for (auto skip : listSkips[termId]) {
+            skip.offset += postings.size();
+            skips.push_back(skip);
+        }
+        postings.insert(postings.end(), lists[termId].begin(), lists[termId].end());
+        vector<uint8_t>().swap(lists[termId]);
+    }
+    skipOffsets[nTerms] = skips.size();
+    postings.shrink_to_fit();
+    skips.shrink_to_fit();
+    vector<vector<uint8_t>>().swap(lists);
+    vector<vector<PositionsSkip>>().swap(listSkips);
+    vector<uint32_t>().swap(lastDocIds);
+}
+
+
+template<class Match>
+vector<uint32_t> PositionalIndex::findPhrases(const vector<vector<uint32_t>>& phrases, Match match) const {
+    vector<uint32_t> result;
+    //a cursor for each distinct term of the phrases
+    vector<uint32_t> termIds;
+    for (auto const &phrase : phrases) {
+        if (phrase.empty())
+            return result;
+        termIds.insert(termIds.end(), phrase.begin(), phrase.end());
+    }
+    sort(termIds.begin(), termIds.end());
+    termIds.erase(unique(termIds.begin(), termIds.end()), termIds.end());
+    vector<PositionsCursor> cursors;
+    for (auto const termId : termIds) {
+        if (getDocumentFrequency(termId) == 0)
+            return result;
+        cursors.push_back(getCursor(termId));
+    }
+    
+    //the lists are intersected from the shortest, which proposes each
+    //document that the others are moved to
+    vector<size_t> order(termIds.size());
+    for (size_t i = 0; i < order.size(); i++)
+        order[i] = i;
+    sort(order.begin(), order.end(), [&](size_t a, size_t b) { 
+        return documentFrequencies[termIds[a]] < documentFrequencies[termIds[b]]; 
+    });
+    vector<vector<uint32_t>> positions(termIds.size());
+    vector<vector<const vector<uint32_t>*>> lists(phrases.size());
+    for (size_t p = 0; p < phrases.size(); p++)
+        for (auto const termId : phrases[p])
+            lists[p].push_back(&positions[lower_bound(termIds.begin(), termIds.end(), termId) - termIds.begin()]);
+    vector<vector<uint32_t>> starts(phrases.size());
+    uint32_t candidate = cursors[order[0]].getDocId();
+    while (candidate != PositionsCursor::END) {
+        bool isCommon = true;
+        for (size_t i = 0; i < order.size() && isCommon; i++) {
+            PositionsCursor& cursor = cursors[order[i]];
+            cursor.nextGeq(candidate);
+            if (cursor.getDocId() != candidate) {
+                candidate = cursor.getDocId();
+                isCommon = false;
+            }
+        }
+        if (!isCommon)
+            continue;
+        
+        for (size_t i = 0; i < cursors.size(); i++)
+            cursors[i].getPositions(positions[i]);
+        bool isFound = true;
+        for (size_t p = 0; p < phrases.size() && isFound; p++) {
+            findStarts(lists[p], starts[p]);
+            isFound = !starts[p].empty();
+        }
+        if (isFound && match(candidate, starts))
+            result.push_back(candidate);
+        cursors[order[0]].next();
+        candidate = cursors[order[0]].getDocId();
+    }
+    
+    return result;
+}
+
+
+vector<uint32_t> PositionalIndex::findPhrase(const vector<uint32_t>& phrase) const {
+    return findPhrases(vector<vector<uint32_t>>(1, phrase), [](uint32_t, const vector<vector<uint32_t>>&) { 
+        return true; 
+    });
+}
+
+
+vector<uint32_t> PositionalIndex::findNear(const vector<uint32_t>& first, const vector<uint32_t>& second, 
+    size_t distance) const {
+    return findPhrases(vector<vector<uint32_t>>{ first, second }, 
+        [distance](uint32_t, const vector<vector<uint32_t>>& starts) {
+        //for each start of the first phrase the second's are galloped
+        //to the least one which may be near it
+        const vector<uint32_t>& others = starts[1];
+        const uint32_t* cursor = others.data();
+        const uint32_t* end = others.data() + others.size();
+        for (auto const start : starts[0]) {
+            cursor = DocumentSets::gallop(cursor, end, start > distance ? uint32_t(start - distance) : 0);
+            if (cursor == end)
+                return false;
+            if (*cursor <= uint64_t(start) + distance)
+                return true;
+        }
+        return false;
+    });
+}
+
+
+size_t PositionalIndex::getMemoryUsage() const {
+    return postings.capacity() + skips.capacity() * sizeof(PositionsSkip) + skipOffsets.capacity() * sizeof(uint64_t) 
+        + documentFrequencies.capacity() * sizeof(uint32_t);
+}
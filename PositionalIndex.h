@@ -0,0 +1,243 @@
+/*
+ * The MIT License
+ *
+ * Copyright 2017 Theomeli.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+/* 
+ * File:   PositionalIndex.h
+ * Author: Theomeli
+ *
+ * Created on October 25, 2026, 2:30 PM
+ */
+
+#ifndef POSITIONALINDEX_H
+#define POSITIONALINDEX_H
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+using namespace std;
+
+/**
+ * a skip pointer of a positional postings list: the start of a group of
+ * postings and the id of the last document of the group
+ */
+struct PositionsSkip {
+    uint64_t offset;
+    uint32_t lastDocId;
+};
+
+/**
+ * a cursor over a positional postings list, moving by ascending document id.
+ * A cursor moved far ahead finds the group which would hold its target by
+ * galloping over the skip pointers and decodes only the postings of that group
+ */
+class PositionsCursor {
+public:
+    //the document id of a cursor past the end of its list
+    static const uint32_t END = UINT32_MAX;
+    
+    /**
+     * it places the cursor on the first posting of a list
+     * @param data is the start of the index's lists
+     * @param skips are the skip pointers of the list, one for each group
+     * @param n is the number of postings of the list
+     */
+    PositionsCursor(const uint8_t* data, const PositionsSkip* skips, size_t n);
+    
+    /**
+     * getter for private member docId
+     * @return the id of the current document or END
+     */
+     uint32_t getDocId() const { return docId; }
+    
+    /**
+     * getter for private member count
+     * @return the number of positions of the term in the current document
+     */
+     uint32_t getCount() const { return count; }
+    
+    /**
+     * it decodes the positions of the term in the current document
+     * @param positions is set to the ascending positions
+     */
+    void getPositions(vector<uint32_t>& positions) const;
+    
+    /**
+     * it moves the cursor to the next posting
+     */
+    void next();
+    
+    /**
+     * it moves the cursor to the first posting whose document id is
+     * not less than target
+     * @param target is the document id
+     */
+    void nextGeq(uint32_t target);
+private:
+    //the start of the index's lists
+    const uint8_t*								data;
+    //the skip pointers of the list
+    const PositionsSkip*							skips;
+    //the number of postings of the list
+    size_t									n;
+    //the group of the current posting and its rank in the group
+    size_t									group;
+    size_t									rank;
+    //the posting after the current one
+    const uint8_t*								in;
+    //the id of the current document
+    uint32_t								docId;
+    //the number of positions of the current posting
+    uint32_t								count;
+    //the encoded positions of the current posting
+    const uint8_t*								positions;
+    
+    /**
+     * it decodes the posting at in
+     * @param previous is the id of the document of the posting before it
+     */
+    void decode(uint32_t previous);
+    
+    /**
+     * it moves the cursor to the first posting of a group
+     * @param g is the group
+     */
+    void moveToGroup(size_t g);
+};
+
+/**
+ * the positions of the terms in the documents, for the queries which ask for
+ * phrases or for terms near each other. A term's list holds for each document
+ * containing it the gap from the previous document's id, the number of
+ * positions, the bytes they take and the positions as gaps from the previous
+ * one, all variable-byte numbers. The lists are cut into groups of SKIP_INTERVAL
+ * postings, each with a skip pointer, so that an intersection passes over the
+ * groups which cannot hold its next document without decoding them
+ */
+class PositionalIndex {
+public:
+    //the number of postings of a group
+    static const size_t SKIP_INTERVAL = 64;
+    
+    PositionalIndex(size_t nTerms, size_t nDocuments);
+    PositionalIndex(const PositionalIndex& orig) = delete;
+    PositionalIndex& operator =(const PositionalIndex& rightSide) = delete;
+    virtual ~PositionalIndex();
+    
+    /**
+     * getter for private member nDocuments
+     * @return the number of documents of the index
+     */
+     size_t getNDocuments() const { return nDocuments; }
+    
+    /**
+     * getter for the number of documents which contain a term
+     * @param termId is the id of the term
+     * @return the length of the term's list
+     */
+     size_t getDocumentFrequency(size_t termId) const { return termId < nTerms ? documentFrequencies[termId] : 0; }
+    
+    /**
+     * getter for a cursor over the positional postings list of a term
+     * @param termId is the id of the term, less than the number of terms
+     * @return the cursor on the first posting
+     */
+     PositionsCursor getCursor(size_t termId) const { 
+         return PositionsCursor(postings.data(), skips.data() + skipOffsets[termId], documentFrequencies[termId]); 
+     }
+    
+    /**
+     * it appends the positions of the terms of a document. Documents must
+     * be added in ascending order of their ids
+     * @param docId is the id of the document
+     * @param termIds are the ids of the document's tokens in their order,
+     * the position of a token being its rank
+     */
+    void addDocument(uint32_t docId, const vector<uint32_t>& termIds);
+    
+    /**
+     * it puts the lists one after the other with their skip pointers. It 
+     * must be called once all the documents have been added
+     */
+    void finish();
+    
+    /**
+     * it finds the documents which contain a phrase
+     * @param phrase are the ids of the phrase's terms in their order
+     * @return the ascending ids of the documents
+     */
+    vector<uint32_t> findPhrase(const vector<uint32_t>& phrase) const;
+    
+    /**
+     * it finds the documents which contain two phrases whose first terms
+     * are at most distance positions apart, in either order
+     * @param first are the ids of the first phrase's terms
+     * @param second are the ids of the second phrase's terms
+     * @param distance is the greatest distance
+     * @return the ascending ids of the documents
+     */
+    vector<uint32_t> findNear(const vector<uint32_t>& first, const vector<uint32_t>& second, size_t distance) const;
+    
+    /**
+     * it computes the bytes which the index takes
+     * @return the bytes of its storage
+     */
+    size_t getMemoryUsage() const;
+private:
+    //number of terms of the index
+    size_t									nTerms;
+    //number of documents of the index
+    size_t									nDocuments;
+    //for each term its encoded list and skip pointers,
+    //with offsets from the list's start, and the id of
+    //its last document while the documents are added
+    vector<vector<uint8_t>>							lists;
+    vector<vector<PositionsSkip>>						listSkips;
+    vector<uint32_t>							lastDocIds;
+    //the length of each term's list
+    vector<uint32_t>							documentFrequencies;
+    //the encoded lists one after the other
+    vector<uint8_t>								postings;
+    //the skip pointers of the lists one after the other,
+    //with offsets from the start of postings
+    vector<PositionsSkip>							skips;
+    //the start of each term's skip pointers in skips
+    //followed by the end of the last term's
+    vector<uint64_t>							skipOffsets;
+    
+    /**
+     * it finds the documents which contain all the phrases of a query and
+     * the positions of each phrase in them
+     * @param phrases are the phrases, each the ids of its terms
+     * @param match is called with the id of each document and the ascending
+     * positions of each phrase's first term in it, and returns true if the
+     * document is kept
+     * @return the ascending ids of the documents kept
+     */
+    template<class Match>
+    vector<uint32_t> findPhrases(const vector<vector<uint32_t>>& phrases, Match match) const;
+};
+
+#endif /* POSITIONALINDEX_H */
+
@@ -0,0 +1,268 @@
+/*
+ * The MIT License
+ *
+ * Copyright 2017 Theomeli.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/* 
+ * File:   PostingsCodec.cpp
+ * Author: Theomeli
+ * 
+ * Created on October 19, 2026, 11:25 AM
+ */
+
+#include "PostingsCodec.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+PostingsCodec::Kernel PostingsCodec::kernel = PostingsCodec::detectKernel();
+
+
+/**
+ * it finds the number of bits a value needs
+ * @param value is the value
+ * @return 0 for 0, otherwise the position of its highest set bit plus one
+ */
+static unsigned bitsOf(uint32_t value) {
+    return value == 0 ? 0 : 32 - __builtin_clz(value);
+}
+
+
+/**
+ * it appends a value as a variable-byte number, seven bits per byte
+ * starting from the lowest, with the high bit set on all but the last byte
+ */
+static void putVariableByte(uint32_t value, vector<uint8_t>& out) {
+    while (value >= 0x80) {
+        out.push_back(uint8_t(value) | 0x80);
+        value >>= 7;
+    }
+    out.push_back(uint8_t(value));
+}
+
+
+/**
+ * it reads a variable-byte number and moves in past it
+ */
+static uint32_t getVariableByte(const uint8_t*& in) {
+    uint32_t value = 0;
+    for (unsigned shift = 0; ; shift += 7) {
+        uint8_t byte = *in++;
+        value |= uint32_t(byte & 0x7F) << shift;
+        if (byte < 0x80)
+            return value;
+    }
+}
+
+
+PostingsCodec::Kernel PostingsCodec::detectKernel() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse2"))
+        return SSE2;
+#endif
+    return SCALAR;
+}
+
+
+void PostingsCodec::setKernel(Kernel k) {
+    Kernel best = detectKernel();
+    kernel = k < best ? k : best;
+}
+
+
+void PostingsCodec::pack(const uint32_t* in, unsigned bits, uint8_t* out) {
+    //value i is in lane i % 4, after the bits of the values before it in the lane
+    uint32_t words[4 * 32] = { 0 };
+    for (size_t i = 0; bits > 0 && i < BLOCK_SIZE; i++) {
+        size_t lane = i & 3, position = (i >> 2) * bits;
+        size_t word = position >> 5, shift = position & 31;
+        words[word * 4 + lane] |= in[i] << shift;
+        if (shift + bits > 32)
+            words[(word + 1) * 4 + lane] |= in[i] >> (32 - shift);
+    }
+    memcpy(out, words, 16 * bits);
+}
+
+
+float PostingsCodec::roundUp(double value) {
+    float temp = float(value);
+    
+    return temp < value ? nextafterf(temp, INFINITY) : temp;
+}
+
+
+void PostingsCodec::encode(const uint32_t* docIds, const uint32_t* frequencies, const double* impacts, size_t n, 
+    vector<uint8_t>& out) {
+    uint32_t previous = 0;
+    uint32_t gaps[BLOCK_SIZE], values[BLOCK_SIZE];
+    for (size_t start = 0; start < n; start += BLOCK_SIZE) {
+        size_t count = min(BLOCK_SIZE, n - start);
+        unsigned docBits = 0, frequencyBits = 0;
+        double maxImpact = 0;
+        for (size_t i = 0; i < count; i++) {
+            if (impacts != nullptr)
+                maxImpact = max(maxImpact, impacts[start + i]);
+            gaps[i] = docIds[start + i] - (i == 0 ? previous : docIds[start + i - 1]);
+            values[i] = frequencies[start + i] - 1;
+            docBits = max(docBits, bitsOf(gaps[i]));
+            frequencyBits = max(frequencyBits, bitsOf(values[i]));
+        }
+        previous = docIds[start + count - 1];
+        
+        float bound = roundUp(maxImpact);
+        size_t size = out.size();
+        out.resize(size + sizeof(previous) + sizeof(bound));
+        memcpy(&out[size], &previous, sizeof(previous));
+        memcpy(&out[size + sizeof(previous)], &bound, sizeof(bound));
+        if (count == BLOCK_SIZE) {
+            size = out.size();
+            out.resize(size + 4 + 16 * (docBits + frequencyBits), 0);
+            out[size] = docBits;
+            out[size + 1] = frequencyBits;
+            pack(gaps, docBits, &out[size + 4]);
+            pack(values, frequencyBits, &out[size + 4 + 16 * docBits]);
+        }
+        else {
+            for (size_t i = 0; i < count; i++)
+                putVariableByte(gaps[i], out);
+            for (size_t i = 0; i < count; i++)
+                putVariableByte(values[i], out);
+        }
+    }
+}
+
+
+const uint8_t* PostingsCodec::decode(const uint8_t* in, size_t count, uint32_t previous, uint32_t* docIds, 
+    uint32_t* frequencies) {
+    in += sizeof(uint32_t) + sizeof(float);
+    if (count < BLOCK_SIZE) {
+        for (size_t i = 0; i < count; i++) {
+            previous += getVariableByte(in);
+            docIds[i] = previous;
+        }
+        for (size_t i = 0; i < count; i++)
+            frequencies[i] = getVariableByte(in) + 1;
+        
+        return in;
+    }
+    
+    unsigned docBits = in[0], frequencyBits = in[1];
+    in += 4;
+#if defined(__x86_64__) || defined(__i386__)
+    if (kernel == SSE2)
+        decodeSse2(in, docBits, frequencyBits, previous, docIds, frequencies);
+    else
+#endif
+        decodeScalar(in, docBits, frequencyBits, previous, docIds, frequencies);
+    
+    return in + 16 * (docBits + frequencyBits);
+}
+
+
+void PostingsCodec::unpackScalar(const uint8_t* in, unsigned bits, uint32_t* out) {
+    if (bits == 0) {
+        fill(out, out + BLOCK_SIZE, 0);
+        return;
+    }
+    uint32_t words[4 * 32];
+    memcpy(words, in, 16 * bits);
+    uint32_t mask = bits == 32 ? ~0u : (1u << bits) - 1;
+    for (size_t i = 0; i < BLOCK_SIZE; i++) {
+        size_t lane = i & 3, position = (i >> 2) * bits;
+        size_t word = position >> 5, shift = position & 31;
+        uint32_t value = words[word * 4 + lane] >> shift;
+        if (shift + bits > 32)
+            value |= words[(word + 1) * 4 + lane] << (32 - shift);
+        out[i] = value & mask;
+    }
+}
+
+
+void PostingsCodec::decodeScalar(const uint8_t* in, unsigned docBits, unsigned frequencyBits, uint32_t previous, 
+    uint32_t* docIds, uint32_t* frequencies) {
+    unpackScalar(in, docBits, docIds);
+    unpackScalar(in + 16 * docBits, frequencyBits, frequencies);
+    for (size_t i = 0; i < BLOCK_SIZE; i++) {
+        previous += docIds[i];
+        docIds[i] = previous;
+        frequencies[i]++;
+    }
+}
+
+
+#if defined(__x86_64__) || defined(__i386__)
+__attribute__((target("sse2")))
+void PostingsCodec::unpackSse2(const uint8_t* in, unsigned bits, uint32_t* out) {
+    __m128i* destination = reinterpret_cast<__m128i*>(out);
+    if (bits == 0) {
+        for (size_t row = 0; row < BLOCK_SIZE / 4; row++)
+            _mm_storeu_si128(destination + row, _mm_setzero_si128());
+        return;
+    }
+    //each row of four values takes the next bits of the four lanes
+    const __m128i* source = reinterpret_cast<const __m128i*>(in);
+    __m128i mask = _mm_set1_epi32(bits == 32 ? -1 : int((1u << bits) - 1));
+    __m128i current = _mm_loadu_si128(source++);
+    unsigned shift = 0;
+    for (size_t row = 0; row < BLOCK_SIZE / 4; row++) {
+        __m128i value = _mm_srl_epi32(current, _mm_cvtsi32_si128(shift));
+        shift += bits;
+        if (shift > 32) {
+            current = _mm_loadu_si128(source++);
+            shift -= 32;
+            value = _mm_or_si128(value, _mm_sll_epi32(current, _mm_cvtsi32_si128(bits - shift)));
+        }
+        else if (shift == 32 && row + 1 < BLOCK_SIZE / 4) {
+            current = _mm_loadu_si128(source++);
+            shift = 0;
+        }
+        _mm_storeu_si128(destination + row, _mm_and_si128(value, mask));
+    }
+}
+
+
+__attribute__((target("sse2")))
+void PostingsCodec::decodeSse2(const uint8_t* in, unsigned docBits, unsigned frequencyBits, uint32_t previous, 
+    uint32_t* docIds, uint32_t* frequencies) {
+    unpackSse2(in, docBits, docIds);
+    unpackSse2(in + 16 * docBits, frequencyBits, frequencies);
+    
+    //prefix sums of four gaps at a time, carrying the last id of each row
+    __m128i carry = _mm_set1_epi32(int(previous));
+    __m128i one = _mm_set1_epi32(1);
+    __m128i* ids = reinterpret_cast<__m128i*>(docIds);
+    __m128i* values = reinterpret_cast<__m128i*>(frequencies);
+    for (size_t row = 0; row < BLOCK_SIZE / 4; row++) {
+        __m128i gaps = _mm_loadu_si128(ids + row);
+        gaps = _mm_add_epi32(gaps, _mm_slli_si128(gaps, 4));
+        gaps = _mm_add_epi32(gaps, _mm_slli_si128(gaps, 8));
+        carry = _mm_add_epi32(gaps, carry);
+        _mm_storeu_si128(ids + row, carry);
+        carry = _mm_shuffle_epi32(carry, 0xFF);
+        _mm_storeu_si128(values + row, _mm_add_epi32(_mm_loadu_si128(values + row), one));
+    }
+}
+#endif
@@ -0,0 +1,159 @@
+/*
+ * The MIT License
+ *
+ * Copyright 2017 Theomeli.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/* 
+ * File:   PostingsCodec.h
+ * Author: Theomeli
+ *
+ * Created on October 19, 2026, 11:25 AM
+ */
+
+#ifndef POSTINGSCODEC_H
+#define POSTINGSCODEC_H
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+using namespace std;
+
+/**
+ * it compresses a postings list, the ascending ids of the documents which
+ * contain a term and the frequency of the term in each of them. The list is
+ * cut into blocks of BLOCK_SIZE postings, each starting with the id of its 
+ * last document and the greatest impact of its postings, so that a block can
+ * be skipped or bounded without being decoded. The ids are stored as the gaps from the previous id and the
+ * frequencies less one. In a full block both are bit-packed with the fewest
+ * bits their greatest value needs, in four interleaved 32-bit lanes so that
+ * SSE2 unpacks four values at a time. The last block of a list, when shorter,
+ * stores them as variable-byte numbers
+ */
+class PostingsCodec {
+public:
+    //the number of postings of a full block
+    static const size_t BLOCK_SIZE = 128;
+    
+    //the kernels which may decode a block
+    enum Kernel { SCALAR, SSE2 };
+    
+    /**
+     * getter for the kernel chosen for this processor
+     * @return the kernel used by decode
+     */
+     static Kernel getKernel() { return kernel; }
+    
+    /**
+     * it chooses the kernel used by decode. A kernel the processor does
+     * not support falls back to the best one it supports
+     * @param k is the kernel to be used
+     */
+    static void setKernel(Kernel k);
+    
+    /**
+     * getter for the id of the last document of a block
+     * @param block is the start of the block
+     * @return the id
+     */
+     static uint32_t getLastDocId(const uint8_t* block) { uint32_t v; memcpy(&v, block, sizeof(v)); return v; }
+    
+    /**
+     * getter for the greatest impact of the postings of a block
+     * @param block is the start of the block
+     * @return the impact, rounded up to a float
+     */
+     static float getMaxImpact(const uint8_t* block) { float v; memcpy(&v, block + 4, sizeof(v)); return v; }
+    
+    /**
+     * it finds the start of the block after a full block
+     * @param block is the start of a block of BLOCK_SIZE postings
+     * @return the start of the next block
+     */
+     static const uint8_t* skip(const uint8_t* block) { return block + 12 + 16 * (block[8] + block[9]); }
+    
+    /**
+     * it compresses a postings list and appends it to out
+     * @param docIds are the ascending ids of the documents
+     * @param frequencies are the frequencies of the term, at least one
+     * @param impacts are the impacts of the postings, whose greatest in
+     * each block is kept in its header. They may be nullptr, for no bounds
+     * @param n is the number of postings
+     * @param out is where the compressed list is appended
+     */
+    static void encode(const uint32_t* docIds, const uint32_t* frequencies, const double* impacts, size_t n, 
+        vector<uint8_t>& out);
+    
+    /**
+     * it rounds a value up to a float, so that a bound stays a bound
+     * @param value is the value
+     * @return the least float which is not less than value
+     */
+    static float roundUp(double value);
+    
+    /**
+     * it decodes a block of a compressed list
+     * @param in is the start of the block
+     * @param count is the number of postings of the block, BLOCK_SIZE
+     * for all the blocks but the last of the list
+     * @param previous is the id of the last document of the previous
+     * block or 0 for the first block
+     * @param docIds is where the ids of the documents are written
+     * @param frequencies is where the frequencies are written
+     * @return the start of the next block
+     */
+    static const uint8_t* decode(const uint8_t* in, size_t count, uint32_t previous, uint32_t* docIds, 
+        uint32_t* frequencies);
+private:
+    //the kernel chosen for this processor
+    static Kernel								kernel;
+    
+    /**
+     * it bit-packs BLOCK_SIZE values to 16 * bits bytes
+     * @param in are the values, each fitting in bits
+     * @param bits is the width of a value
+     * @param out is where the packed bytes are written
+     */
+    static void pack(const uint32_t* in, unsigned bits, uint8_t* out);
+    
+    /**
+     * the kernels of decode for a full block: they unpack the gaps and the
+     * frequencies and turn the gaps to document ids
+     */
+    static void decodeScalar(const uint8_t* in, unsigned docBits, unsigned frequencyBits, uint32_t previous, 
+        uint32_t* docIds, uint32_t* frequencies);
+    static void unpackScalar(const uint8_t* in, unsigned bits, uint32_t* out);
+#if defined(__x86_64__) || defined(__i386__)
+    static void decodeSse2(const uint8_t* in, unsigned docBits, unsigned frequencyBits, uint32_t previous, 
+        uint32_t* docIds, uint32_t* frequencies);
+    static void unpackSse2(const uint8_t* in, unsigned bits, uint32_t* out);
+#endif
+    
+    /**
+     * it finds the best kernel the processor supports
+     * @return the kernel
+     */
+    static Kernel detectKernel();
+};
+
+#endif /* POSTINGSCODEC_H */
+
@@ -30,151 +30,204 @@
  */
 
 #include "ProcessFiles.h"
-#include <iostream>
+#include "Instrumentation.h"
+#include <algorithm>
 
 
 using namespace std;
 
-ProcessFiles::ProcessFiles(): documentsText("documentsText.txt"), queriesText("queriesText.txt") {
-    if (documentsText.fail()) {
-        std::cout << "documents file opening failed.";
-            exit(1);
-    }
-    if (queriesText.fail()) {
-        std::cout << "queries file opening failed.";
-            exit(1);
-    }
+ProcessFiles::ProcessFiles(): ProcessFiles("documentsText.txt", "queriesText.txt") {
 }
 
 
-ProcessFiles::ProcessFiles(const ProcessFiles& orig)
-    :nDocuments(orig.getNDocuments()), nQueries(orig.getNQueries()), nResponses(orig.getNResponses()) {
-    documentsTokens = new list<string>[nDocuments + 1];
-    list<string>::iterator iter;
-    for (size_t i = 1; i <= nDocuments; i++) {
-        for (iter = orig.getDocumentsTokens()[i].begin(); iter != orig.getDocumentsTokens()[i].end(); iter++)
-            documentsTokens[i].push_back(*iter);
+ProcessFiles::ProcessFiles(const string& documentsFileName, const string& queriesFileName)
+    :nDocuments(0), nQueries(0), shardId(0), nShards(1) {
+    if (!documentsFileName.empty()) {
+        documentsMapping.open(documentsFileName);
+        if (documentsMapping.fail())
+            error = "documents file " + documentsFileName + " opening failed.";
     }
-    
-    queriesTokens = new list<string>[nQueries + 1];
-    for (size_t i = 1; i <= nQueries; i++) {
-        for (iter = orig.getQueriesTokens()[i].begin(); iter != orig.getQueriesTokens()[i].end(); iter++)
-            queriesTokens[i].push_back(*iter);
+    if (!queriesFileName.empty()) {
+        queriesMapping.open(queriesFileName);
+        if (queriesMapping.fail() && error.empty())
+            error = "queries file " + queriesFileName + " opening failed.";
     }
+    //until queries are read there is only the blank query 0
+    queriesTokens.finish(1);
 }
 
 
-ProcessFiles& ProcessFiles::operator =(const ProcessFiles& rightSide) {
-   	documentsTokens = new list<string>[rightSide.getNDocuments() + 1];
+ProcessFiles::~ProcessFiles() {
+}
 
-    nDocuments = rightSide.getNDocuments();
-    list<string>::iterator iter;
-    for (size_t i = 0; i <= nDocuments; i++) {
-        for (iter = rightSide.getDocumentsTokens()[i].begin(); iter != rightSide.getDocumentsTokens()[i].end(); iter++) {
-			documentsTokens[i].push_back(*iter);
-        }
-    }      
-    queriesTokens = new list<string>[rightSide.getNQueries() + 1];
 
-    nQueries = rightSide.getNQueries();
-    for (size_t i = 0; i <= nQueries; i++) {
-        for (iter = rightSide.getQueriesTokens()[i].begin(); iter != rightSide.getQueriesTokens()[i].end(); iter++)
-            queriesTokens[i].push_back(*iter);
-    }
-    
-    nResponses = rightSide.getNResponses();
-    
-    return *this;
+void ProcessFiles::setShard(size_t shardId, size_t nShards) {
+    this->nShards = max(size_t(1), nShards);
+    this->shardId = min(shardId, this->nShards - 1);
 }
 
 
-ProcessFiles::~ProcessFiles() {
+bool ProcessFiles::nextToken(string_view buffer, size_t& position, size_t end, string_view& token) {
+    while (position < end && isspace(buffer[position]))
+        position++;
+    size_t tokenStart = position;
+    while (position < end && !isspace(buffer[position]))
+        position++;
+    token = buffer.substr(tokenStart, position - tokenStart);
+    
+    return !token.empty();
 }
 
 
-string ProcessFiles::makeLower(const string& s) {
-    size_t sLength = s.length();
-    string temp(s);
-    for (size_t i = 0; i < sLength; i++) {
-        temp[i] = tolower(s[i]);
-    }
+size_t ProcessFiles::parseNumber(string_view token) {
+    size_t number = 0;
+    for (size_t i = 0; i < token.size() && isdigit(token[i]); i++)
+        number = 10 * number + (token[i] - '0');
     
-    return temp;
+    return number;
 }
 
 
-string ProcessFiles::removePunct(const string& s, const string& punct) {
-    string noPunct; //initialized to empty string
-    size_t sLength = s.length();
-    size_t punctLength = punct.length( );
-    for (size_t i = 0; i < sLength; i++) {
-        string aChar = s.substr(i,1); //A one-character string
-	size_t location = punct.find(aChar, 0);
-        //Find location of successive characters of src in punct.
-        if (location < 0 || location >= punctLength)
-            noPunct += aChar;//aChar is not in punct, so keep it
-    }
-
-    return noPunct;
- }
+void ProcessFiles::readDocumentsFile(const MappedFile& mapping, IndexBuilder& builder, QueryExecutor& executor) {
+    readDocuments(mapping.getView(), builder, executor);
+}
 
 
-string ProcessFiles::lowerRemovedPunct(const string& s) {
-    string punct(",;:.?!'\" \n"); //includes a blank
-    string str(s);
-    str = makeLower(str);
+void ProcessFiles::readDocuments(string_view buffer, IndexBuilder& builder, QueryExecutor& executor) {
+    INSTRUMENT_PHASE(READ_DOCUMENTS_FILE);
+    //the first token is the number of documents
+    size_t position = 0;
+    string_view token;
+    nextToken(buffer, position, buffer.size(), token);
+    nDocuments = parseNumber(token);
+    
+    //at least a range per thread and more for the workers to steal, 
+    //but not ranges too small to be worth a thread
+    const size_t minRangeSize = 1 << 16;
+    size_t nRanges = min(4 * executor.getNThreads(), max(size_t(1), (buffer.size() - position) / minRangeSize));
+    vector<size_t> bounds(nRanges + 1, buffer.size());
+    bounds[0] = position;
+    for (size_t i = 1; i < nRanges; i++)
+        bounds[i] = max(bounds[i - 1], findDocumentStart(buffer, position + (buffer.size() - position) * i / nRanges));
     
-    return removePunct(str, punct);
+    vector<IndexBuilder> partials(nRanges);
+    vector<TokenArena> texts(nRanges);
+    executor.run(nRanges, [&](size_t range, size_t /*worker*/) {
+        readDocumentsRange(buffer, bounds[range], bounds[range + 1], partials[range], texts[range]);
+    });
+    
+    //the texts of the ranges are put in a single arena of the exact size,
+    //document 0 left blank, which is compressed and then freed
+    size_t nBytes = 0;
+    for (auto const &ent1 : texts)
+        nBytes += ent1.getCharacters().size();
+    TokenArena arena;
+    arena.reserve(nBytes);
+    builder.setNDocuments(nDocuments);
+    for (size_t i = 0; i < nRanges; i++) {
+        builder.merge(partials[i]);
+        arena.append(texts[i]);
+        texts[i] = TokenArena();
+    }
+    arena.finish(nDocuments + 1);
+    builder.finish();
+    documents.build(arena, executor);
 }
 
 
-void ProcessFiles::readDocumentsFile(ifstream& stream) {
-    size_t documentId;
-    string token;
-
-    stream >> nDocuments;
-    //we leave documentsTokens[0] blank
-    documentsTokens = new list<string>[nDocuments + 1];
-    while (!stream.eof()) {
-        stream >> token;
+void ProcessFiles::readDocumentsRange(string_view buffer, size_t begin, size_t end, IndexBuilder& builder, 
+    TokenArena& texts) {
+    INSTRUMENT_PHASE(READ_DOCUMENTS_RANGE);
+    builder.setNDocuments(0);
+    size_t position = begin;
+    string_view token;
+    string scratch;
+    size_t nTokens = 0;
+    //the tokens of the documents of other shards are skipped
+    size_t firstDocId = getFirstDocId(), lastDocId = getLastDocId();
+    bool isSkipped = false;
+    while (nextToken(buffer, position, end, token)) {
+        nTokens++;
         if (isdigit(token[0])) {
-            documentId = atoi(token.c_str());
+            size_t documentId = parseNumber(token);
+            isSkipped = nShards > 1 && (documentId < firstDocId || documentId > lastDocId);
+            if (!isSkipped) {
+                builder.startDocument(documentId);
+                texts.startText(documentId);
+            }
         }
-        else {
-            token = lowerRemovedPunct(token);
-            documentsTokens[documentId].push_back(token);
+        else if (!isSkipped) {
+            token = TokenNormalizer::normalize(token, scratch);
+            builder.addToken(token);
+            //tokens before the first document id belong to document 0
+            texts.addToken(token);
         }
     }
+    builder.finish();
+    INSTRUMENT_COUNT(TOKENS_PARSED, nTokens);
+}
+
+
+size_t ProcessFiles::findDocumentStart(string_view buffer, size_t position) {
+    while (position < buffer.size()) {
+        //go to the start of the next line
+        while (position < buffer.size() && buffer[position] != '\n')
+            position++;
+        position++;
+        
+        size_t tokenStart = position;
+        while (tokenStart < buffer.size() && (buffer[tokenStart] == ' ' || buffer[tokenStart] == '\t' || buffer[tokenStart] == '\r'))
+            tokenStart++;
+        if (tokenStart < buffer.size() && isdigit(buffer[tokenStart]))
+            return position;
+    }
+    
+    return buffer.size();
+}
+
+
+void ProcessFiles::readQueriesFile(const MappedFile& mapping) {
+    readQueries(mapping.getView());
 }
 
 
-void ProcessFiles::readQueriesFile(ifstream& stream) {
-    size_t queryId;
+void ProcessFiles::readQueries(string_view buffer) {
+    INSTRUMENT_PHASE(READ_QUERIES_FILE);
+    size_t queryId = 0;
     size_t nResultsOfQuery;
-    string token;
+    string_view token;
+    string scratch;
     //if integersRead is equal to zero we are waiting another int to be read
     //if it is one, which it means that we have already read one int, we do the mapping
     size_t integersRead = 0;
+    size_t nTokens = 0;
 
-    stream >> nQueries;
+    size_t position = 0;
+    nextToken(buffer, position, buffer.size(), token);
+    nQueries = parseNumber(token);
     //we leave queriesTokens[0] blank
-    queriesTokens = new list<string>[nQueries + 1];
-    while (!stream.eof()) {
-        stream >> token;
+    queriesTokens = TokenArena();
+    while (nextToken(buffer, position, buffer.size(), token)) {
         if (isdigit(token[0])) {
             if (integersRead == 0) {
-                queryId = atoi(token.c_str());
+                queryId = parseNumber(token);
+                if (queryId <= nQueries)
+                    queriesTokens.startText(queryId);
 		integersRead++;
             }
             else if (integersRead == 1) {
-                nResultsOfQuery = atoi(token.c_str());
+                nResultsOfQuery = parseNumber(token);
 		nResponses.insert(pair<size_t, size_t>(queryId, nResultsOfQuery));
                 integersRead = 0;
             }
         }
-        else {
-            token = lowerRemovedPunct(token);
-            queriesTokens[queryId].push_back(token);
+        //tokens of a query beyond nQueries have nowhere to go
+        else if (queryId <= nQueries) {
+            token = TokenNormalizer::normalize(token, scratch);
+            queriesTokens.addToken(token);
+            nTokens++;
         }
     }
+    queriesTokens.finish(nQueries + 1);
+    INSTRUMENT_COUNT(TOKENS_PARSED, nTokens);
 }
@@ -31,43 +31,74 @@
 
 #ifndef PROCESSFILES_H
 #define PROCESSFILES_H
-#include <fstream>
 #include <string>
-#include <list>
+#include <string_view>
+#include <vector>
 #include <map>
+#include "IndexBuilder.h"
+#include "QueryExecutor.h"
+#include "MappedFile.h"
+#include "TokenNormalizer.h"
+#include "TokenArena.h"
+#include "DocumentStore.h"
 
 using namespace std;
 
 class ProcessFiles {
 public:
     ProcessFiles();
-    ProcessFiles(const ProcessFiles& orig);
-    ProcessFiles& operator =(const ProcessFiles& rightSide);
+    
+    /**
+     * it opens the documents and the queries files. A file with an empty
+     * name is not opened, as the documents file when the index is loaded
+     * from an index file or the queries file of a shard, which receives 
+     * the queries from its coordinator. A file which cannot be opened is
+     * reported by getError
+     * @param documentsFileName is the path of the documents file
+     * @param queriesFileName is the path of the queries file
+     */
+    ProcessFiles(const string& documentsFileName, const string& queriesFileName);
+    ProcessFiles(const ProcessFiles& orig) = delete;
+    ProcessFiles& operator =(const ProcessFiles& rightSide) = delete;
+    ProcessFiles(ProcessFiles&& orig) = default;
+    ProcessFiles& operator =(ProcessFiles&& rightSide) = default;
     virtual ~ProcessFiles();
     
     /**
-     * getter for private member documentsText
-     * @return the ifstream documentsText
+     * it checks if a file could not be opened, like ifstream::fail
+     * @return true if a file could not be opened
+     */
+     bool fail() const { return !error.empty(); }
+    
+    /**
+     * getter for private member error
+     * @return which file could not be opened
+     */
+     const string& getError() const { return error; }
+    
+    /**
+     * getter for private member documentsMapping
+     * @return the memory mapping of the documents file
      */
-     ifstream& getDocumentsText() { return documentsText; }
+     const MappedFile& getDocumentsMapping() const { return documentsMapping; }
     
     /**
-     * getter for private member queriesText
-     * @return the ifstream queriesText
+     * getter for private member queriesMapping
+     * @return the memory mapping of the queries file
      */
-     ifstream& getQueriesText() { return queriesText; }
+     const MappedFile& getQueriesMapping() const { return queriesMapping; }
     
     /**
-     * getter for private member documentsTokens
-     * @return the list of documentsTokens
+     * getter for private member documents
+     * @return the compressed normalized text of each document
      */
-     list<string>* getDocumentsTokens() const { return documentsTokens; }
+     const DocumentStore& getDocuments() const { return documents; }
     
     /**
      * getter for private member queriesTokens
-     * @return the list of queriesTokens
+     * @return the normalized tokens of each query
      */
-     list<string>* getQueriesTokens() const { return queriesTokens; }
+     const TokenArena& getQueriesTokens() const { return queriesTokens; }
     
     /**
      * getter for private member nDocuments
@@ -87,67 +118,134 @@ public:
      */
      map<size_t, size_t> getNResponses() const { return nResponses; }
     
+    /**
+     * getter for private member nShards
+     * @return the number of parts of the collection, 1 unless setShard was called
+     */
+     size_t getNShards() const { return nShards; }
+    
+    /**
+     * getters for the range of the ids of the documents which are read,
+     * all of them unless setShard was called. They are known once the
+     * number of documents is read
+     * @return the first and the last id of the range
+     */
+     size_t getFirstDocId() const { return nShards > 1 ? shardId * nDocuments / nShards + 1 : 1; }
+     size_t getLastDocId() const { return nShards > 1 ? (shardId + 1) * nDocuments / nShards : nDocuments; }
+    
+    /**
+     * it makes the documents file be read as one of nShards parts of the
+     * collection, each of consecutive document ids. Only the documents 
+     * whose ids are in the range of the part are counted and kept, the
+     * rest of the file is skipped
+     * @param shardId is the number of the part, smaller than nShards
+     * @param nShards is the number of parts
+     */
+    void setShard(size_t shardId, size_t nShards);
+    
     /**
      * it reads the documents file. Firstly stores the number of documents
-     * to variable nDocuments and then documents' tokens to variable 
-     * documentsTokens according to documents' ids
-     * @param stream is the stream to be read
+     * to variable nDocuments. The rest of the file is split into byte ranges
+     * which start at the line of a document's id, and each range is read in
+     * a single pass by a worker of executor, which hands each normalized 
+     * token to its own partial builder. The partial builders are merged to
+     * builder in the order of the ranges. Only the normalized text of each
+     * document is kept to variable documents, compressed, so that it can be
+     * displayed. The memory mapping is walked in place instead of copying the
+     * file. The tokens are normalized by TokenNormalizer and handed to the
+     * builders as views into the mapping, or into a scratch buffer of the
+     * range when they have to change, so no memory is allocated per token
+     * @param mapping is the mapping to be read
+     * @param builder is the builder which counts the documents' terms
+     * @param executor is the pool of threads which reads the ranges
+     */
+    void readDocumentsFile(const MappedFile& mapping, IndexBuilder& builder, QueryExecutor& executor);
+    
+    /**
+     * it reads the queries file, walking the memory mapping in place. Firstly
+     * stores the number of queries to variable nQueries. Consequently the file
+     * gives two numbers to be read which stored to map nResponses and finally
+     * queries' tokens which are stores to variable queriesTokens according to
+     * queries' ids
+     * @param mapping is the mapping to be read
      */
-    void readDocumentsFile(ifstream& stream);
+    void readQueriesFile(const MappedFile& mapping);
     
     /**
-     * it reads the queries file. Firstly stores the number of queries to 
-     * variable nQueries. Consequently stream gives two numbers to be read
-     * which stored to map nResponses and finally queries' tokens which are
-     * stores to variable queriesTokens according to queries' ids
-     * @param stream is the stream to be read
+     * it reads the queries file from a buffer holding its content, such as 
+     * one received from another process
+     * @param buffer is the content of the queries file
      */
-    void readQueriesFile(ifstream& stream);
+    void readQueries(string_view buffer);
+    
+    /**
+     * it finds the next token separated by white space, like operator >>
+     * of a stream does
+     * @param buffer is the content of the file
+     * @param position is the position to start from, it is moved after the token
+     * @param end is the end of the part of buffer to search in
+     * @param token is set to a view of the token into buffer
+     * @return false if there is no token before end
+     */
+    static bool nextToken(string_view buffer, size_t& position, size_t end, string_view& token);
 private:
-    //input file stream for the documents 
-    ifstream									documentsText;
-    //input file stream for the queries
-    ifstream									queriesText;
+    //memory mapping of the documents file
+    MappedFile								documentsMapping;
+    //memory mapping of the queries file
+    MappedFile								queriesMapping;
+    //which file could not be opened, empty if both were opened
+    string									error;
     //number of documents
-    //TODO: nDocuments and nQueries to be a 
-    //variable map<bool, size_t> nDocs so that 
-    //the bool part to answer the query isQuery
     size_t									nDocuments;
     //number of queries
     size_t									nQueries;
-    //a list for each document containing its 
-    //terms
-    //TODO: replace pointer with a vector
-    list<string>*								documentsTokens;
-    //a list for each query containing its terms
-    //TODO: replace pointer with a vector
-    list<string>*								queriesTokens;
+    //the part of the collection which is read and the
+    //number of parts
+    size_t									shardId;
+    size_t									nShards;
+    //the normalized text of each document, its terms
+    //each followed by a blank, compressed by document id
+    DocumentStore								documents;
+    //the normalized tokens of each query, by query id
+    TokenArena								queriesTokens;
     //key: the query id, value: the number of 
     //responses that will be returned for this 
     //query
     map <size_t, size_t>							nResponses;
     
     /**
-     * it transforms a string to its lower case
-     * @param s the string to be transformed
-     * @return the trasnformed string
+     * it reads the documents file from a buffer holding its content
+     * @param buffer is the content of the documents file
+     * @param builder is the builder which counts the documents' terms
+     * @param executor is the pool of threads which reads the ranges
+     */
+    void readDocuments(string_view buffer, IndexBuilder& builder, QueryExecutor& executor);
+    
+    /**
+     * it reads the documents of a byte range of the documents file
+     * @param buffer is the content of the documents file
+     * @param begin is the start of the range
+     * @param end is the end of the range
+     * @param builder is the partial builder of the range
+     * @param texts is filled with the normalized texts of the range's documents
      */
-     string makeLower(const string& s);
+    void readDocumentsRange(string_view buffer, size_t begin, size_t end, IndexBuilder& builder, TokenArena& texts);
     
     /**
-     * it removes the punctuation from a string 
-     * @param s the string to be checked for punctuation
-     * @param punct the string of punctuation's characters
-     * @return the string without punctuation
+     * it finds the first line at or after position which starts with a
+     * document's id
+     * @param buffer is the content of the documents file
+     * @param position is the position to start searching from
+     * @return the start of the line or the size of buffer if there is none
      */
-     string removePunct(const string& s, const string& punct);
+    static size_t findDocumentStart(string_view buffer, size_t position);
     
     /**
-     * it uses the functions makeLower and removePunct
-     * @param s the string to be transformed
-     * @return a string without punctuation and in a lower case
+     * it parses the digits at the start of a token, like atoi does
+     * @param token is a token starting with a digit
+     * @return the number
      */
-     string lowerRemovedPunct(const string& s);
+    static size_t parseNumber(string_view token);
 };
 
 #endif /* PROCESSFILES_H */
@@ -0,0 +1,77 @@
+/*
+ * The MIT License
+ *
+ * Copyright 2017 Theomeli.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+/* 
+ * File:   QuantizedIndex.cpp
+ * Author: Theomeli
+ * 
+ * Created on October 22, 2026, 3:20 PM
+ */
+
+#include "QuantizedIndex.h"
+#include "Instrumentation.h"
+#include <algorithm>
+#include <cmath>
+
+QuantizedIndex::QuantizedIndex(const InvertedIndex& index, unsigned bits)
+    :bits(bits), nTerms(index.getNTerms()), nDocuments(index.getNDocuments()), offsets(nTerms + 1, 0), 
+    documentFrequencies(nTerms, 0), scales(nTerms, 0) {
+    INSTRUMENT_PHASE(QUANTIZE_INDEX);
+    vector<uint32_t> docIds, levels;
+    vector<double> impacts;
+    for (size_t termId = 0; termId < nTerms; termId++) {
+        offsets[termId] = postings.size();
+        docIds.clear();
+        impacts.clear();
+        for (PostingsCursor cursor = index.getCursor(termId); cursor.getDocId() != PostingsCursor::END; cursor.next()) {
+            double norm = index.getNorm(cursor.getDocId());
+            docIds.push_back(cursor.getDocId());
+            impacts.push_back(norm > 0 ? index.getWeight(termId, cursor.getDocId(), cursor.getFrequency()) / norm : 0);
+            scales[termId] = max(scales[termId], impacts.back());
+        }
+        
+        levels.clear();
+        for (auto const impact : impacts) {
+            uint32_t level = scales[termId] > 0 ? uint32_t(lround(impact / scales[termId] * getLevels())) : 0;
+            if (impact > 0)
+                level = max(level, uint32_t(1));
+            levels.push_back(level + 1);
+        }
+        documentFrequencies[termId] = docIds.size();
+        PostingsCodec::encode(docIds.data(), levels.data(), nullptr, docIds.size(), postings);
+    }
+    offsets[nTerms] = postings.size();
+    postings.shrink_to_fit();
+}
+
+
+QuantizedIndex::~QuantizedIndex() {
+}
+
+
+size_t QuantizedIndex::getMemoryUsage() const {
+    return postings.capacity() + offsets.capacity() * sizeof(uint64_t) + documentFrequencies.capacity() * sizeof(uint32_t) 
+        + scales.capacity() * sizeof(double);
+}
@@ -0,0 +1,128 @@
+/*
+ * The MIT License
+ *
+ * Copyright 2017 Theomeli.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+/* 
+ * File:   QuantizedIndex.h
+ * Author: Theomeli
+ *
+ * Created on October 22, 2026, 3:20 PM
+ */
+
+#ifndef QUANTIZEDINDEX_H
+#define QUANTIZEDINDEX_H
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "InvertedIndex.h"
+
+using namespace std;
+
+/**
+ * the postings lists of an inverted index with the impact of each posting,
+ * the weight of the term in the document divided by the document's norm,
+ * computed when the index is built and quantized to 8 or 16 bits. An impact
+ * is stored as the nearest of getLevels() + 1 steps from 0 to the greatest
+ * impact of its term, at least 1 when it is not 0, so a query scores a
+ * document by adding the products of integers, its terms' quantized weights
+ * and the impacts, with no lookup of the document's norm or frequencies. The
+ * lists are compressed by PostingsCodec with the quantized impact plus one 
+ * in place of the frequency
+ */
+class QuantizedIndex {
+public:
+    //the fewest steps of a query term's weight for which a query is
+    //scored from the impacts. A query of so many terms that its sums of
+    //32 bits leave fewer steps to each weight is scored exactly instead
+    static const uint64_t MIN_QUERY_STEPS = 255;
+    
+    /**
+     * it computes and quantizes the impacts of a finished index
+     * @param index is the index
+     * @param bits is the width of an impact, 8 or 16
+     */
+    QuantizedIndex(const InvertedIndex& index, unsigned bits);
+    QuantizedIndex(const QuantizedIndex& orig) = delete;
+    QuantizedIndex& operator =(const QuantizedIndex& rightSide) = delete;
+    virtual ~QuantizedIndex();
+    
+    /**
+     * getter for private member bits
+     * @return the width of an impact
+     */
+     unsigned getBits() const { return bits; }
+    
+    /**
+     * getter for the greatest quantized impact
+     * @return 2 ^ bits - 1
+     */
+     uint32_t getLevels() const { return (uint32_t(1) << bits) - 1; }
+    
+    /**
+     * getter for private member nDocuments
+     * @return the number of documents of the index
+     */
+     size_t getNDocuments() const { return nDocuments; }
+    
+    /**
+     * getter for the impact which the greatest quantized impact of a term stands for
+     * @param termId is the id of the term
+     * @return the greatest impact of the term
+     */
+     double getScale(size_t termId) const { return scales[termId]; }
+    
+    /**
+     * getter for a cursor over the postings list of a term. The frequency
+     * of a posting less one is its quantized impact
+     * @param termId is the id of the term
+     * @return the cursor on the first posting
+     */
+     PostingsCursor getCursor(size_t termId) const { 
+         return PostingsCursor(postings.data() + offsets[termId], documentFrequencies[termId]); 
+     }
+    
+    /**
+     * it computes the bytes which the index takes
+     * @return the bytes of its storage
+     */
+    size_t getMemoryUsage() const;
+private:
+    //the width of an impact
+    unsigned								bits;
+    //number of terms of the index
+    size_t									nTerms;
+    //number of documents of the index
+    size_t									nDocuments;
+    //the start of each term's list in postings followed
+    //by the end of the last list
+    vector<uint64_t>							offsets;
+    //the length of each term's list
+    vector<uint32_t>							documentFrequencies;
+    //the greatest impact of each term
+    vector<double>								scales;
+    //the compressed postings lists one after the other
+    vector<uint8_t>								postings;
+};
+
+#endif /* QUANTIZEDINDEX_H */
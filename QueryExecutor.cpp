@@ -0,0 +1,124 @@
+/*
+ * The MIT License
+ *
+ * Copyright 2017 Theomeli.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/* 
+ * File:   QueryExecutor.cpp
+ * Author: Theomeli
+ * 
+ * Created on October 17, 2026, 2:15 PM
+ */
+
+#include "QueryExecutor.h"
+
+QueryExecutor::QueryExecutor(size_t nThreads): task(nullptr), generation(0), nBusy(0), isStopping(false) {
+    if (nThreads == 0)
+        nThreads = thread::hardware_concurrency();
+    if (nThreads == 0)
+        nThreads = 1;
+    
+    for (size_t i = 0; i < nThreads; i++)
+        queues.push_back(unique_ptr<WorkQueue>(new WorkQueue));
+    for (size_t i = 0; i < nThreads; i++)
+        workers.push_back(thread(&QueryExecutor::work, this, i));
+}
+
+
+QueryExecutor::~QueryExecutor() {
+    {
+        lock_guard<mutex> guard(lock);
+        isStopping = true;
+    }
+    wakeUp.notify_all();
+    for (auto &worker : workers)
+        worker.join();
+}
+
+
+void QueryExecutor::run(size_t nTasks, const function<void(size_t, size_t)>& task) {
+    //each worker gets a contiguous range of the tasks
+    size_t nThreads = workers.size();
+    for (size_t i = 0; i < nThreads; i++) {
+        lock_guard<mutex> guard(queues[i]->lock);
+        for (size_t taskId = nTasks * i / nThreads; taskId < nTasks * (i + 1) / nThreads; taskId++)
+            queues[i]->tasks.push_back(taskId);
+    }
+    
+    unique_lock<mutex> guard(lock);
+    this->task = &task;
+    nBusy = nThreads;
+    generation++;
+    wakeUp.notify_all();
+    done.wait(guard, [this] { return nBusy == 0; });
+    this->task = nullptr;
+}
+
+
+void QueryExecutor::work(size_t worker) {
+    size_t seen = 0;
+    while (true) {
+        const function<void(size_t, size_t)>* current;
+        {
+            unique_lock<mutex> guard(lock);
+            wakeUp.wait(guard, [this, seen] { return isStopping || generation != seen; });
+            if (isStopping)
+                return;
+            seen = generation;
+            current = task;
+        }
+        
+        size_t taskId;
+        while (nextTask(worker, taskId))
+            (*current)(taskId, worker);
+        
+        lock_guard<mutex> guard(lock);
+        if (--nBusy == 0)
+            done.notify_one();
+    }
+}
+
+
+bool QueryExecutor::nextTask(size_t worker, size_t& taskId) {
+    {
+        lock_guard<mutex> guard(queues[worker]->lock);
+        if (!queues[worker]->tasks.empty()) {
+            taskId = queues[worker]->tasks.front();
+            queues[worker]->tasks.pop_front();
+            return true;
+        }
+    }
+    
+    //steal from the back of the other workers' queues
+    size_t nThreads = queues.size();
+    for (size_t i = 1; i < nThreads; i++) {
+        WorkQueue& victim = *queues[(worker + i) % nThreads];
+        lock_guard<mutex> guard(victim.lock);
+        if (!victim.tasks.empty()) {
+            taskId = victim.tasks.back();
+            victim.tasks.pop_back();
+            return true;
+        }
+    }
+    
+    return false;
+}
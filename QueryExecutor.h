@@ -0,0 +1,112 @@
+/*
+ * The MIT License
+ *
+ * Copyright 2017 Theomeli.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/* 
+ * File:   QueryExecutor.h
+ * Author: Theomeli
+ *
+ * Created on October 17, 2026, 2:15 PM
+ */
+
+#ifndef QUERYEXECUTOR_H
+#define QUERYEXECUTOR_H
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+using namespace std;
+
+class QueryExecutor {
+public:
+    QueryExecutor(size_t nThreads = 0);
+    QueryExecutor(const QueryExecutor& orig) = delete;
+    QueryExecutor& operator =(const QueryExecutor& rightSide) = delete;
+    virtual ~QueryExecutor();
+    
+    /**
+     * getter for the number of workers of the pool
+     * @return the number of threads
+     */
+     size_t getNThreads() const { return workers.size(); }
+    
+    /**
+     * it runs the tasks 0, ..., nTasks - 1 on the workers and returns when
+     * all of them are done. Each worker starts with a contiguous range of 
+     * tasks and steals from the others when its own range is exhausted
+     * @param nTasks is the number of tasks
+     * @param task is called with the task's id and the worker's id, which
+     * is smaller than getNThreads() and may index per thread scratch buffers
+     */
+    void run(size_t nTasks, const function<void(size_t, size_t)>& task);
+private:
+    //the tasks of a worker. The owner takes them from 
+    //the front, thieves from the back
+    struct WorkQueue {
+        mutex								lock;
+        deque<size_t>							tasks;
+    };
+    
+    //the threads of the pool
+    vector<thread>								workers;
+    //a queue of tasks for each worker
+    vector<unique_ptr<WorkQueue>>						queues;
+    //it protects the members below
+    mutex									lock;
+    //it wakes the workers when a batch starts or the
+    //pool stops
+    condition_variable							wakeUp;
+    //it wakes run when the batch is done
+    condition_variable							done;
+    //the task of the current batch
+    const function<void(size_t, size_t)>*					task;
+    //it is increased for every batch so that workers
+    //know a new batch has started
+    size_t									generation;
+    //the number of workers still busy with the batch
+    size_t									nBusy;
+    //true when the pool is destroyed
+    bool									isStopping;
+    
+    /**
+     * the loop of a worker thread
+     * @param worker is the id of the worker
+     */
+    void work(size_t worker);
+    
+    /**
+     * it takes a task from the worker's queue or steals one from another
+     * @param worker is the id of the worker
+     * @param taskId is set to the id of the task taken
+     * @return false when no task is left
+     */
+    bool nextTask(size_t worker, size_t& taskId);
+};
+
+#endif /* QUERYEXECUTOR_H */
+
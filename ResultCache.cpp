@@ -0,0 +1,139 @@
+/*
+ * The MIT License
+ *
+ * Copyright 2017 Theomeli.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/* 
+ * File:   ResultCache.cpp
+ * Author: Theomeli
+ * 
+ * Created on October 17, 2026, 4:05 PM
+ */
+
+#include "ResultCache.h"
+#include <algorithm>
+#include <functional>
+
+//the bytes which the nodes of the list and of the map take
+//besides the entry and its key
+static const size_t NODE_SIZE = 64;
+
+ResultCache::ResultCache(size_t capacity)
+    :capacity(capacity), generation(0), hits(0), misses(0), evictions(0), invalidations(0) {
+}
+
+
+ResultCache::~ResultCache() {
+}
+
+
+size_t ResultCache::getSize() const {
+    size_t size = 0;
+    for (auto &shard : shards) {
+        lock_guard<mutex> guard(shard.lock);
+        size += shard.size;
+    }
+    
+    return size;
+}
+
+
+string ResultCache::makeKey(vector<string> terms) {
+    sort(terms.begin(), terms.end());
+    string key;
+    //the terms hold no blanks, so a blank separates them
+    for (auto const &term : terms) {
+        key += term;
+        key += ' ';
+    }
+    
+    return key;
+}
+
+
+ResultCache::Shard& ResultCache::getShard(const string& key) {
+    return shards[hash<string>()(key) % N_SHARDS];
+}
+
+
+void ResultCache::erase(Shard& shard, list<Entry>::iterator position) {
+    shard.size -= position->size;
+    shard.positions.erase(position->key);
+    shard.entries.erase(position);
+}
+
+
+bool ResultCache::find(const string& key, size_t k, vector<pair<size_t, double>>& results) {
+    Shard& shard = getShard(key);
+    {
+        lock_guard<mutex> guard(shard.lock);
+        unordered_map<string, list<Entry>::iterator>::iterator found = shard.positions.find(key);
+        if (found != shard.positions.end()) {
+            list<Entry>::iterator position = found->second;
+            if (position->generation != generation)
+                erase(shard, position);
+            else if (position->k >= k) {
+                shard.entries.splice(shard.entries.begin(), shard.entries, position);
+                results.assign(position->results.begin(), position->results.begin() + min(k, position->results.size()));
+                hits++;
+                return true;
+            }
+        }
+    }
+    misses++;
+    
+    return false;
+}
+
+
+void ResultCache::insert(const string& key, size_t k, const vector<pair<size_t, double>>& results, uint64_t generation) {
+    size_t size = sizeof(Entry) + 2 * key.size() + results.size() * sizeof(pair<size_t, double>) + NODE_SIZE;
+    size_t shardCapacity = capacity / N_SHARDS;
+    if (generation != this->generation || size > shardCapacity)
+        return;
+    
+    Shard& shard = getShard(key);
+    lock_guard<mutex> guard(shard.lock);
+    unordered_map<string, list<Entry>::iterator>::iterator found = shard.positions.find(key);
+    if (found != shard.positions.end()) {
+        if (found->second->generation == generation && found->second->k >= k)
+            return;
+        erase(shard, found->second);
+    }
+    while (shard.size + size > shardCapacity) {
+        //stale entries are dropped without being counted as evicted
+        if (shard.entries.back().generation == generation)
+            evictions++;
+        erase(shard, prev(shard.entries.end()));
+    }
+    Entry entry = { key, k, results, generation, size };
+    shard.entries.push_front(move(entry));
+    shard.positions[key] = shard.entries.begin();
+    shard.size += size;
+}
+
+
+void ResultCache::invalidate() {
+    generation++;
+    invalidations++;
+}
+
@@ -0,0 +1,192 @@
+/*
+ * The MIT License
+ *
+ * Copyright 2017 Theomeli.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/* 
+ * File:   ResultCache.h
+ * Author: Theomeli
+ *
+ * Created on October 17, 2026, 4:05 PM
+ */
+
+#ifndef RESULTCACHE_H
+#define RESULTCACHE_H
+#include <cstddef>
+#include <cstdint>
+#include <atomic>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+/**
+ * a bounded cache of the results of queries, keyed on the query's normalized
+ * terms, sorted so that the order they were given in does not matter. An
+ * entry computed for k documents answers any query of the same terms asking
+ * for no more than k, since the results are ordered by cosine and then by
+ * document id and the first of them do not depend on k. The least recently
+ * used entries are evicted once the entries take more bytes than the
+ * capacity. It may be used by many threads at once: the entries are split
+ * among shards by the hash of their key, each with its own lock
+ */
+class ResultCache {
+public:
+    //the default capacity in bytes
+    static const size_t DEFAULT_CAPACITY = 64 << 20;
+    
+    ResultCache(size_t capacity = DEFAULT_CAPACITY);
+    ResultCache(const ResultCache& orig) = delete;
+    ResultCache& operator =(const ResultCache& rightSide) = delete;
+    virtual ~ResultCache();
+    
+    /**
+     * getter for private member capacity
+     * @return the greatest number of bytes the entries may take
+     */
+     size_t getCapacity() const { return capacity; }
+    
+    /**
+     * setter for private member capacity. When it is decreased, the entries
+     * beyond it are evicted as new ones are inserted
+     * @param capacity is the greatest number of bytes the entries may take,
+     * 0 to keep no entries
+     */
+     void setCapacity(size_t capacity) { this->capacity = capacity; }
+    
+    /**
+     * getters for the counters of the cache, since it was created
+     */
+     size_t getHits() const { return hits; }
+     size_t getMisses() const { return misses; }
+     size_t getEvictions() const { return evictions; }
+     size_t getInvalidations() const { return invalidations; }
+    
+    /**
+     * getter for private member generation. A caller takes it before it 
+     * computes the results it will insert, so that results computed on an
+     * index which changed meanwhile are never returned
+     * @return the generation of the index the cache holds results of
+     */
+     uint64_t getGeneration() const { return generation; }
+    
+    /**
+     * it sums the bytes taken by the entries of all the shards
+     * @return the size of the cache in bytes
+     */
+    size_t getSize() const;
+    
+    /**
+     * it makes the key of a query from its normalized terms, sorting
+     * them, so that the queries of the same terms in any order share it
+     * @param terms are the query's terms, repeated as often as they appear
+     * @return the key
+     */
+    static string makeKey(vector<string> terms);
+    
+    /**
+     * it looks for the results of a query and, if they are found, makes
+     * their entry the most recently used one
+     * @param key is the key of the query
+     * @param k is the number of documents asked for
+     * @param results is set to the first k results of the entry when it is found
+     * @return true on a hit
+     */
+    bool find(const string& key, size_t k, vector<pair<size_t, double>>& results);
+    
+    /**
+     * it keeps the results of a query, unless an entry of at least as many
+     * documents is kept already, evicting the least recently used entries
+     * of its shard to make room for them
+     * @param key is the key of the query
+     * @param k is the number of documents the results were computed for
+     * @param results are the results
+     * @param generation is the value of getGeneration() taken before the
+     * results were computed
+     */
+    void insert(const string& key, size_t k, const vector<pair<size_t, double>>& results, uint64_t generation);
+    
+    /**
+     * it drops all the entries, once the index has changed. The entries are
+     * dropped lazily, when they are found or evicted
+     */
+    void invalidate();
+private:
+    //the number of shards
+    static const size_t N_SHARDS = 16;
+    
+    //the results of a query
+    struct Entry {
+        string								key;
+        //the number of documents they were computed for
+        size_t								k;
+        vector<pair<size_t, double>>					results;
+        //the generation of the index they were computed on
+        uint64_t							generation;
+        //the bytes taken by the entry
+        size_t								size;
+    };
+    
+    //a part of the entries with its own lock
+    struct Shard {
+        mutable mutex							lock;
+        //the entries from the most to the least recently used
+        list<Entry>							entries;
+        //the entries by key
+        unordered_map<string, list<Entry>::iterator>			positions;
+        //the bytes taken by the entries
+        size_t								size = 0;
+    };
+    
+    //the greatest number of bytes the entries may take
+    atomic<size_t>								capacity;
+    //the shards of the entries
+    Shard									shards[N_SHARDS];
+    //it is increased whenever the index changes
+    atomic<uint64_t>							generation;
+    //the counters of the cache
+    atomic<size_t>								hits;
+    atomic<size_t>								misses;
+    atomic<size_t>								evictions;
+    atomic<size_t>								invalidations;
+    
+    /**
+     * it finds the shard which holds a key
+     * @param key is the key
+     * @return the shard
+     */
+    Shard& getShard(const string& key);
+    
+    /**
+     * it drops an entry from its shard, whose lock must be held
+     * @param shard is the shard
+     * @param position is the entry
+     */
+    static void erase(Shard& shard, list<Entry>::iterator position);
+};
+
+#endif /* RESULTCACHE_H */
+
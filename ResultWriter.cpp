@@ -0,0 +1,189 @@
+/*
+ * The MIT License
+ *
+ * Copyright 2017 Theomeli.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+/* 
+ * File:   ResultWriter.cpp
+ * Author: Theomeli
+ * 
+ * Created on October 21, 2026, 10:40 AM
+ */
+
+#include "ResultWriter.h"
+#include <cstdio>
+
+ResultWriter::ResultWriter(ostream& out, Format format): out(out), format(format), queryId(0), rank(0) {
+    buffer.reserve(BUFFER_SIZE + BUFFER_SIZE / 4);
+    if (format == TSV)
+        buffer += "query\trank\tdocument\tweight\n";
+    else if (format == BINARY)
+        buffer += "TREBIN01";
+}
+
+
+ResultWriter::~ResultWriter() {
+    flush();
+}
+
+
+bool ResultWriter::parseFormat(const string& name, Format& format) {
+    const char* names[] = { "text", "tsv", "jsonl", "binary" };
+    for (int i = TEXT; i <= BINARY; i++)
+        if (name == names[i]) {
+            format = Format(i);
+            return true;
+        }
+    
+    return false;
+}
+
+
+void ResultWriter::beginQuery(size_t queryId, const TokenArena::Tokens& terms, size_t nResults) {
+    this->queryId = queryId;
+    rank = 0;
+    switch (format) {
+    case TEXT:
+        buffer += "Query to search: \n";
+        for (auto const term : terms) {
+            buffer += term;
+            buffer += ' ';
+        }
+        buffer += "\n===================\nReturned documents:\n===================\n";
+        break;
+    case JSONL: {
+        buffer += "{\"query\":";
+        appendNumber(queryId);
+        buffer += ",\"terms\":[";
+        bool isFirst = true;
+        for (auto const term : terms) {
+            if (!isFirst)
+                buffer += ',';
+            appendJson(term);
+            isFirst = false;
+        }
+        buffer += "],\"results\":[";
+        break;
+    }
+    case BINARY:
+        appendBytes(uint32_t(queryId));
+        appendBytes(uint32_t(nResults));
+        break;
+    default:
+        break;
+    }
+}
+
+
+void ResultWriter::addResult(size_t docId, string_view document, double weight) {
+    rank++;
+    switch (format) {
+    case TEXT: {
+        //the weight ends at the 70th column, unless the document is longer
+        const size_t width = 70, labelSize = sizeof("(with weight ") - 1;
+        buffer += document;
+        if (document.size() + labelSize < width)
+            buffer.append(width - labelSize - document.size(), ' ');
+        buffer += "(with weight ";
+        appendWeight(weight);
+        buffer += ")\n";
+        break;
+    }
+    case TSV:
+        appendNumber(queryId);
+        buffer += '\t';
+        appendNumber(rank);
+        buffer += '\t';
+        appendNumber(docId);
+        buffer += '\t';
+        appendWeight(weight);
+        buffer += '\n';
+        break;
+    case JSONL:
+        if (rank > 1)
+            buffer += ',';
+        buffer += "{\"document\":";
+        appendNumber(docId);
+        buffer += ",\"weight\":";
+        appendWeight(weight);
+        buffer += '}';
+        break;
+    case BINARY:
+        appendBytes(uint32_t(docId));
+        appendBytes(weight);
+        break;
+    }
+    if (buffer.size() >= BUFFER_SIZE)
+        flush();
+}
+
+
+void ResultWriter::endQuery() {
+    if (format == TEXT)
+        buffer += '\n';
+    else if (format == JSONL)
+        buffer += "]}\n";
+    if (buffer.size() >= BUFFER_SIZE)
+        flush();
+}
+
+
+bool ResultWriter::flush() {
+    out.write(buffer.data(), buffer.size());
+    buffer.clear();
+    out.flush();
+    
+    return bool(out);
+}
+
+
+void ResultWriter::appendNumber(size_t value) {
+    char digits[24];
+    buffer.append(digits, snprintf(digits, sizeof(digits), "%zu", value));
+}
+
+
+void ResultWriter::appendWeight(double weight) {
+    //the text has the default precision of a stream, the other
+    //formats enough digits to read the same double back
+    char digits[32];
+    buffer.append(digits, snprintf(digits, sizeof(digits), format == TEXT ? "%g" : "%.17g", weight));
+}
+
+
+void ResultWriter::appendJson(string_view s) {
+    buffer += '"';
+    for (auto const c : s) {
+        if (c == '"' || c == '\\') {
+            buffer += '\\';
+            buffer += c;
+        }
+        else if ((unsigned char)c < 0x20) {
+            char escaped[8];
+            buffer.append(escaped, snprintf(escaped, sizeof(escaped), "\\u%04x", c));
+        }
+        else
+            buffer += c;
+    }
+    buffer += '"';
+}
@@ -0,0 +1,158 @@
+/*
+ * The MIT License
+ *
+ * Copyright 2017 Theomeli.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+/* 
+ * File:   ResultWriter.h
+ * Author: Theomeli
+ *
+ * Created on October 21, 2026, 10:40 AM
+ */
+
+#ifndef RESULTWRITER_H
+#define RESULTWRITER_H
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include "TokenArena.h"
+
+using namespace std;
+
+/**
+ * a sink of the queries' results, which formats them to a buffer that is
+ * written to its stream in bulk, each time it fills, and reused. The text
+ * format is the display of the engine; tsv gives a line of query id, rank,
+ * document id and weight for each returned document, with a header line;
+ * jsonl gives a JSON object for each query, with its terms and its documents;
+ * binary gives the 8 bytes "TREBIN01" and, for each query, its id and the 
+ * number of its documents as 32 bit integers followed by each document's id
+ * as a 32 bit integer and weight as a 64 bit double, in the byte order of
+ * the machine. Weights are written exactly, except by text. It is used by one
+ * thread at a time
+ */
+class ResultWriter {
+public:
+    enum Format { TEXT, TSV, JSONL, BINARY };
+    
+    //the bytes kept before they are written to the stream
+    static const size_t BUFFER_SIZE = 1 << 20;
+    
+    /**
+     * @param out is the stream the results are written to. It must
+     * outlive the writer and be opened in binary mode for binary
+     * @param format is the format of the results
+     */
+    ResultWriter(ostream& out, Format format = TEXT);
+    ResultWriter(const ResultWriter& orig) = delete;
+    ResultWriter& operator =(const ResultWriter& rightSide) = delete;
+    virtual ~ResultWriter();
+    
+    /**
+     * getter for private member format
+     * @return the format of the results
+     */
+     Format getFormat() const { return format; }
+    
+    /**
+     * it tells if the text of the returned documents is written
+     * @return true if addResult needs the documents' text
+     */
+     bool hasDocuments() const { return format == TEXT; }
+    
+    /**
+     * it finds the format of a name
+     * @param name is one of text, tsv, jsonl and binary
+     * @param format is set to the format of the name
+     * @return false if the name is not of a format
+     */
+    static bool parseFormat(const string& name, Format& format);
+    
+    /**
+     * it starts the results of a query
+     * @param queryId is the id of the query
+     * @param terms are the query's normalized terms
+     * @param nResults is the number of documents which will be added
+     */
+    void beginQuery(size_t queryId, const TokenArena::Tokens& terms, size_t nResults);
+    
+    /**
+     * it adds a returned document to the results of the current query
+     * @param docId is the id of the document
+     * @param document is the text of the document, if hasDocuments()
+     * @param weight is the cosine of the document to the query
+     */
+    void addResult(size_t docId, string_view document, double weight);
+    
+    /**
+     * it ends the results of the current query, writing the buffer
+     * to the stream if it is full
+     */
+    void endQuery();
+    
+    /**
+     * it writes the buffer to the stream and flushes the stream
+     * @return false if the stream failed
+     */
+    bool flush();
+private:
+    //the stream the results are written to
+    ostream&								out;
+    //the format of the results
+    Format								format;
+    //the formatted results not written yet
+    string								buffer;
+    //the id of the current query
+    size_t								queryId;
+    //the number of documents added to the current query
+    size_t								rank;
+    
+    /**
+     * it appends a number to the buffer
+     * @param value is the number
+     */
+    void appendNumber(size_t value);
+    
+    /**
+     * it appends a weight to the buffer, with the precision of the format
+     * @param weight is the weight
+     */
+    void appendWeight(double weight);
+    
+    /**
+     * it appends the bytes of a value to the buffer
+     * @param value is the value
+     */
+    template<class T>
+    void appendBytes(T value) { buffer.append(reinterpret_cast<const char*>(&value), sizeof(value)); }
+    
+    /**
+     * it appends a string to the buffer as a JSON string
+     * @param s is the string
+     */
+    void appendJson(string_view s);
+};
+
+#endif /* RESULTWRITER_H */
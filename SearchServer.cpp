@@ -0,0 +1,316 @@
+/*
+ * The MIT License
+ *
+ * Copyright 2017 Theomeli.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+/* 
+ * File:   SearchServer.cpp
+ * Author: Theomeli
+ * 
+ * Created on October 24, 2026, 10:20 AM
+ */
+
+#include "SearchServer.h"
+#include <cerrno>
+#include <cstring>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+SearchServer::SearchServer(const TextRetrievalEngine& engine, QueryExecutor& executor)
+    :engine(engine), executor(executor), listener(-1), epoll(-1), wakeup(-1), nextId(WAKEUP_ID + 1), nRequests(0) {
+}
+
+
+SearchServer::~SearchServer() {
+    while (!connections.empty())
+        closeConnection(connections.begin()->first);
+    if (listener >= 0) {
+        close(listener);
+        unlink(socketPath.c_str());
+    }
+    if (epoll >= 0)
+        close(epoll);
+    if (wakeup >= 0)
+        close(wakeup);
+}
+
+
+bool SearchServer::listen(const string& socketPath) {
+    sockaddr_un address;
+    if (socketPath.size() >= sizeof(address.sun_path))
+        return false;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    memcpy(address.sun_path, socketPath.c_str(), socketPath.size());
+    
+    epoll = epoll_create1(EPOLL_CLOEXEC);
+    wakeup = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    listener = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (epoll < 0 || wakeup < 0 || listener < 0)
+        return false;
+    unlink(socketPath.c_str());
+    if (bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || ::listen(listener, SOMAXCONN) != 0)
+        return false;
+    this->socketPath = socketPath;
+    
+    epoll_event event;
+    event.events = EPOLLIN;
+    event.data.u64 = LISTENER_ID;
+    if (epoll_ctl(epoll, EPOLL_CTL_ADD, listener, &event) != 0)
+        return false;
+    event.data.u64 = WAKEUP_ID;
+    
+    return epoll_ctl(epoll, EPOLL_CTL_ADD, wakeup, &event) == 0;
+}
+
+
+void SearchServer::stop() {
+    uint64_t one = 1;
+    //only async signal safe calls, for a signal handler
+    if (write(wakeup, &one, sizeof(one)) < 0)
+        return;
+}
+
+
+void SearchServer::acceptConnections() {
+    while (true) {
+        int fd = accept4(listener, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED)
+                continue;
+            return;
+        }
+        uint64_t id = nextId++;
+        epoll_event event;
+        event.events = EPOLLIN | EPOLLRDHUP;
+        event.data.u64 = id;
+        if (epoll_ctl(epoll, EPOLL_CTL_ADD, fd, &event) != 0) {
+            close(fd);
+            continue;
+        }
+        connections[id] = { fd, string(), string(), 0, false, false, event.events };
+    }
+}
+
+
+bool SearchServer::readInput(uint64_t id) {
+    Connection& connection = connections[id];
+    char buffer[1 << 16];
+    //the bytes beyond the bound wait in the socket
+    while (!connection.isEnded && connection.input.size() < MAX_PENDING_INPUT) {
+        ssize_t nRead = recv(connection.fd, buffer, sizeof(buffer), 0);
+        if (nRead < 0 && errno == EINTR)
+            continue;
+        if (nRead < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            break;
+        if (nRead < 0)
+            return false;
+        if (nRead == 0)
+            connection.isEnded = true;
+        connection.input.append(buffer, nRead);
+        connection.isBacklogged = true;
+    }
+    
+    return watch(id);
+}
+
+
+bool SearchServer::parseRequests(uint64_t id, vector<Request>& requests) {
+    Connection& connection = connections[id];
+    //the complete requests are parsed, a partial one is kept for the next round
+    size_t position = 0, nParsed = 0;
+    connection.isBacklogged = false;
+    Message message;
+    while (true) {
+        string_view rest = string_view(connection.input).substr(position);
+        uint64_t size = 0;
+        bool isComplete = Message::isComplete(rest, size);
+        if (size > MAX_REQUEST_SIZE)
+            return false;
+        if (!isComplete)
+            break;
+        if (nParsed == MAX_ROUND_REQUESTS || connection.output.size() - connection.written > MAX_PENDING_OUTPUT) {
+            connection.isBacklogged = true;
+            break;
+        }
+        message.setBytes(rest.substr(Message::HEADER_SIZE, size));
+        position += Message::HEADER_SIZE + size;
+        Request request;
+        request.connectionId = id;
+        request.nResponses = message.getNumber();
+        request.text = string(message.getString());
+        if (!message.isValid())
+            return false;
+        requests.push_back(move(request));
+        nParsed++;
+    }
+    connection.input.erase(0, position);
+    
+    return watch(id);
+}
+
+
+bool SearchServer::isReady(const Connection& connection) {
+    return connection.isBacklogged && connection.output.size() - connection.written <= MAX_PENDING_OUTPUT;
+}
+
+
+bool SearchServer::writeResponses(uint64_t id) {
+    Connection& connection = connections[id];
+    while (connection.written < connection.output.size()) {
+        //a closed client fails the call instead of raising SIGPIPE
+        ssize_t written = send(connection.fd, connection.output.data() + connection.written, 
+            connection.output.size() - connection.written, MSG_NOSIGNAL);
+        if (written < 0 && errno == EINTR)
+            continue;
+        if (written < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            break;
+        if (written < 0)
+            return false;
+        connection.written += written;
+    }
+    if (connection.written == connection.output.size()) {
+        connection.output.clear();
+        connection.written = 0;
+    }
+    
+    return watch(id);
+}
+
+
+bool SearchServer::watch(uint64_t id) {
+    Connection& connection = connections[id];
+    //an ended client would be reported readable on every round, and one
+    //beyond its bounds is left to the socket's buffers until it takes its
+    //responses or its requests are parsed
+    bool isRead = !connection.isEnded && connection.input.size() < MAX_PENDING_INPUT 
+        && connection.output.size() - connection.written <= MAX_PENDING_OUTPUT;
+    uint32_t events = (isRead ? uint32_t(EPOLLIN) | uint32_t(EPOLLRDHUP) : 0) | (connection.output.empty() ? 0 : uint32_t(EPOLLOUT));
+    if (events == connection.events)
+        return true;
+    epoll_event event;
+    event.events = events;
+    event.data.u64 = id;
+    connection.events = events;
+    
+    return epoll_ctl(epoll, EPOLL_CTL_MOD, connection.fd, &event) == 0;
+}
+
+
+void SearchServer::closeConnection(uint64_t id) {
+    unordered_map<uint64_t, Connection>::iterator found = connections.find(id);
+    if (found == connections.end())
+        return;
+    epoll_ctl(epoll, EPOLL_CTL_DEL, found->second.fd, nullptr);
+    close(found->second.fd);
+    connections.erase(found);
+}
+
+
+bool SearchServer::run() {
+    const int maxEvents = 64;
+    epoll_event events[maxEvents];
+    vector<Request> requests;
+    vector<vector<pair<size_t, double>>> results;
+    bool isStopped = false;
+    while (!isStopped) {
+        //the requests left by the last rounds are not waited for
+        int timeout = -1;
+        for (auto const &ent1 : connections)
+            if (isReady(ent1.second))
+                timeout = 0;
+        int nEvents = epoll_wait(epoll, events, maxEvents, timeout);
+        if (nEvents < 0 && errno == EINTR)
+            continue;
+        if (nEvents < 0)
+            return false;
+        
+        requests.clear();
+        for (int i = 0; i < nEvents; i++) {
+            uint64_t id = events[i].data.u64;
+            if (id == LISTENER_ID)
+                acceptConnections();
+            else if (id == WAKEUP_ID)
+                isStopped = true;
+            else if (connections.count(id) > 0) {
+                bool isFailed = (events[i].events & EPOLLERR) != 0;
+                if (!isFailed && (events[i].events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP)))
+                    isFailed = !readInput(id);
+                if (!isFailed && (events[i].events & EPOLLOUT))
+                    isFailed = !writeResponses(id);
+                if (isFailed)
+                    closeConnection(id);
+            }
+        }
+        //the requests are taken from the connections read in this round
+        //and the ones left by the last rounds
+        vector<uint64_t> backlogged;
+        for (auto const &ent1 : connections)
+            if (isReady(ent1.second))
+                backlogged.push_back(ent1.first);
+        sort(backlogged.begin(), backlogged.end());
+        for (auto const id : backlogged)
+            if (!parseRequests(id, requests))
+                closeConnection(id);
+        
+        //the requests of the round are evaluated together, then their
+        //responses are queued in the order of the requests
+        results.assign(requests.size(), vector<pair<size_t, double>>());
+        executor.run(requests.size(), [&](size_t task, size_t /*worker*/) {
+            results[task] = engine.search(requests[task].text, requests[task].nResponses);
+        });
+        nRequests += requests.size();
+        vector<uint64_t> touched;
+        Message response;
+        for (size_t i = 0; i < requests.size(); i++) {
+            unordered_map<uint64_t, Connection>::iterator found = connections.find(requests[i].connectionId);
+            if (found == connections.end())
+                continue;
+            response = Message();
+            response.putNumber(results[i].size());
+            for (auto const &ent1 : results[i]) {
+                response.putNumber(ent1.first);
+                response.putDouble(ent1.second);
+            }
+            response.appendTo(found->second.output);
+            if (touched.empty() || touched.back() != requests[i].connectionId)
+                touched.push_back(requests[i].connectionId);
+        }
+        for (auto const id : touched)
+            if (connections.count(id) > 0 && !writeResponses(id))
+                closeConnection(id);
+        
+        //a client which sent its last request is closed once it has all its responses
+        vector<uint64_t> ended;
+        for (auto const &ent1 : connections)
+            if (ent1.second.isEnded && ent1.second.output.empty() && !ent1.second.isBacklogged)
+                ended.push_back(ent1.first);
+        for (auto const id : ended)
+            closeConnection(id);
+    }
+    
+    return true;
+}
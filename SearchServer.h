@@ -0,0 +1,205 @@
+/*
+ * The MIT License
+ *
+ * Copyright 2017 Theomeli.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+/* 
+ * File:   SearchServer.h
+ * Author: Theomeli
+ *
+ * Created on October 24, 2026, 10:20 AM
+ */
+
+#ifndef SEARCHSERVER_H
+#define SEARCHSERVER_H
+#include "Message.h"
+#include "TextRetrievalEngine.h"
+#include <unordered_map>
+
+using namespace std;
+
+/**
+ * a server of the queries of a resident engine over a Unix domain socket. A
+ * request is a Message holding the number of documents to be returned and the
+ * text of the query; its response is a Message holding the number of documents
+ * returned and, for each of them, its id and its cosine, as search returns them.
+ * A client may send many requests without waiting for their responses, which
+ * come back in the order of the requests. The connections are served by an epoll
+ * event loop on one thread: the requests read in a round of the loop are
+ * evaluated together by the workers of an executor and their responses are
+ * written as soon as the sockets take them. A connection is not read while its
+ * unparsed bytes or its unwritten responses are beyond their bounds, and the
+ * requests it sent beyond MAX_ROUND_REQUESTS wait for the next rounds
+ */
+class SearchServer {
+public:
+    //the greatest size of a request, beyond which its connection is closed
+    static const size_t MAX_REQUEST_SIZE = 1 << 20;
+    //the bytes of a connection read and not parsed, and the bytes of its
+    //responses not written, beyond which its socket is not read, so that
+    //a client which does not take its responses is not buffered without end
+    static const size_t MAX_PENDING_INPUT = 2 * MAX_REQUEST_SIZE + 16;
+    static const size_t MAX_PENDING_OUTPUT = 1 << 22;
+    //the most requests of a connection evaluated in a round of the loop,
+    //so that one fast client does not hold the others
+    static const size_t MAX_ROUND_REQUESTS = 64;
+    
+    /**
+     * @param engine is the engine which evaluates the queries, ready for search.
+     * It must not change while the server runs
+     * @param executor is the pool of threads which evaluates the requests
+     */
+    SearchServer(const TextRetrievalEngine& engine, QueryExecutor& executor);
+    SearchServer(const SearchServer& orig) = delete;
+    SearchServer& operator =(const SearchServer& rightSide) = delete;
+    virtual ~SearchServer();
+    
+    /**
+     * getter for private member nRequests
+     * @return the number of requests answered
+     */
+     size_t getNRequests() const { return nRequests; }
+    
+    /**
+     * it binds the server to a socket path, replacing a socket left there
+     * by an earlier server, and starts listening
+     * @param socketPath is the path of the socket
+     * @return false if the socket could not be made
+     */
+    bool listen(const string& socketPath);
+    
+    /**
+     * it serves the connections until stop is called
+     * @return false if the event loop failed
+     */
+    bool run();
+    
+    /**
+     * it makes run return after its current round. It may be called by
+     * another thread or by a signal handler
+     */
+    void stop();
+private:
+    //a connection of a client
+    struct Connection {
+        //the descriptor of the socket
+        int								fd;
+        //the bytes read and not yet parsed to requests
+        string								input;
+        //the responses not yet written and the bytes of
+        //them which are
+        string								output;
+        size_t								written;
+        //true if the client will send no more requests
+        bool								isEnded;
+        //true if input may hold complete requests not yet parsed
+        bool								isBacklogged;
+        //the events the socket is watched for
+        uint32_t							events;
+    };
+    //a request read from a connection
+    struct Request {
+        //the id of the connection
+        uint64_t							connectionId;
+        //the number of documents to be returned
+        size_t								nResponses;
+        //the text of the query
+        string								text;
+    };
+    
+    //the ids of the events of the listening socket and of stop
+    static const uint64_t LISTENER_ID = 0;
+    static const uint64_t WAKEUP_ID = 1;
+    
+    //the engine which evaluates the queries
+    const TextRetrievalEngine&						engine;
+    //the pool of threads which evaluates the requests
+    QueryExecutor&								executor;
+    //the path of the socket
+    string									socketPath;
+    //the descriptors of the listening socket, of the
+    //epoll instance and of the eventfd which stop writes
+    int									listener;
+    int									epoll;
+    int									wakeup;
+    //the open connections by id, the ids taken in order
+    unordered_map<uint64_t, Connection>					connections;
+    uint64_t								nextId;
+    //the number of requests answered
+    size_t									nRequests;
+    
+    /**
+     * it accepts the connections waiting on the listening socket
+     */
+    void acceptConnections();
+    
+    /**
+     * it reads the bytes waiting on a connection, up to MAX_PENDING_INPUT
+     * unparsed bytes
+     * @param id is the id of the connection
+     * @return false if the connection failed
+     */
+    bool readInput(uint64_t id);
+    
+    /**
+     * it parses the complete requests of a connection's input, at most
+     * MAX_ROUND_REQUESTS and none while its responses are beyond
+     * MAX_PENDING_OUTPUT, the others being left for the next rounds
+     * @param id is the id of the connection
+     * @param requests are appended the requests parsed
+     * @return false if the connection sent a bad request
+     */
+    bool parseRequests(uint64_t id, vector<Request>& requests);
+    
+    /**
+     * it checks if a connection has requests left to parse which may be
+     * parsed now, so that the loop does not wait for its socket
+     * @param connection is the connection
+     * @return true if it is backlogged and its responses are within bounds
+     */
+    static bool isReady(const Connection& connection);
+    
+    /**
+     * it writes the responses of a connection while its socket takes them
+     * @param id is the id of the connection
+     * @return false if the connection failed
+     */
+    bool writeResponses(uint64_t id);
+    
+    /**
+     * it watches a connection for reading until its client ends, while its
+     * pending input and output are within bounds, and for writing while its
+     * responses wait for the socket
+     * @param id is the id of the connection
+     * @return false if the socket could not be watched
+     */
+    bool watch(uint64_t id);
+    
+    /**
+     * it closes a connection
+     * @param id is the id of the connection
+     */
+    void closeConnection(uint64_t id);
+};
+
+#endif /* SEARCHSERVER_H */
@@ -0,0 +1,362 @@
+/*
+ * The MIT License
+ *
+ * Copyright 2017 Theomeli.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/* 
+ * File:   SegmentedIndex.cpp
+ * Author: Theomeli
+ * 
+ * Created on October 17, 2026, 6:20 PM
+ */
+
+#include "SegmentedIndex.h"
+#include <algorithm>
+#include <cmath>
+
+/**
+ * it orders the postings of a segment by term id and document id
+ */
+static bool isBefore(const SegmentPosting& lhs, const SegmentPosting& rhs) {
+    return lhs.termId < rhs.termId || (lhs.termId == rhs.termId && lhs.docId < rhs.docId);
+}
+
+/**
+ * it counts the documents of postings which are not deleted
+ * @param postings are the postings
+ * @param tombstones are the tombstones of the documents
+ * @return the number of documents
+ */
+static size_t countDocuments(const vector<SegmentPosting>& postings, const vector<uint64_t>& tombstones) {
+    vector<uint32_t> docIds;
+    for (auto const &ent1 : postings)
+        if (!((tombstones[ent1.docId / 64] >> (ent1.docId % 64)) & 1))
+            docIds.push_back(ent1.docId);
+    sort(docIds.begin(), docIds.end());
+    
+    return unique(docIds.begin(), docIds.end()) - docIds.begin();
+}
+
+Segment::Segment(const vector<SegmentPosting>& postings, size_t nDocuments)
+    :nDocuments(nDocuments) {
+    vector<uint32_t> docIds, frequencies;
+    for (size_t start = 0, end = 0; start < postings.size(); start = end) {
+        docIds.clear();
+        frequencies.clear();
+        for (end = start; end < postings.size() && postings[end].termId == postings[start].termId; end++) {
+            docIds.push_back(postings[end].docId);
+            frequencies.push_back(postings[end].frequency);
+        }
+        termIds.push_back(postings[start].termId);
+        offsets.push_back(this->postings.size());
+        documentFrequencies.push_back(end - start);
+        PostingsCodec::encode(docIds.data(), frequencies.data(), nullptr, docIds.size(), this->postings);
+    }
+    offsets.push_back(this->postings.size());
+}
+
+
+Segment::~Segment() {
+}
+
+
+size_t Segment::getMemoryUsage() const {
+    return termIds.capacity() * sizeof(uint32_t) + offsets.capacity() * sizeof(uint64_t) 
+        + documentFrequencies.capacity() * sizeof(uint32_t) + postings.capacity();
+}
+
+
+size_t Segment::find(size_t termId) const {
+    size_t i = lower_bound(termIds.begin(), termIds.end(), termId) - termIds.begin();
+    
+    return i < termIds.size() && termIds[i] == termId ? i : termIds.size();
+}
+
+
+SegmentedIndex::SegmentedIndex(const InvertedIndex& index)
+    :index(&index), segments(make_shared<vector<shared_ptr<const Segment>>>()), nBuffered(0), 
+    normSums(index.getNDocuments() + 1, NormSums{ 0, 0, 0 }), baseLog(log(double(max(index.getNDocuments(), size_t(1))))), 
+    tombstones(index.getNDocuments() / 64 + 1, 0), nDocuments(index.getNDocuments()), 
+    documentFrequencies(index.getDocumentFrequencies(), index.getDocumentFrequencies() + index.getNTerms()), 
+    refreshedFrequencies(documentFrequencies), version(1), isMerging(false), isStopping(false) {
+    for (size_t termId = 0; termId < index.getNTerms(); termId++) {
+        double idf = getRelativeIdf(documentFrequencies[termId]);
+        addToNormSums(index.getCursor(termId), 1, idf, idf * idf);
+    }
+    merger = thread(&SegmentedIndex::merge, this);
+}
+
+
+SegmentedIndex::~SegmentedIndex() {
+    {
+        lock_guard<mutex> guard(lock);
+        isStopping = true;
+    }
+    wakeUp.notify_all();
+    merger.join();
+}
+
+
+shared_ptr<const vector<shared_ptr<const Segment>>> SegmentedIndex::getSegments() const {
+    lock_guard<mutex> guard(lock);
+    return segments;
+}
+
+
+size_t SegmentedIndex::getNSegments() const {
+    return getSegments()->size();
+}
+
+
+size_t SegmentedIndex::getMemoryUsage() const {
+    size_t bytes = buffer.capacity() * sizeof(SegmentPosting) + maxFrequencies.capacity() * sizeof(uint64_t) 
+        + normSums.capacity() * sizeof(NormSums) + tombstones.capacity() * sizeof(uint64_t) 
+        + (documentFrequencies.capacity() + refreshedFrequencies.capacity() + changedTerms.capacity()) * sizeof(uint32_t);
+    for (auto const &segment : *getSegments())
+        bytes += segment->getMemoryUsage();
+    
+    return bytes;
+}
+
+
+double SegmentedIndex::getIdf(size_t termId) const {
+    //ln(N) is 0 for a single document, whose weights are then all 0
+    if (nDocuments <= 1)
+        return 0;
+    double nt = max(getDocumentFrequency(termId), size_t(1));
+    
+    return log(double(nDocuments) / nt) / log(nDocuments);
+}
+
+
+double SegmentedIndex::getNorm(size_t docId) const {
+    if (nDocuments <= 1)
+        return 0;
+    //the weights' numerators are TF (r + d), d = ln(N) - ln(N0)
+    double logN = log(nDocuments);
+    double d = logN - baseLog;
+    const NormSums& sums = normSums[docId];
+    double squares = sums.squaredIdfs + d * (2 * sums.idfs + d * sums.frequencies);
+    
+    return sqrt(max(squares, 0.0)) / logN;
+}
+
+
+void SegmentedIndex::addToNormSums(PostingsCursor cursor, double count, double idf, double squaredIdf) {
+    for (; cursor.getDocId() != PostingsCursor::END; cursor.next()) {
+        uint32_t docId = cursor.getDocId();
+        double frequency = cursor.getFrequency() / double(getMaxFrequency(docId));
+        double square = frequency * frequency;
+        NormSums& sums = normSums[docId];
+        sums.frequencies += count * square;
+        sums.idfs += square * idf;
+        sums.squaredIdfs += square * squaredIdf;
+    }
+}
+
+
+size_t SegmentedIndex::addDocument(const vector<pair<uint32_t, uint32_t>>& terms) {
+    size_t docId = getMaxDocId() + 1;
+    uint64_t maxFrequency = 1;
+    for (auto const &ent1 : terms)
+        maxFrequency = max(maxFrequency, uint64_t(ent1.second));
+    
+    //the sums follow the documents' frequencies of the last refresh, as the
+    //ones of the other documents do, and the next refresh brings them up to
+    //the frequencies with the document counted
+    NormSums sums = { 0, 0, 0 };
+    for (auto const &ent1 : terms) {
+        if (ent1.first >= documentFrequencies.size()) {
+            documentFrequencies.resize(ent1.first + 1, 0);
+            refreshedFrequencies.resize(ent1.first + 1, 0);
+        }
+        double frequency = ent1.second / double(maxFrequency);
+        double square = frequency * frequency;
+        double idf = getRelativeIdf(refreshedFrequencies[ent1.first]);
+        sums.frequencies += square;
+        sums.idfs += square * idf;
+        sums.squaredIdfs += square * idf * idf;
+        documentFrequencies[ent1.first]++;
+        changedTerms.push_back(ent1.first);
+        SegmentPosting posting = { ent1.first, uint32_t(docId), ent1.second };
+        buffer.push_back(posting);
+    }
+    nDocuments++;
+    maxFrequencies.push_back(maxFrequency);
+    normSums.push_back(sums);
+    {
+        lock_guard<mutex> guard(lock);
+        if (docId / 64 >= tombstones.size())
+            tombstones.push_back(0);
+    }
+    version++;
+    
+    if (++nBuffered >= BUFFER_SIZE)
+        flush();
+    
+    return docId;
+}
+
+
+bool SegmentedIndex::deleteDocument(size_t docId, const vector<pair<uint32_t, uint32_t>>& terms) {
+    if (docId == 0 || docId > getMaxDocId() || isDeleted(docId))
+        return false;
+    
+    {
+        lock_guard<mutex> guard(lock);
+        tombstones[docId / 64] |= uint64_t(1) << (docId % 64);
+    }
+    for (auto const &ent1 : terms)
+        if (ent1.first < documentFrequencies.size() && documentFrequencies[ent1.first] > 0) {
+            documentFrequencies[ent1.first]--;
+            changedTerms.push_back(ent1.first);
+        }
+    nDocuments--;
+    version++;
+    
+    return true;
+}
+
+
+void SegmentedIndex::flush() {
+    vector<SegmentPosting> postings;
+    postings.swap(buffer);
+    nBuffered = 0;
+    //only this thread changes the tombstones
+    size_t nLive = countDocuments(postings, tombstones);
+    if (nLive == 0)
+        return;
+    sort(postings.begin(), postings.end(), isBefore);
+    shared_ptr<const Segment> segment = make_shared<Segment>(postings, nLive);
+    
+    {
+        lock_guard<mutex> guard(lock);
+        shared_ptr<vector<shared_ptr<const Segment>>> next = make_shared<vector<shared_ptr<const Segment>>>(*segments);
+        next->push_back(segment);
+        segments = next;
+    }
+    wakeUp.notify_all();
+}
+
+
+void SegmentedIndex::refresh() {
+    INSTRUMENT_PHASE(REFRESH_SEGMENTS);
+    if (nBuffered > 0)
+        flush();
+    
+    //a term's r changes in the sums of all the documents which contain it,
+    //deleted ones aside, in the inverted index and in any segment
+    sort(changedTerms.begin(), changedTerms.end());
+    changedTerms.erase(unique(changedTerms.begin(), changedTerms.end()), changedTerms.end());
+    shared_ptr<const vector<shared_ptr<const Segment>>> current = getSegments();
+    for (auto const &termId : changedTerms) {
+        if (refreshedFrequencies[termId] == documentFrequencies[termId])
+            continue;
+        double before = getRelativeIdf(refreshedFrequencies[termId]);
+        double after = getRelativeIdf(documentFrequencies[termId]);
+        if (termId < index->getNTerms())
+            addToNormSums(index->getCursor(termId), 0, after - before, after * after - before * before);
+        for (auto const &segment : *current) {
+            size_t i = segment->find(termId);
+            if (i < segment->getNTerms())
+                addToNormSums(segment->getCursorAt(i), 0, after - before, after * after - before * before);
+        }
+        refreshedFrequencies[termId] = documentFrequencies[termId];
+    }
+    changedTerms.clear();
+}
+
+
+void SegmentedIndex::waitForMerges() {
+    unique_lock<mutex> guard(lock);
+    vector<shared_ptr<const Segment>> chosen;
+    merged.wait(guard, [&]() { return !isMerging && !findMerge(chosen); });
+}
+
+
+bool SegmentedIndex::findMerge(vector<shared_ptr<const Segment>>& chosen) const {
+    //a segment of tier t has at most BUFFER_SIZE * MERGE_FACTOR^t documents
+    vector<vector<shared_ptr<const Segment>>> tiers;
+    for (auto const &segment : *segments) {
+        size_t tier = 0;
+        for (size_t size = BUFFER_SIZE; segment->getNDocuments() > size; size *= MERGE_FACTOR)
+            tier++;
+        if (tier >= tiers.size())
+            tiers.resize(tier + 1);
+        tiers[tier].push_back(segment);
+    }
+    for (auto const &tier : tiers)
+        if (tier.size() >= MERGE_FACTOR) {
+            chosen.assign(tier.begin(), tier.begin() + MERGE_FACTOR);
+            return true;
+        }
+    
+    return false;
+}
+
+
+void SegmentedIndex::merge() {
+    unique_lock<mutex> guard(lock);
+    while (true) {
+        vector<shared_ptr<const Segment>> chosen;
+        wakeUp.wait(guard, [&]() { return isStopping || findMerge(chosen); });
+        if (isStopping)
+            return;
+        isMerging = true;
+        vector<uint64_t> snapshot = tombstones;
+        guard.unlock();
+        
+        shared_ptr<const Segment> segment = mergeSegments(chosen, snapshot);
+        
+        //documents deleted meanwhile are still marked by the tombstones
+        guard.lock();
+        shared_ptr<vector<shared_ptr<const Segment>>> next = make_shared<vector<shared_ptr<const Segment>>>();
+        for (auto const &ent1 : *segments)
+            if (find(chosen.begin(), chosen.end(), ent1) == chosen.end())
+                next->push_back(ent1);
+        if (segment->getNDocuments() > 0)
+            next->push_back(segment);
+        segments = next;
+        isMerging = false;
+        merged.notify_all();
+    }
+}
+
+
+shared_ptr<const Segment> SegmentedIndex::mergeSegments(const vector<shared_ptr<const Segment>>& chosen, 
+    const vector<uint64_t>& tombstones) {
+    INSTRUMENT_PHASE(MERGE_SEGMENTS);
+    vector<SegmentPosting> postings;
+    for (auto const &segment : chosen)
+        for (size_t i = 0; i < segment->getNTerms(); i++) {
+            for (PostingsCursor cursor = segment->getCursorAt(i); cursor.getDocId() != PostingsCursor::END; cursor.next()) {
+                uint32_t docId = cursor.getDocId();
+                SegmentPosting posting = { segment->getTermId(i), docId, cursor.getFrequency() };
+                if (!((tombstones[docId / 64] >> (docId % 64)) & 1))
+                    postings.push_back(posting);
+            }
+        }
+    sort(postings.begin(), postings.end(), isBefore);
+    
+    return make_shared<Segment>(postings, countDocuments(postings, tombstones));
+}
+
@@ -0,0 +1,390 @@
+/*
+ * The MIT License
+ *
+ * Copyright 2017 Theomeli.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/* 
+ * File:   SegmentedIndex.h
+ * Author: Theomeli
+ *
+ * Created on October 17, 2026, 6:20 PM
+ */
+
+#ifndef SEGMENTEDINDEX_H
+#define SEGMENTEDINDEX_H
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cmath>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "InvertedIndex.h"
+#include "Instrumentation.h"
+
+using namespace std;
+
+/**
+ * a posting of an added document: the id of a term, the id of the document
+ * and the frequency of the term in it
+ */
+struct SegmentPosting {
+    uint32_t termId;
+    uint32_t docId;
+    uint32_t frequency;
+};
+
+/**
+ * an immutable part of the added documents of a SegmentedIndex. It keeps for
+ * the terms of its documents their compressed postings lists, the ids of the 
+ * documents and the frequencies of the terms, by ascending term id. The 
+ * weights are computed from the frequencies when a list is read
+ */
+class Segment {
+public:
+    /**
+     * it compresses the postings of a segment
+     * @param postings are the postings sorted by term id and document id
+     * @param nDocuments is the number of documents of the segment
+     */
+    Segment(const vector<SegmentPosting>& postings, size_t nDocuments);
+    Segment(const Segment& orig) = delete;
+    Segment& operator =(const Segment& rightSide) = delete;
+    virtual ~Segment();
+    
+    /**
+     * getter for private member nDocuments
+     * @return the number of documents of the segment, deleted ones included
+     */
+     size_t getNDocuments() const { return nDocuments; }
+    
+    /**
+     * getter for the number of terms with postings lists in the segment
+     * @return the number of terms
+     */
+     size_t getNTerms() const { return termIds.size(); }
+    
+    /**
+     * getter for the id of a term of the segment
+     * @param i is the position of the term, less than getNTerms()
+     * @return the id of the term
+     */
+     uint32_t getTermId(size_t i) const { return termIds[i]; }
+    
+    /**
+     * getter for a cursor over the postings list of a term of the segment
+     * @param i is the position of the term, less than getNTerms()
+     * @return the cursor on the first posting
+     */
+     PostingsCursor getCursorAt(size_t i) const { 
+         return PostingsCursor(postings.data() + offsets[i], documentFrequencies[i]); 
+     }
+    
+    /**
+     * it finds the position of a term in the segment
+     * @param termId is the id of the term
+     * @return the position of the term or getNTerms() if the term is not
+     * in the segment
+     */
+    size_t find(size_t termId) const;
+    
+    /**
+     * it counts the bytes of the storage of the segment
+     * @return the number of bytes
+     */
+    size_t getMemoryUsage() const;
+private:
+    //number of documents of the segment
+    size_t									nDocuments;
+    //the ids of the terms, ascending
+    vector<uint32_t>							termIds;
+    //the start of each term's list in postings followed
+    //by the end of the last list
+    vector<uint64_t>							offsets;
+    //the length of each term's list
+    vector<uint32_t>							documentFrequencies;
+    //the compressed postings lists one after the other
+    vector<uint8_t>								postings;
+};
+
+/**
+ * the documents added to and deleted from an InvertedIndex without building
+ * it again. The inverted index is not changed: its deleted documents are 
+ * marked in a bitmap of tombstones and the added ones are kept in a buffer,
+ * which becomes a new segment once it is full or the index is refreshed. A
+ * thread in the background merges the segments of the same size tier, 
+ * MERGE_FACTOR at a time, dropping their deleted documents. The number of 
+ * documents and the documents' frequencies of the terms are kept up to date
+ * on each change, and the weights of all the documents, the ones of the 
+ * inverted index included, are computed from them when the postings are read,
+ * so the cosines are the ones of an index built from the live documents.
+ * A document's norm depends on the idfs of all its terms, and ln(N) changes
+ * with every change, so each document keeps the sums which give its norm for
+ * any N: with TF the normalized frequency of a term and r = ln(N0) - ln(nt),
+ * N0 being the documents of the inverted index, the sums of TF^2, TF^2 r and
+ * TF^2 r^2 over its terms. The sums follow the documents' frequencies of the
+ * terms at each refresh, by reading the postings lists of the terms whose
+ * frequencies changed. Documents and terms keep their ids. Changes and 
+ * queries must not be made at the same time, merges may
+ */
+class SegmentedIndex {
+public:
+    //the number of documents of a segment made from the buffer
+    static const size_t BUFFER_SIZE = 64;
+    //the number of segments of a tier which are merged together
+    static const size_t MERGE_FACTOR = 4;
+    
+    /**
+     * it starts from the documents of an inverted index, which must outlive
+     * the segmented index, reading all its postings once for the sums of
+     * the norms of its documents
+     * @param index is the inverted index, its documents have ids from 1 to
+     * index.getNDocuments()
+     */
+    SegmentedIndex(const InvertedIndex& index);
+    SegmentedIndex(const SegmentedIndex& orig) = delete;
+    SegmentedIndex& operator =(const SegmentedIndex& rightSide) = delete;
+    virtual ~SegmentedIndex();
+    
+    /**
+     * getter for private member nDocuments
+     * @return the number of live documents
+     */
+     size_t getNDocuments() const { return nDocuments; }
+    
+    /**
+     * getter for the greatest document id given
+     * @return the id, live or deleted
+     */
+     size_t getMaxDocId() const { return index->getNDocuments() + maxFrequencies.size(); }
+    
+    /**
+     * getter for the number of live documents which contain a term
+     * @param termId is the id of the term
+     * @return the document frequency of the term
+     */
+     size_t getDocumentFrequency(size_t termId) const { 
+         return termId < documentFrequencies.size() ? documentFrequencies[termId] : 0; 
+     }
+    
+    /**
+     * getter for the frequency of the most often term of a document
+     * @param docId is the id of the document, at most getMaxDocId()
+     * @return the greatest frequency of the document
+     */
+     uint64_t getMaxFrequency(size_t docId) const { 
+         return docId <= index->getNDocuments() ? index->getMaxFrequency(docId) 
+             : maxFrequencies[docId - index->getNDocuments() - 1]; 
+     }
+    
+    /**
+     * getter for the tombstone of a document
+     * @param docId is the id of the document, at most getMaxDocId()
+     * @return true if the document is deleted
+     */
+     bool isDeleted(size_t docId) const { return (tombstones[docId / 64] >> (docId % 64)) & 1; }
+    
+    /**
+     * getter for private member version
+     * @return a number which changes whenever a document is added or deleted
+     */
+     uint64_t getVersion() const { return version; }
+    
+    /**
+     * it computes the idf of a term in the live documents with the formula
+     * of the inverted index, IDF = ln(N/nt)/ln(N), which is 0 while there
+     * is at most one document
+     * @param termId is the id of the term
+     * @return the idf of the term
+     */
+    double getIdf(size_t termId) const;
+    
+    /**
+     * it computes the Euclidean norm of a document's weights vector with
+     * the idfs of the live documents, as of the last refresh
+     * @param docId is the id of the document, at most getMaxDocId()
+     * @return the norm of the document
+     */
+    double getNorm(size_t docId) const;
+    
+    /**
+     * it takes the segments which queries read, so that a merge which ends
+     * meanwhile does not change them
+     * @return the segments, in no particular order
+     */
+    shared_ptr<const vector<shared_ptr<const Segment>>> getSegments() const;
+    
+    /**
+     * it returns the number of segments, the buffer excluded
+     * @return the number of segments
+     */
+    size_t getNSegments() const;
+    
+    /**
+     * it counts the bytes of the segments, the buffer and the documents' and
+     * terms' statistics, the inverted index excluded
+     * @return the number of bytes
+     */
+    size_t getMemoryUsage() const;
+    
+    /**
+     * it adds a document to the buffer with the next id
+     * @param terms are the pairs term id - frequency of the document's
+     * terms, sorted by term id
+     * @return the id of the document
+     */
+    size_t addDocument(const vector<pair<uint32_t, uint32_t>>& terms);
+    
+    /**
+     * it marks a document as deleted
+     * @param docId is the id of the document
+     * @param terms are the pairs term id - frequency of the document's
+     * terms, whose documents' frequencies are decreased
+     * @return false if there is no such live document
+     */
+    bool deleteDocument(size_t docId, const vector<pair<uint32_t, uint32_t>>& terms);
+    
+    /**
+     * it makes the buffer a segment and brings the sums of the norms up to
+     * the documents' frequencies, reading the postings lists of the terms
+     * whose frequencies changed since the last refresh. It must be called
+     * before queries are evaluated
+     */
+    void refresh();
+    
+    /**
+     * it waits until no segments are left to be merged
+     */
+    void waitForMerges();
+private:
+    //the sums over the terms of a document which give its norm
+    struct NormSums {
+        //the sum of TF^2
+        double								frequencies;
+        //the sum of TF^2 r
+        double								idfs;
+        //the sum of TF^2 r^2
+        double								squaredIdfs;
+    };
+    
+    //the inverted index of the documents before the changes
+    const InvertedIndex*							index;
+    //the segments which queries read, replaced as a
+    //whole when they change
+    shared_ptr<const vector<shared_ptr<const Segment>>>			segments;
+    //the postings of the documents of the buffer, by
+    //document id
+    vector<SegmentPosting>							buffer;
+    //the number of documents of the buffer
+    size_t									nBuffered;
+    //the greatest frequency of each added document, by
+    //document id after the ones of the inverted index
+    vector<uint64_t>							maxFrequencies;
+    //the sums of the norm of each document, by document id
+    vector<NormSums>							normSums;
+    //ln(N0), which r is taken from
+    double									baseLog;
+    //a bit for each document id, set if it is deleted
+    vector<uint64_t>							tombstones;
+    //the number of live documents
+    size_t									nDocuments;
+    //the number of live documents containing each term
+    vector<uint32_t>							documentFrequencies;
+    //the documents' frequencies which the sums follow,
+    //the ones of the last refresh
+    vector<uint32_t>							refreshedFrequencies;
+    //the terms whose documents' frequencies changed
+    //since the last refresh, maybe repeated
+    vector<uint32_t>							changedTerms;
+    //it is increased whenever a document is added or deleted
+    uint64_t								version;
+    //it protects segments, tombstones and the members below
+    //from the merging thread
+    mutable mutex								lock;
+    //it wakes the merging thread when a segment is added
+    //or the index is destroyed
+    condition_variable							wakeUp;
+    //it wakes waitForMerges when a merge ends
+    condition_variable							merged;
+    //true while the merging thread merges segments
+    bool									isMerging;
+    //true when the index is destroyed
+    bool									isStopping;
+    //the thread which merges the segments
+    thread									merger;
+    
+    /**
+     * it computes r of a term, ln(N0) - ln(nt), nt being at least 1
+     * @param documentFrequency is the documents' frequency of the term
+     * @return r
+     */
+    double getRelativeIdf(size_t documentFrequency) const { 
+        return baseLog - log(double(max(documentFrequency, size_t(1)))); 
+    }
+    
+    /**
+     * it adds the postings of a term, read by a cursor, to the sums of
+     * their documents' norms
+     * @param cursor is the cursor on the first posting of the term's list
+     * @param count is 1 to add TF^2 to the sum of TF^2, 0 when only the
+     * term's r changes
+     * @param idf is added to the sum of TF^2 r times TF^2: r of the term,
+     * or the change of r
+     * @param squaredIdf is added to the sum of TF^2 r^2 times TF^2: r^2 of
+     * the term, or the change of r^2
+     */
+    void addToNormSums(PostingsCursor cursor, double count, double idf, double squaredIdf);
+    
+    /**
+     * it makes the buffer a segment
+     */
+    void flush();
+    
+    /**
+     * the loop of the merging thread
+     */
+    void merge();
+    
+    /**
+     * it finds MERGE_FACTOR segments of the same tier, the least tier
+     * first. The lock must be held
+     * @param chosen is set to the segments to be merged
+     * @return false if no tier has enough segments
+     */
+    bool findMerge(vector<shared_ptr<const Segment>>& chosen) const;
+    
+    /**
+     * it merges segments to a new one, dropping the documents which
+     * were deleted
+     * @param chosen are the segments to be merged
+     * @param tombstones are the tombstones when the merge started
+     * @return the new segment
+     */
+    static shared_ptr<const Segment> mergeSegments(const vector<shared_ptr<const Segment>>& chosen, 
+        const vector<uint64_t>& tombstones);
+};
+
+#endif /* SEGMENTEDINDEX_H */
+
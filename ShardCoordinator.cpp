@@ -0,0 +1,219 @@
+/*
+ * The MIT License
+ *
+ * Copyright 2017 Theomeli.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+/* 
+ * File:   ShardCoordinator.cpp
+ * Author: Theomeli
+ * 
+ * Created on October 23, 2026, 2:15 PM
+ */
+
+#include "ShardCoordinator.h"
+#include "ShardWorker.h"
+#include "Instrumentation.h"
+#include <algorithm>
+#include <unordered_map>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+
+ShardCoordinator::ShardCoordinator(): nDocuments(0) {
+}
+
+
+ShardCoordinator::~ShardCoordinator() {
+    stop();
+}
+
+
+bool ShardCoordinator::start(size_t nShards, const function<bool(size_t, int)>& serve) {
+    for (size_t shard = 0; shard < nShards; shard++) {
+        int pair[2];
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, pair) != 0)
+            return false;
+        pid_t process = fork();
+        if (process < 0) {
+            close(pair[0]);
+            close(pair[1]);
+            return false;
+        }
+        if (process == 0) {
+            //a shard keeps only its own socket
+            close(pair[0]);
+            for (auto const &ent1 : sockets)
+                close(ent1);
+            bool isServed = serve(shard, pair[1]);
+            close(pair[1]);
+            _exit(isServed ? 0 : 1);
+        }
+        close(pair[1]);
+        sockets.push_back(pair[0]);
+        processes.push_back(process);
+    }
+    
+    return true;
+}
+
+
+bool ShardCoordinator::receive(size_t shard, uint64_t type, Message& message) {
+    return message.read(sockets[shard]) && message.getNumber() == type && message.isValid();
+}
+
+
+bool ShardCoordinator::exchangeStatistics() {
+    INSTRUMENT_PHASE(EXCHANGE_STATISTICS);
+    //merging the shards' lexicons in the order of the shards gives the terms
+    //the ids of a single index of a documents file ordered by id
+    Lexicon terms;
+    vector<uint32_t> documentFrequencies;
+    Message message;
+    firstDocIds.clear();
+    for (size_t shard = 0; shard < sockets.size(); shard++) {
+        if (!receive(shard, ShardWorker::STATISTICS, message))
+            return false;
+        nDocuments = message.getNumber();
+        firstDocIds.push_back(message.getNumber());
+        message.getNumber();
+        size_t nTerms = message.getNumber();
+        for (size_t i = 0; i < nTerms && message.isValid(); i++) {
+            uint32_t termId = terms.intern(message.getString());
+            if (termId >= documentFrequencies.size())
+                documentFrequencies.resize(terms.size(), 0);
+            documentFrequencies[termId] += message.getNumber();
+        }
+        if (!message.isValid())
+            return false;
+    }
+    
+    message = Message();
+    message.putNumber(ShardWorker::COLLECTION);
+    message.putNumber(terms.size());
+    for (uint32_t termId = 0; termId < terms.size(); termId++) {
+        message.putString(terms.getTerm(termId));
+        message.putNumber(documentFrequencies[termId]);
+    }
+    for (auto const &ent1 : sockets)
+        if (!message.write(ent1))
+            return false;
+    
+    return true;
+}
+
+
+bool ShardCoordinator::search(const ProcessFiles& queries, string_view text) {
+    INSTRUMENT_PHASE(COMPUTE_RESULTS);
+    Message message;
+    message.putNumber(ShardWorker::QUERIES);
+    message.putString(text);
+    for (auto const &ent1 : sockets)
+        if (!message.write(ent1))
+            return false;
+    
+    //each shard returns the best documents of its own, so the best of
+    //their union are the best of the collection
+    size_t nQueries = queries.getNQueries();
+    results = vector<vector<pair<size_t, double>>>(nQueries + 1);
+    for (size_t shard = 0; shard < sockets.size(); shard++) {
+        if (!receive(shard, ShardWorker::RESULTS, message) || message.getNumber() != nQueries)
+            return false;
+        for (size_t queryId = 1; queryId <= nQueries && message.isValid(); queryId++) {
+            size_t nResults = message.getNumber();
+            for (size_t i = 0; i < nResults && message.isValid(); i++) {
+                size_t docId = message.getNumber();
+                results[queryId].push_back(make_pair(docId, message.getDouble()));
+            }
+        }
+        if (!message.isValid())
+            return false;
+    }
+    
+    map<size_t, size_t> nResponses = queries.getNResponses();
+    for (size_t queryId = 1; queryId <= nQueries; queryId++) {
+        map<size_t, size_t>::const_iterator k = nResponses.find(queryId);
+        size_t count = k == nResponses.end() ? 0 : k->second;
+        sort(results[queryId].begin(), results[queryId].end(), Compare());
+        if (results[queryId].size() > count)
+            results[queryId].resize(count);
+    }
+    
+    return true;
+}
+
+
+bool ShardCoordinator::writeResults(ResultWriter& writer, const ProcessFiles& queries) {
+    INSTRUMENT_PHASE(WRITE_RESULTS);
+    //the texts are asked for once, each from the shard holding the document
+    unordered_map<size_t, string> texts;
+    if (writer.hasDocuments()) {
+        vector<vector<size_t>> docIds(sockets.size());
+        for (auto const &result : results)
+            for (auto const &ent1 : result)
+                if (texts.emplace(ent1.first, string()).second) {
+                    size_t shard = upper_bound(firstDocIds.begin(), firstDocIds.end(), ent1.first) - firstDocIds.begin();
+                    docIds[max(shard, size_t(1)) - 1].push_back(ent1.first);
+                }
+        Message message;
+        for (size_t shard = 0; shard < sockets.size(); shard++) {
+            if (docIds[shard].empty())
+                continue;
+            message = Message();
+            message.putNumber(ShardWorker::DOCUMENTS);
+            message.putNumber(docIds[shard].size());
+            for (auto const &ent1 : docIds[shard])
+                message.putNumber(ent1);
+            if (!message.write(sockets[shard]) || !receive(shard, ShardWorker::TEXTS, message))
+                return false;
+            for (auto const &ent1 : docIds[shard])
+                texts[ent1] = string(message.getString());
+            if (!message.isValid())
+                return false;
+        }
+    }
+    
+    for (size_t queryId = 1; queryId < results.size(); queryId++) {
+        writer.beginQuery(queryId, queries.getQueriesTokens().getTokens(queryId), results[queryId].size());
+        for (auto const &ent1 : results[queryId])
+            writer.addResult(ent1.first, writer.hasDocuments() ? string_view(texts[ent1.first]) : string_view(), ent1.second);
+        writer.endQuery();
+    }
+    
+    return writer.flush();
+}
+
+
+bool ShardCoordinator::stop() {
+    for (auto const &ent1 : sockets)
+        close(ent1);
+    sockets.clear();
+    bool isExited = true;
+    for (auto const &ent1 : processes) {
+        int status;
+        if (waitpid(ent1, &status, 0) != ent1 || !WIFEXITED(status) || WEXITSTATUS(status) != 0)
+            isExited = false;
+    }
+    processes.clear();
+    
+    return isExited;
+}
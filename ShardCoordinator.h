@@ -0,0 +1,138 @@
+/*
+ * The MIT License
+ *
+ * Copyright 2017 Theomeli.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+/* 
+ * File:   ShardCoordinator.h
+ * Author: Theomeli
+ *
+ * Created on October 23, 2026, 2:15 PM
+ */
+
+#ifndef SHARDCOORDINATOR_H
+#define SHARDCOORDINATOR_H
+#include "Message.h"
+#include "ProcessFiles.h"
+#include "ResultWriter.h"
+#include <functional>
+#include <sys/types.h>
+
+using namespace std;
+
+/**
+ * the coordinator of a collection split in shards of consecutive document ids,
+ * each served by a ShardWorker in a process of its own, connected to it by a
+ * Unix domain socket. It sums the counts of the shards' terms to the counts of
+ * the collection and sends them to every shard, broadcasts the queries and
+ * merges the results of the shards to the results of the collection, which
+ * equal the ones of a single index when the documents file lists the documents
+ * by ascending id, since the terms then take the same ids. Only the document
+ * frequencies of the terms are kept by the coordinator, not the documents
+ */
+class ShardCoordinator {
+public:
+    ShardCoordinator();
+    ShardCoordinator(const ShardCoordinator& orig) = delete;
+    ShardCoordinator& operator =(const ShardCoordinator& rightSide) = delete;
+    virtual ~ShardCoordinator();
+    
+    /**
+     * getter for the number of shards
+     * @return the number of processes started
+     */
+     size_t getNShards() const { return sockets.size(); }
+    
+    /**
+     * getter for private member results
+     * @return for each query the pairs document id - cosine of its results
+     */
+     const vector<vector<pair<size_t, double>>>& getResults() const { return results; }
+    
+    /**
+     * it forks a process for each shard, connected to the coordinator by a pair
+     * of Unix domain sockets, which calls serve and exits, with status 0 if serve
+     * returns true. Since the processes are forked, it must be called before the
+     * coordinator starts threads or reads the files
+     * @param nShards is the number of shards
+     * @param serve is called in each process with the number of its shard and 
+     * the descriptor of its socket
+     * @return false if a process or a socket could not be made
+     */
+    bool start(size_t nShards, const function<bool(size_t, int)>& serve);
+    
+    /**
+     * it receives the counts of the shards' terms and sends every shard the
+     * terms of the collection, in the order of the shards and of their first
+     * appearance in them, with the number of documents containing each
+     * @return false if a shard failed
+     */
+    bool exchangeStatistics();
+    
+    /**
+     * it sends the queries to all the shards and merges the results which
+     * come back to the results of the collection
+     * @param queries are the queries, read from their file
+     * @param text is the content of the queries file
+     * @return false if a shard failed
+     */
+    bool search(const ProcessFiles& queries, string_view text);
+    
+    /**
+     * it writes the results of the queries to a sink, asking the shards for
+     * the text of the documents when the sink's format has it
+     * @param writer is the sink of the results
+     * @param queries are the queries, read from their file
+     * @return false if a shard or the sink's stream failed
+     */
+    bool writeResults(ResultWriter& writer, const ProcessFiles& queries);
+    
+    /**
+     * it closes the sockets, so the shards exit, and waits for their processes
+     * @return false if a process did not exit with status 0
+     */
+    bool stop();
+private:
+    //the socket to each shard
+    vector<int>								sockets;
+    //the process of each shard
+    vector<pid_t>								processes;
+    //the first document id of each shard
+    vector<size_t>								firstDocIds;
+    //the number of documents of the collection
+    size_t									nDocuments;
+    //for each query the pairs document id - cosine of
+    //its results over all the shards
+    vector<vector<pair<size_t, double>>>					results;
+    
+    /**
+     * it receives a message from a shard and reads its type
+     * @param shard is the number of the shard
+     * @param type is the type the message must have
+     * @param message is set to the message
+     * @return false if the socket failed or the message has another type
+     */
+    bool receive(size_t shard, uint64_t type, Message& message);
+};
+
+#endif /* SHARDCOORDINATOR_H */
@@ -0,0 +1,125 @@
+/*
+ * The MIT License
+ *
+ * Copyright 2017 Theomeli.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+/* 
+ * File:   ShardWorker.cpp
+ * Author: Theomeli
+ * 
+ * Created on October 23, 2026, 11:30 AM
+ */
+
+#include "ShardWorker.h"
+
+ShardWorker::ShardWorker(size_t shardId, size_t nShards, int fd): shardId(shardId), nShards(nShards), fd(fd) {
+}
+
+
+ShardWorker::~ShardWorker() {
+}
+
+
+bool ShardWorker::receive(MessageType type, Message& message) {
+    return message.read(fd) && message.getNumber() == uint64_t(type) && message.isValid();
+}
+
+
+bool ShardWorker::run(const string& documentsFileName, size_t nThreads, size_t batchSize, size_t cacheSize) {
+    QueryExecutor executor(nThreads);
+    ProcessFiles p(documentsFileName, "");
+    if (p.fail())
+        return false;
+    p.setShard(shardId, nShards);
+    IndexBuilder builder;
+    p.readDocumentsFile(p.getDocumentsMapping(), builder, executor);
+    
+    //the counts of the shard's terms, which the coordinator sums over the shards
+    Message message;
+    const Lexicon& terms = builder.getLexicon();
+    message.putNumber(STATISTICS);
+    message.putNumber(p.getNDocuments());
+    message.putNumber(p.getFirstDocId());
+    message.putNumber(p.getLastDocId());
+    message.putNumber(terms.size());
+    for (uint32_t termId = 0; termId < terms.size(); termId++) {
+        message.putString(terms.getTerm(termId));
+        message.putNumber(builder.getTermFrequencies()[termId].size());
+    }
+    if (!message.write(fd))
+        return false;
+    
+    //the collection's counts come back by the ids of its terms
+    if (!receive(COLLECTION, message))
+        return false;
+    size_t nTerms = message.getNumber();
+    Lexicon collectionTerms;
+    vector<uint32_t> documentFrequencies;
+    for (size_t i = 0; i < nTerms && message.isValid(); i++) {
+        collectionTerms.intern(message.getString());
+        documentFrequencies.push_back(message.getNumber());
+    }
+    if (!message.isValid() || !receive(QUERIES, message))
+        return false;
+    p.readQueries(message.getString());
+    
+    TextRetrievalEngine t(move(p));
+    t.getCache().setCapacity(cacheSize);
+    t.setCollectionStatistics(collectionTerms, documentFrequencies);
+    t.computeFrequencies(move(builder));
+    t.initializeIdfs();
+    t.computeDocsWeight(false);
+    t.computeDocsWeight(true);
+    t.computeResults(executor, batchSize);
+    
+    message = Message();
+    message.putNumber(RESULTS);
+    message.putNumber(t.getP()->getNQueries());
+    for (size_t queryId = 1; queryId <= t.getP()->getNQueries(); queryId++) {
+        const vector<pair<size_t, double>>& result = t.getResults()[queryId];
+        message.putNumber(result.size());
+        for (auto const &ent1 : result) {
+            message.putNumber(ent1.first);
+            message.putDouble(ent1.second);
+        }
+    }
+    if (!message.write(fd))
+        return false;
+    
+    //the texts of the documents to be displayed, until the coordinator is done
+    string text;
+    while (receive(DOCUMENTS, message)) {
+        size_t nDocuments = message.getNumber();
+        Message texts;
+        texts.putNumber(TEXTS);
+        for (size_t i = 0; i < nDocuments && message.isValid(); i++) {
+            size_t docId = message.getNumber();
+            bool isOwned = docId >= t.getP()->getFirstDocId() && docId <= t.getP()->getLastDocId();
+            texts.putString(isOwned ? t.getP()->getDocuments().getDocument(docId, text) : string_view());
+        }
+        if (!texts.write(fd))
+            break;
+    }
+    
+    return true;
+}
@@ -0,0 +1,94 @@
+/*
+ * The MIT License
+ *
+ * Copyright 2017 Theomeli.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+/* 
+ * File:   ShardWorker.h
+ * Author: Theomeli
+ *
+ * Created on October 23, 2026, 11:30 AM
+ */
+
+#ifndef SHARDWORKER_H
+#define SHARDWORKER_H
+#include "Message.h"
+#include "TextRetrievalEngine.h"
+
+using namespace std;
+
+/**
+ * the process serving a shard of the collection, the documents of a range of
+ * consecutive ids, for a ShardCoordinator connected to it by a socket. It sends
+ * the coordinator the number of its documents containing each of its terms and
+ * receives the counts of the whole collection, so that its weights are the ones
+ * of a single index of the collection. Then it receives the queries, evaluates
+ * them and sends back the results of each over its documents, and sends the
+ * text of the documents which the coordinator asks for until the socket is closed
+ */
+class ShardWorker {
+public:
+    //the type of a message, its first field
+    enum MessageType { STATISTICS = 1, COLLECTION, QUERIES, RESULTS, DOCUMENTS, TEXTS };
+    
+    /**
+     * @param shardId is the number of the shard, smaller than nShards
+     * @param nShards is the number of shards of the collection
+     * @param fd is the descriptor of the socket to the coordinator
+     */
+    ShardWorker(size_t shardId, size_t nShards, int fd);
+    ShardWorker(const ShardWorker& orig) = delete;
+    ShardWorker& operator =(const ShardWorker& rightSide) = delete;
+    virtual ~ShardWorker();
+    
+    /**
+     * it reads the shard's documents, builds their index and serves the
+     * coordinator until it closes the socket
+     * @param documentsFileName is the path of the documents file
+     * @param nThreads is the number of threads reading the documents and
+     * evaluating the queries, 0 for one per core
+     * @param batchSize is the number of queries evaluated together
+     * @param cacheSize is the size of the cache of the results in bytes
+     * @return false if the documents file could not be opened, the
+     * coordinator sent a message out of order or the socket failed before
+     * the results were sent
+     */
+    bool run(const string& documentsFileName, size_t nThreads, size_t batchSize, size_t cacheSize);
+private:
+    //the number of the shard
+    size_t									shardId;
+    //the number of shards of the collection
+    size_t									nShards;
+    //the descriptor of the socket to the coordinator
+    int									fd;
+    
+    /**
+     * it receives a message from the coordinator and reads its type
+     * @param type is the type the message must have
+     * @param message is set to the message
+     * @return false if the socket failed or the message has another type
+     */
+    bool receive(MessageType type, Message& message);
+};
+
+#endif /* SHARDWORKER_H */
@@ -0,0 +1,201 @@
+/*
+ * The MIT License
+ *
+ * Copyright 2017 Theomeli.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+/* 
+ * File:   TermDictionary.cpp
+ * Author: Theomeli
+ * 
+ * Created on October 27, 2026, 9:20 AM
+ */
+
+#include "TermDictionary.h"
+#include <algorithm>
+
+/**
+ * it appends a value as a variable-byte number, seven bits per byte
+ * starting from the lowest, with the high bit set on all but the last byte
+ */
+static void putVariableByte(uint32_t value, vector<uint8_t>& out) {
+    while (value >= 0x80) {
+        out.push_back(uint8_t(value) | 0x80);
+        value >>= 7;
+    }
+    out.push_back(uint8_t(value));
+}
+
+
+/**
+ * it reads a variable-byte number and moves in past it
+ */
+static uint32_t getVariableByte(const uint8_t*& in) {
+    uint32_t value = 0;
+    for (unsigned shift = 0; ; shift += 7) {
+        uint8_t byte = *in++;
+        value |= uint32_t(byte & 0x7F) << shift;
+        if (byte < 0x80)
+            return value;
+    }
+}
+
+
+/**
+ * it decodes the next term of a block over the term before it
+ * @param in is the coded term, moved past it
+ * @param term holds the term before and is set to the next one
+ */
+static void decodeNext(const uint8_t*& in, string& term) {
+    uint32_t shared = getVariableByte(in);
+    uint32_t length = getVariableByte(in);
+    term.resize(shared);
+    term.append(reinterpret_cast<const char*>(in), length);
+    in += length;
+}
+
+
+TermDictionary::TermDictionary(const Lexicon& lexicon): nTerms(lexicon.size()), termIds(nTerms), ranks(nTerms) {
+    for (uint32_t termId = 0; termId < nTerms; termId++)
+        termIds[termId] = termId;
+    sort(termIds.begin(), termIds.end(), [&lexicon](uint32_t a, uint32_t b) { 
+        return lexicon.getTerm(a) < lexicon.getTerm(b); 
+    });
+    
+    string_view previous;
+    for (size_t rank = 0; rank < nTerms; rank++) {
+        ranks[termIds[rank]] = rank;
+        string_view term = lexicon.getTerm(termIds[rank]);
+        if (rank % BLOCK_SIZE == 0) {
+            blockOffsets.push_back(data.size());
+            putVariableByte(term.size(), data);
+        }
+        else {
+            size_t shared = 0;
+            while (shared < term.size() && shared < previous.size() && term[shared] == previous[shared])
+                shared++;
+            putVariableByte(shared, data);
+            putVariableByte(term.size() - shared, data);
+            term.remove_prefix(shared);
+        }
+        data.insert(data.end(), term.begin(), term.end());
+        previous = lexicon.getTerm(termIds[rank]);
+    }
+    data.shrink_to_fit();
+    blockOffsets.shrink_to_fit();
+}
+
+
+TermDictionary::~TermDictionary() {
+}
+
+
+string_view TermDictionary::getFirstTerm(size_t block) const {
+    const uint8_t* in = data.data() + blockOffsets[block];
+    uint32_t length = getVariableByte(in);
+    
+    return string_view(reinterpret_cast<const char*>(in), length);
+}
+
+
+size_t TermDictionary::findBlock(string_view term, bool isEqualTaken) const {
+    //the blocks are searched by their first terms, which are whole
+    size_t low = 0, high = blockOffsets.size();
+    while (high - low > 1) {
+        size_t middle = low + (high - low) / 2;
+        int order = getFirstTerm(middle).compare(term);
+        if (order < 0 || (order == 0 && isEqualTaken))
+            low = middle;
+        else
+            high = middle;
+    }
+    
+    return low;
+}
+
+
+uint32_t TermDictionary::find(string_view term) const {
+    if (nTerms == 0)
+        return Lexicon::NOT_FOUND;
+    //a term equal to the first one of a block is in that block
+    size_t block = findBlock(term, true);
+    const uint8_t* in = data.data() + blockOffsets[block];
+    string current;
+    for (size_t rank = block * BLOCK_SIZE; rank < min(nTerms, (block + 1) * BLOCK_SIZE); rank++) {
+        if (rank == block * BLOCK_SIZE) {
+            uint32_t length = getVariableByte(in);
+            current.assign(reinterpret_cast<const char*>(in), length);
+            in += length;
+        }
+        else
+            decodeNext(in, current);
+        if (current == term)
+            return termIds[rank];
+        if (term < current)
+            break;
+    }
+    
+    return Lexicon::NOT_FOUND;
+}
+
+
+void TermDictionary::findPrefix(string_view prefix, vector<uint32_t>& termIds) const {
+    termIds.clear();
+    if (nTerms == 0)
+        return;
+    //the terms beginning with the prefix follow each other from the first
+    //one not less than it, which is in the block found or the next
+    size_t block = findBlock(prefix, false);
+    const uint8_t* in = data.data() + blockOffsets[block];
+    string current;
+    for (size_t rank = block * BLOCK_SIZE; rank < nTerms; rank++) {
+        if (rank % BLOCK_SIZE == 0) {
+            uint32_t length = getVariableByte(in);
+            current.assign(reinterpret_cast<const char*>(in), length);
+            in += length;
+        }
+        else
+            decodeNext(in, current);
+        if (current.compare(0, prefix.size(), prefix) == 0)
+            termIds.push_back(this->termIds[rank]);
+        else if (prefix < current)
+            break;
+    }
+}
+
+
+string_view TermDictionary::getTerm(uint32_t termId, string& scratch) const {
+    size_t rank = ranks[termId], block = rank / BLOCK_SIZE;
+    const uint8_t* in = data.data() + blockOffsets[block];
+    uint32_t length = getVariableByte(in);
+    scratch.assign(reinterpret_cast<const char*>(in), length);
+    in += length;
+    for (size_t i = block * BLOCK_SIZE + 1; i <= rank; i++)
+        decodeNext(in, scratch);
+    
+    return scratch;
+}
+
+
+size_t TermDictionary::getMemoryUsage() const {
+    return data.capacity() + (blockOffsets.capacity() + termIds.capacity() + ranks.capacity()) * sizeof(uint32_t);
+}
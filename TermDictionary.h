@@ -0,0 +1,140 @@
+/*
+ * The MIT License
+ *
+ * Copyright 2017 Theomeli.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+/* 
+ * File:   TermDictionary.h
+ * Author: Theomeli
+ *
+ * Created on October 27, 2026, 9:20 AM
+ */
+
+#ifndef TERMDICTIONARY_H
+#define TERMDICTIONARY_H
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "Lexicon.h"
+
+using namespace std;
+
+/**
+ * the terms of a lexicon in sorted order, built once the index is done, for
+ * the queries which ask for every term beginning with a prefix. The terms are
+ * cut into blocks of BLOCK_SIZE, each starting with a whole term and keeping
+ * of every next one only what differs from the term before: the length of
+ * the prefix they share, the length of the rest and the rest itself, as
+ * variable-byte numbers and bytes. The offsets of the blocks are the index
+ * of the dictionary, searched by the first terms of the blocks, so a lookup
+ * decodes a single block and a prefix decodes only the blocks of its terms.
+ * The ids of the lexicon are kept, with the rank of each term in the order
+ */
+class TermDictionary {
+public:
+    //the number of terms of a block
+    static const size_t BLOCK_SIZE = 16;
+    
+    /**
+     * it sorts the terms of a lexicon and codes them
+     * @param lexicon is the lexicon, whose ids the dictionary keeps
+     */
+    TermDictionary(const Lexicon& lexicon);
+    TermDictionary(const TermDictionary& orig) = delete;
+    TermDictionary& operator =(const TermDictionary& rightSide) = delete;
+    virtual ~TermDictionary();
+    
+    /**
+     * getter for private member nTerms
+     * @return the number of terms of the dictionary
+     */
+     size_t size() const { return nTerms; }
+    
+    /**
+     * it checks if a normalized word asks for the terms beginning with a
+     * prefix, ending with a * after at least one character
+     * @param word is the word
+     * @return true if it is a prefix followed by *
+     */
+    static bool isWildcard(string_view word) { return word.size() > 1 && word.back() == '*'; }
+    
+    /**
+     * it searches for the id of a term
+     * @param term is the term to be searched
+     * @return the id of the term in the lexicon or Lexicon::NOT_FOUND
+     */
+    uint32_t find(string_view term) const;
+    
+    /**
+     * it finds the terms which begin with a prefix
+     * @param prefix is the prefix, without the *
+     * @param termIds is set to the ids of the terms in the lexicon, by
+     * ascending term
+     */
+    void findPrefix(string_view prefix, vector<uint32_t>& termIds) const;
+    
+    /**
+     * getter for the text of a term
+     * @param termId is the id of the term in the lexicon
+     * @param scratch is where the term is decoded
+     * @return a view to the term, valid until scratch changes
+     */
+    string_view getTerm(uint32_t termId, string& scratch) const;
+    
+    /**
+     * it finds the bytes which the dictionary takes
+     * @return the bytes of its coded terms, its index and its ids
+     */
+    size_t getMemoryUsage() const;
+private:
+    //the number of terms
+    size_t									nTerms;
+    //the blocks of the coded terms one after the other
+    vector<uint8_t>								data;
+    //the start of each block in data
+    vector<uint32_t>							blockOffsets;
+    //the id in the lexicon of each term, by rank
+    vector<uint32_t>							termIds;
+    //the rank of each term, by id in the lexicon
+    vector<uint32_t>							ranks;
+    
+    /**
+     * getter for the first term of a block
+     * @param block is the block
+     * @return a view to the term in data
+     */
+    string_view getFirstTerm(size_t block) const;
+    
+    /**
+     * it finds the last block whose first term is less than a term
+     * @param term is the term
+     * @param isEqualTaken is true to take a first term equal to term too
+     * @return the block, 0 if there is none
+     */
+    size_t findBlock(string_view term, bool isEqualTaken) const;
+};
+
+#endif /* TERMDICTIONARY_H */
+
@@ -0,0 +1,158 @@
+/*
+ * The MIT License
+ *
+ * Copyright 2017 Theomeli.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+/* 
+ * File:   TextCodec.cpp
+ * Author: Theomeli
+ * 
+ * Created on October 22, 2026, 10:15 AM
+ */
+
+#include "TextCodec.h"
+#include <algorithm>
+#include <cstring>
+
+/**
+ * it reads 4 bytes which need not be aligned
+ */
+static inline uint32_t load32(const char* p) {
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    
+    return v;
+}
+
+
+void TextCodec::writeLength(size_t length, vector<uint8_t>& out) {
+    for (; length >= 255; length -= 255)
+        out.push_back(255);
+    out.push_back(uint8_t(length));
+}
+
+
+void TextCodec::writeSequence(const char* literals, size_t nLiterals, size_t distance, size_t length, vector<uint8_t>& out) {
+    size_t matchLength = distance == 0 ? 0 : length - MIN_MATCH;
+    out.push_back(uint8_t((min(nLiterals, size_t(15)) << 4) | min(matchLength, size_t(15))));
+    if (nLiterals >= 15)
+        writeLength(nLiterals - 15, out);
+    out.insert(out.end(), literals, literals + nLiterals);
+    if (distance == 0)
+        return;
+    out.push_back(uint8_t(distance));
+    out.push_back(uint8_t(distance >> 8));
+    if (matchLength >= 15)
+        writeLength(matchLength - 15, out);
+}
+
+
+void TextCodec::compress(const char* data, size_t size, vector<uint8_t>& out) {
+    //each slot holds the position after the last one of its hash, 0 if none
+    vector<uint32_t> table(size_t(1) << HASH_BITS, 0);
+    size_t anchor = 0;
+    size_t i = 0;
+    while (i + MIN_MATCH <= size) {
+        uint32_t bytes = load32(data + i);
+        size_t h = (bytes * 2654435761u) >> (32 - HASH_BITS);
+        size_t candidate = table[h];
+        table[h] = uint32_t(i + 1);
+        if (candidate == 0 || i + 1 - candidate > MAX_DISTANCE || load32(data + candidate - 1) != bytes) {
+            i++;
+            continue;
+        }
+        size_t match = candidate - 1;
+        size_t length = MIN_MATCH;
+        while (i + length < size && data[match + length] == data[i + length])
+            length++;
+        writeSequence(data + anchor, i - anchor, i - match, length, out);
+        i += length;
+        anchor = i;
+    }
+    writeSequence(data + anchor, size - anchor, 0, 0, out);
+}
+
+
+bool TextCodec::decompress(const uint8_t* data, size_t size, char* out, size_t rawSize) {
+    const uint8_t* in = data;
+    const uint8_t* end = data + size;
+    size_t position = 0;
+    while (in < end) {
+        uint8_t token = *in++;
+        size_t nLiterals = token >> 4;
+        if (nLiterals == 15) {
+            uint8_t b;
+            do {
+                if (in >= end)
+                    return false;
+                b = *in++;
+                nLiterals += b;
+            } while (b == 255);
+        }
+        if (nLiterals > size_t(end - in) || nLiterals > rawSize - position)
+            return false;
+        //a few literals are copied 16 bytes at once when both sides have room
+        if (nLiterals <= 16 && size_t(end - in) >= 16 && rawSize - position >= 16)
+            memcpy(out + position, in, 16);
+        else
+            memcpy(out + position, in, nLiterals);
+        in += nLiterals;
+        position += nLiterals;
+        //the last sequence has no match
+        if (in == end)
+            break;
+        
+        if (end - in < 2)
+            return false;
+        size_t distance = in[0] | (size_t(in[1]) << 8);
+        in += 2;
+        size_t length = token & 15;
+        if (length == 15) {
+            uint8_t b;
+            do {
+                if (in >= end)
+                    return false;
+                b = *in++;
+                length += b;
+            } while (b == 255);
+        }
+        length += MIN_MATCH;
+        if (distance == 0 || distance > position || length > rawSize - position)
+            return false;
+        //a match may overlap the bytes it writes, repeating them, so it is
+        //copied 8 bytes at a time from at least 8 bytes before when the
+        //output has room for the last copy to run over
+        char* target = out + position;
+        if (distance >= 8 && rawSize - position >= length + 8)
+            for (size_t j = 0; j < length; j += 8)
+                memcpy(target + j, target + j - distance, 8);
+        else if (distance >= length)
+            memcpy(target, target - distance, length);
+        else
+            for (size_t j = 0; j < length; j++)
+                out[position + j] = out[position + j - distance];
+        position += length;
+    }
+    
+    return position == rawSize;
+}
@@ -0,0 +1,100 @@
+/*
+ * The MIT License
+ *
+ * Copyright 2017 Theomeli.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+/* 
+ * File:   TextCodec.h
+ * Author: Theomeli
+ *
+ * Created on October 22, 2026, 10:15 AM
+ */
+
+#ifndef TEXTCODEC_H
+#define TEXTCODEC_H
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+using namespace std;
+
+/**
+ * it compresses text with an LZ77 scheme in the manner of LZ4. The text is
+ * written as sequences, each of some literal bytes followed by a match, a 
+ * copy of MIN_MATCH or more bytes from up to 65535 bytes before. A sequence
+ * starts with a byte holding the number of literals in its high four bits
+ * and the length of the match less MIN_MATCH in its low four, either of which,
+ * when 15, is continued by bytes added to it up to one less than 255. The 
+ * literals follow, then the distance of the match in two bytes, little endian,
+ * and then the rest of its length. The last sequence has literals only. The
+ * matches are found through a table of the last position of each hash of
+ * MIN_MATCH bytes, so compression is a single fast pass and decompression 
+ * only copies bytes
+ */
+class TextCodec {
+public:
+    //the length of the shortest match
+    static const size_t MIN_MATCH = 4;
+    
+    /**
+     * it compresses some bytes, appending them to out
+     * @param data is the start of the bytes
+     * @param size is the number of bytes
+     * @param out is the buffer the compressed bytes are appended to
+     */
+    static void compress(const char* data, size_t size, vector<uint8_t>& out);
+    
+    /**
+     * it decompresses bytes compressed by compress
+     * @param data is the start of the compressed bytes
+     * @param size is the number of compressed bytes
+     * @param out is where the bytes are written
+     * @param rawSize is the number of bytes they were compressed from
+     * @return false if the compressed bytes are corrupted
+     */
+    static bool decompress(const uint8_t* data, size_t size, char* out, size_t rawSize);
+private:
+    //the bits of the hashes of the table of matches
+    static const size_t HASH_BITS = 13;
+    //the greatest distance of a match
+    static const size_t MAX_DISTANCE = 65535;
+    
+    /**
+     * it appends a length to out as the bytes which continue a 4-bit field
+     * @param length is what is left of the length after the field's 15
+     * @param out is the buffer
+     */
+    static void writeLength(size_t length, vector<uint8_t>& out);
+    
+    /**
+     * it appends a sequence to out
+     * @param literals is the start of the literals
+     * @param nLiterals is the number of literals
+     * @param distance is the distance of the match, 0 for the last sequence
+     * @param length is the length of the match
+     * @param out is the buffer
+     */
+    static void writeSequence(const char* literals, size_t nLiterals, size_t distance, size_t length, vector<uint8_t>& out);
+};
+
+#endif /* TEXTCODEC_H */
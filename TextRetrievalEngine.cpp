@@ -31,146 +31,181 @@
 
 #include "TextRetrievalEngine.h"
 
-TextRetrievalEngine::TextRetrievalEngine() {
+TextRetrievalEngine::TextRetrievalEngine(): indexFile(nullptr), queryVersion(0) {
     p = new ProcessFiles;
 }
 
 
-TextRetrievalEngine::TextRetrievalEngine(ProcessFiles* p) {
-    this -> p = new ProcessFiles;
-    *(this->p) = *p;
+TextRetrievalEngine::TextRetrievalEngine(ProcessFiles&& p): indexFile(nullptr), queryVersion(0) {
+    this -> p = new ProcessFiles(move(p));
+    size_t nQueries = this->p->getNQueries(), nDocuments = this->p->getNDocuments();
     
     //initializing frequencies
-    vector<map<string, size_t>> temp1(p->getNQueries() + 1, map<string, size_t>());
-    frequencies[true] = temp1;
-    vector<map<string, size_t>> temp2(p->getNDocuments() + 1, map<string, size_t>());
-    frequencies[false] = temp2;
+    vector<map<uint32_t, size_t>> temp1(nQueries + 1, map<uint32_t, size_t>());
+    frequencies = temp1;
 
-    //initializing weights
-    vector<vector<double>> temp3(p->getNQueries() + 1, vector<double>());
-    weights[true] = temp3;
-    vector<vector<double>> temp4(p->getNDocuments() + 1, vector<double>());
-    weights[false] = temp4;
+    //initializing queries' weights
+    vector<vector<pair<size_t, double>>> temp3(nQueries + 1, vector<pair<size_t, double>>());
+    queryWeights = temp3;
+    vector<double> temp4(nQueries + 1, 0);
+    queryNorms = temp4;
 
     //initializing maxFrequencies
-    vector<size_t> temp5(p->getNQueries() + 1, 1);
+    vector<size_t> temp5(nQueries + 1, 1);
     maxFrequencies[true] = temp5;
-    vector<size_t> temp6(p->getNDocuments() + 1, 1);
+    vector<size_t> temp6(nDocuments + 1, 1);
     maxFrequencies[false] = temp6;
 }
 
 
-TextRetrievalEngine::TextRetrievalEngine(const TextRetrievalEngine& orig)
-    :frequencies(orig.getFrequencies()), maxFrequencies(orig.getMaxFrequencies()) {
-    *(this->p) = *(orig.getP());
-}
-
-
 TextRetrievalEngine::~TextRetrievalEngine() {
     delete p;
 }
 
 
-size_t TextRetrievalEngine::computeFreqOfTerm(const string& term, size_t docId, bool isTermOfQuery) {
-    list<string>::iterator iter;
-    size_t frequency = 0;
-
-    //update frequency for a document term
-    if (!isTermOfQuery) {
-        for (iter = p->getDocumentsTokens()[docId].begin(); iter != p->getDocumentsTokens()[docId].end(); iter++)
-            if (*iter == term)
-                frequency++;
+void TextRetrievalEngine::computeFrequencies(IndexBuilder&& builder) {
+    INSTRUMENT_PHASE(COMPUTE_FREQUENCIES);
+    //take terms of documents and their frequencies, as counted by builder,
+    //moving them instead of copying the pairs of every term
+    vector<vector<pair<size_t, size_t>>> builtFrequencies = builder.releaseTermFrequencies();
+    if (p->getNShards() > 1) {
+	//a shard's terms take the ids of the collection's lexicon
+	const Lexicon& terms = builder.getLexicon();
+	termFrequencies = vector<vector<pair<size_t, size_t>>>(lexicon.size());
+	for (uint32_t termId = 0; termId < terms.size(); termId++) {
+	    uint32_t collectionId = lexicon.find(terms.getTerm(termId));
+	    if (collectionId != Lexicon::NOT_FOUND)
+		termFrequencies[collectionId] = move(builtFrequencies[termId]);
+	}
     }
-    //update frequency for a query term
     else {
-        for (iter = p->getQueriesTokens()[docId].begin(); iter != p->getQueriesTokens()[docId].end(); iter++)
-            if (*iter == term)
-                frequency++;
+	lexicon = builder.releaseLexicon();
+	termFrequencies = move(builtFrequencies);
     }
+    for (auto const &ent1 : builder.getMaxFrequencies())
+        if (ent1.first < maxFrequencies[false].size())
+            maxFrequencies[false][ent1.first] = ent1.second;
+    builder.clear();
     
-    return frequency;
+    computeQueryFrequencies();
 }
 
 
-void TextRetrievalEngine::computeFrequencies() {
-    //initialize frequencies and insert terms of documents
-    size_t nDocuments = p->getNDocuments();
-    list<string>::iterator iter;
-    for (size_t i = 0; i <= nDocuments; i++) 
-        for (iter = p->getDocumentsTokens()[i].begin(); iter != p->getDocumentsTokens()[i].end(); iter++) {
-            frequencies[false][i][*iter] = 0;
-	    terms.insert(*iter);
-        }
-    
-    //initialize frequencies and insert terms of queries
+void TextRetrievalEngine::setCollectionStatistics(const Lexicon& terms, const vector<uint32_t>& documentFrequencies) {
+    lexicon = terms;
+    collectionFrequencies = documentFrequencies;
+}
+
+
+void TextRetrievalEngine::loadIndex(const IndexFile& file) {
+    INSTRUMENT_PHASE(LOAD_INDEX);
+    updatableIndex.reset();
+    addedDocuments.clear();
+    quantizedIndex.reset();
+    positionalIndex.reset();
+    termDictionary.reset();
+    indexFile = &file;
+    file.attach(lexicon, index, documentStore);
+    cache.invalidate();
+    computeQueryFrequencies();
+}
+
+
+bool TextRetrievalEngine::saveIndex(const string& fileName) const {
+    INSTRUMENT_PHASE(SAVE_INDEX);
+    return IndexFile::save(fileName, lexicon, index, indexFile != nullptr ? documentStore : p->getDocuments());
+}
+
+
+void TextRetrievalEngine::computeQueryFrequencies() {
+    //terms which appear only in queries take ids after the documents' terms
     size_t nQueries = p->getNQueries();
     for (size_t i = 0; i <= nQueries; i++) {
-        for (iter = p->getQueriesTokens()[i].begin(); iter != p->getQueriesTokens()[i].end(); iter++) {
-            terms.insert(*iter);
-	    frequencies[true][i][*iter] = 0;
+        for (auto const token : p->getQueriesTokens().getTokens(i)) {
+	    uint32_t termId = lexicon.find(token);
+	    if (termId == Lexicon::NOT_FOUND)
+		termId = lexicon.size() + queryTerms.intern(token);
+	    frequencies[i][termId]++;
 	}
     }
-    
-    for (size_t i = 0; i <= nDocuments; i++)
-        for (iter = p->getDocumentsTokens()[i].begin(); iter != p->getDocumentsTokens()[i].end(); iter++)
-            frequencies[false][i][*iter]++;
-    
-    for (size_t i = 0; i <= nQueries; i++)
-        for (iter = p->getQueriesTokens()[i].begin(); iter != p->getQueriesTokens()[i].end(); iter++)
-	    frequencies[true][i][*iter]++;
 }
 
 
-void TextRetrievalEngine::computeMaxFreq(size_t docId, bool isQuery) {
-    map<string, size_t> myMap =  frequencies[isQuery][docId];
-    
-    for (auto const &ent1 : myMap)
-	maxFrequencies[isQuery][docId] = max(ent1.second, maxFrequencies[isQuery][docId]);
+size_t TextRetrievalEngine::getNDocsWithTerm(size_t termId) const {
+    if (updatableIndex)
+	return updatableIndex->getDocumentFrequency(termId);
+    //a shard's idfs are the ones of the whole collection
+    if (p->getNShards() > 1)
+	return termId < collectionFrequencies.size() ? collectionFrequencies[termId] : 0;
+    //the counts are dropped once the inverted index is built
+    if (termId < termFrequencies.size())
+	return termFrequencies[termId].size();
+    if (termId < index.getNTerms())
+	return index.getDocumentFrequency(termId);
+    return 0;
 }
 
 
-size_t TextRetrievalEngine::getNDocsWithTerm(const string term) {
-    size_t nDocsWithTerm = 0;
-    size_t nDocuments = p->getNDocuments();
-    for (size_t i = 0; i <= nDocuments; i++) {
-	if (frequencies[false][i].find(term) != frequencies[false][i].end()) {
-            nDocsWithTerm++;
-        }
-    }
-    
-    return nDocsWithTerm;
+size_t TextRetrievalEngine::getNDocuments() const {
+    return updatableIndex ? updatableIndex->getNDocuments() : index.getNDocuments();
+}
+
+
+string_view TextRetrievalEngine::getDocument(size_t docId, string& text) const {
+    if (docId > index.getNDocuments())
+	return addedDocuments[docId - index.getNDocuments() - 1];
+    if (indexFile != nullptr)
+	return documentStore.getDocument(docId, text);
+    return p->getDocuments().getDocument(docId, text);
+}
+
+
+void TextRetrievalEngine::computeMaxFreq(size_t queryId) {
+    for (auto const &ent1 : frequencies[queryId])
+	maxFrequencies[true][queryId] = max(ent1.second, maxFrequencies[true][queryId]);
 }
 
 
 void TextRetrievalEngine::initializeIdfs() {
-    vector<double> temp(terms.size() + 1, 0);
-    idfs[true] = temp;
-    idfs[false] = temp;
+    INSTRUMENT_PHASE(INITIALIZE_IDFS);
+    idfs[true] = vector<double>(lexicon.size() + queryTerms.size(), 0);
+    idfs[false] = vector<double>(lexicon.size(), 0);
+}
+
+
+double TextRetrievalEngine::computeIdf(size_t termId, size_t nDocuments) const {
+    double nt = getNDocsWithTerm(termId);
+    //nt == 0 outputs division with zero error
+    if (nt == 0)
+	nt = 1;
+    
+    //a collection of no documents has no idfs
+    if (nDocuments == 0)
+	return 0;
+    
+    return log(double(nDocuments) / nt);
 }
 
 
 void TextRetrievalEngine::computeIdfs(bool isQuery) {
-    size_t nDocuments = p->getNDocuments();
-    size_t i = 1;
-    for (auto const &term : terms) {
-        double nt = getNDocsWithTerm(term);
-	//nt == 0 outputs division with zero error
-	if (nt == 0)
-	    nt = 1;
-	double temp = log(double(nDocuments / nt));
+    size_t nDocuments = isQuery ? getNDocuments() : p->getNDocuments();
+    for (size_t i = 0; i < idfs[isQuery].size(); i++) {
+	double temp = computeIdf(i, nDocuments);
 	if (isQuery == true)
 	    idfs[isQuery][i] = temp;
-	else {
+	//ln(N) is 0 for a single document, whose weights are then all 0
+	else if (nDocuments > 1) {
 	    idfs[isQuery][i] = temp / log(nDocuments); 
 	    temp = temp / log(nDocuments);
 	}
-        i++;
+	else
+	    idfs[isQuery][i] = 0;
     }
 }
 
 
-double TextRetrievalEngine::computeNormalizedFreq(const string term, const size_t documentId, bool isTermOfQuery) {
-    double result = computeFreqOfTerm(term, documentId, isTermOfQuery) / double(maxFrequencies[isTermOfQuery][documentId]);
+double TextRetrievalEngine::computeNormalizedFreq(size_t frequency, const size_t documentId, bool isTermOfQuery) {
+    double result = frequency / double(maxFrequencies[isTermOfQuery][documentId]);
     if (!isTermOfQuery)
         return result;
     else
@@ -178,97 +213,1047 @@ double TextRetrievalEngine::computeNormalizedFreq(const string term, const size_
 }
 
 
-void TextRetrievalEngine::computeDocWeight(const size_t documentId, bool isQuery) {
-    size_t i = 1;
-    for (auto const &term : terms) {
-	weights[isQuery][documentId].push_back(computeNormalizedFreq(term, documentId, isQuery) * idfs[isQuery][i]);
-	i++;
+void TextRetrievalEngine::computeDocWeight(const size_t queryId) {
+    //frequencies are sorted by term id, so the ids are visited in ascending order
+    for (auto const &ent1 : frequencies[queryId]) {
+	size_t termId = ent1.first;
+	double weight = computeNormalizedFreq(ent1.second, queryId, true) * idfs[true][termId];
+	queryWeights[queryId].push_back(make_pair(termId, weight));
+	queryNorms[queryId] += weight * weight;
     }
+    queryNorms[queryId] = sqrt(queryNorms[queryId]);
+}
+
+
+void TextRetrievalEngine::addTermPostings(const size_t termId) {
+    for (auto const &ent1 : termFrequencies[termId])
+	index.addPosting(termId, ent1.first, ent1.second);
 }
 
 
 void TextRetrievalEngine::computeDocsWeight(bool isQuery) {
+    INSTRUMENT_PHASE(Phase(isQuery ? Instrumentation::COMPUTE_QUERY_WEIGHTS : Instrumentation::BUILD_INDEX));
     computeIdfs(isQuery);
 
-    for (size_t i = 1; i < weights[isQuery].size(); i++) {
-	computeMaxFreq(i, isQuery);
-	computeDocWeight(i, isQuery);
+    if (isQuery) {
+	for (size_t i = 1; i <= p->getNQueries(); i++) {
+	    queryWeights[i].clear();
+	    queryNorms[i] = 0;
+	    computeMaxFreq(i);
+	    computeDocWeight(i);
+	}
+    }
+    else {
+	updatableIndex.reset();
+	addedDocuments.clear();
+	quantizedIndex.reset();
+	positionalIndex.reset();
+	termDictionary.reset();
+	index = InvertedIndex(lexicon.size(), p->getNDocuments());
+	for (size_t i = 0; i < lexicon.size(); i++)
+	    addTermPostings(i);
+	index.setIdfs(idfs[false]);
+	index.setMaxFrequencies(maxFrequencies[false]);
+	index.finish();
+	termFrequencies = vector<vector<pair<size_t, size_t>>>();
+	cache.invalidate();
     }
 }
 
 
-double TextRetrievalEngine::computeLength(vector<double> aVector) {
-    double result = 0;
-    vector<double>::iterator iter;
-    for (iter = aVector.begin(); iter != aVector.end(); iter++)
-	result += pow(*iter, 2);
+vector<pair<size_t, double>> TextRetrievalEngine::getSortedSimilarities(const vector<pair<size_t, double>>& terms, 
+    double queryNorm, size_t nResponses) const {
+    //the bounds are widened a little, so that the rounding of a sum
+    //never drops a document which enters the heap
+    const double slack = 1 + 1e-9;
+    size_t nDocuments = index.getNDocuments();
+    nResponses = min(nResponses, nDocuments);
+    vector<pair<size_t, double>> result;
+    if (nResponses == 0)
+	return result;
+
+    //the terms of the query with postings, by term id, and the sum of
+    //their bounds over all the documents
+    vector<size_t> termIds;
+    vector<double> weights;
+    vector<PostingsCursor> cursors;
+    double total = 0;
+    for (auto const &ent1 : terms) {
+	if (queryNorm > 0 && ent1.second > 0 && ent1.first < index.getNTerms() && index.getDocumentFrequency(ent1.first) > 0) {
+	    termIds.push_back(ent1.first);
+	    weights.push_back(ent1.second);
+	    cursors.push_back(index.getCursor(ent1.first));
+	    total += ent1.second * index.getMaxImpact(ent1.first) / queryNorm * slack;
+	}
+    }
+    size_t nTerms = termIds.size();
+
+    //the documents are scored a window of ids at a time. In a window the terms
+    //are ordered by their bounds there and the ones before essential, whose
+    //bounds sum to no more than the heap's least cosine once it is full, cannot
+    //bring a document into the heap on their own
+    const size_t windowSize = 1024;
+    double threshold = 0;
+    vector<double> bounds(nTerms), sums(nTerms + 1, 0);
+    vector<size_t> order(nTerms), ranks(nTerms);
+    //the essential lists are read term at a time to the partial dot products
+    //of the window's documents and their postings are kept until the window's
+    //documents are scored
+    vector<double> partials(windowSize, 0);
+    vector<char> isCandidate(windowSize, 0);
+    vector<vector<pair<uint32_t, uint32_t>>> windowPostings(nTerms);
+    vector<size_t> positions(nTerms);
+    vector<double> contributions(nTerms, 0);
+    //the work done, counted for the instrumentation
+    size_t nScanned = 0, nScored = 0, nHeapOperations = 0;
+    uint64_t windowStart = 1;
+    while (total > threshold) {
+	//the window starts at the least document of the lists after the previous one
+	uint64_t first = PostingsCursor::END;
+	for (size_t t = 0; t < nTerms; t++)
+	    if (cursors[t].nextBlock(windowStart))
+		first = min(first, max(windowStart, uint64_t(cursors[t].getDocId())));
+	if (first == PostingsCursor::END)
+	    break;
+	windowStart = first;
+	uint64_t windowEnd = windowStart + windowSize;
+
+	//a term's bound in the window is the greatest impact of its blocks there
+	for (size_t t = 0; t < nTerms; t++) {
+	    order[t] = t;
+	    bounds[t] = cursors[t].getDocId() == PostingsCursor::END ? 0 
+		: weights[t] * cursors[t].getMaxImpact(windowEnd - 1) / queryNorm * slack;
+	}
+	sort(order.begin(), order.end(), [&bounds](size_t a, size_t b) { return bounds[a] < bounds[b]; });
+	for (size_t i = 0; i < nTerms; i++) {
+	    sums[i + 1] = sums[i] + bounds[order[i]];
+	    ranks[order[i]] = i;
+	}
+	size_t essential = 0;
+	while (essential < nTerms && sums[essential + 1] <= threshold)
+	    essential++;
+
+	//probing the non essential lists for each document costs more than
+	//reading them when they are few, then all the lists are read
+	if (essential * 2 < nTerms)
+	    essential = 0;
+
+	//the essential lists are read by term id, so a document found in none of
+	//the others has its dot product summed in the order of an exhaustive pass
+	for (size_t t = 0; t < nTerms; t++) {
+	    if (ranks[t] < essential)
+		continue;
+	    PostingsCursor& cursor = cursors[t];
+	    windowPostings[t].clear();
+	    positions[t] = 0;
+	    cursor.nextGeq(windowStart);
+	    const uint32_t* ids;
+	    const uint32_t* values;
+	    for (size_t n = cursor.getRun(windowEnd, ids, values); n > 0; n = cursor.getRun(windowEnd, ids, values)) {
+		nScanned += n;
+		for (size_t k = 0; k < n; k++) {
+		    if (essential > 0)
+			windowPostings[t].push_back(make_pair(ids[k], values[k]));
+		    partials[ids[k] - windowStart] += weights[t] * index.getWeight(termIds[t], ids[k], values[k]);
+		    isCandidate[ids[k] - windowStart] = 1;
+		}
+		cursor.advance(n);
+	    }
+	}
+
+	for (size_t w = 0; w < windowSize && essential < nTerms; w++) {
+	    if (!isCandidate[w])
+		continue;
+	    uint32_t docId = windowStart + w;
+	    double partial = partials[w];
+	    isCandidate[w] = 0;
+	    partials[w] = 0;
+	    //a document with no weights has cosine 0
+	    double scale = queryNorm * index.getNorm(docId);
+	    if (scale == 0)
+		continue;
+
+	    //the non essential lists are probed from the greatest bound down, each
+	    //bounded first by its block which would hold the document
+	    double bound = partial / scale * slack + sums[essential];
+	    bool isFound = false;
+	    for (size_t i = 0; i < essential; i++)
+		contributions[order[i]] = 0;
+	    for (size_t i = essential; i-- > 0 && bound > threshold; ) {
+		size_t t = order[i];
+		PostingsCursor& cursor = cursors[t];
+		if (cursor.nextBlock(docId)) {
+		    bound = partial / scale * slack + weights[t] * cursor.getBlockMaxImpact() / queryNorm * slack + sums[i];
+		    if (bound <= threshold)
+			break;
+		    cursor.nextGeq(docId);
+		    nScanned++;
+		    if (cursor.getDocId() == docId) {
+			contributions[t] = weights[t] * index.getWeight(termIds[t], docId, cursor.getFrequency());
+			partial += contributions[t];
+			isFound = true;
+		    }
+		}
+		bound = partial / scale * slack + sums[i];
+	    }
+	    if (bound <= threshold)
+		continue;
 
-    return sqrt(result);
+	    //the dot product summed again by term id, when the non essential
+	    //lists added to it
+	    double dot = 0;
+	    for (size_t t = 0; t < nTerms && isFound; t++) {
+		if (ranks[t] < essential) {
+		    dot += contributions[t];
+		    continue;
+		}
+		const vector<pair<uint32_t, uint32_t>>& postings = windowPostings[t];
+		while (positions[t] < postings.size() && postings[positions[t]].first < docId)
+		    positions[t]++;
+		if (positions[t] < postings.size() && postings[positions[t]].first == docId)
+		    dot += weights[t] * index.getWeight(termIds[t], docId, postings[positions[t]].second);
+	    }
+	    if (!isFound)
+		dot = partial;
+	    double cosine = dot / (queryNorm * index.getNorm(docId));
+	    nScored++;
+	    //documents come by ascending id, so one with the least cosine of
+	    //the heap would come after all the documents in it
+	    if (!(cosine > threshold))
+		continue;
+	    result.push_back(make_pair(docId, cosine));
+	    push_heap(result.begin(), result.end(), Compare());
+	    nHeapOperations++;
+	    if (result.size() > nResponses) {
+		pop_heap(result.begin(), result.end(), Compare());
+		result.pop_back();
+		nHeapOperations++;
+	    }
+	    if (result.size() == nResponses)
+		threshold = result.front().second;
+	}
+	windowStart = windowEnd;
+    }
+    INSTRUMENT_COUNT(POSTINGS_SCANNED, nScanned);
+    INSTRUMENT_COUNT(DOCUMENTS_SCORED, nScored);
+    INSTRUMENT_COUNT(HEAP_OPERATIONS, nHeapOperations);
+
+    completeResults(result, nResponses);
+
+    return result;
 }
 
 
-double TextRetrievalEngine::computeCosine(vector<double> query, vector<double> document) {
-    double result = 0;
-    for (size_t i = 1; i < query.size(); i++) {
-	result += query[i] * document[i];
+vector<vector<pair<size_t, double>>> TextRetrievalEngine::getBatchSimilarities(const vector<size_t>& queryIds, 
+    const vector<size_t>& nResponses, vector<double>& accumulators) const {
+    size_t nDocuments = index.getNDocuments();
+    size_t batchSize = queryIds.size();
+    INSTRUMENT_PHASE(EVALUATE_BATCH);
+    vector<vector<pair<size_t, double>>> results(batchSize);
+
+    //the terms of the batch with postings, each with the positions in the
+    //batch of the queries which contain it and its weights in them
+    vector<pair<size_t, pair<uint32_t, double>>> entries;
+    for (size_t q = 0; q < batchSize; q++) {
+	if (nResponses[q] == 0 || queryNorms[queryIds[q]] == 0)
+	    continue;
+	for (auto const &ent1 : queryWeights[queryIds[q]])
+	    if (ent1.second > 0 && ent1.first < index.getNTerms() && index.getDocumentFrequency(ent1.first) > 0)
+		entries.push_back(make_pair(ent1.first, make_pair(uint32_t(q), ent1.second)));
+    }
+    sort(entries.begin(), entries.end());
+    vector<size_t> termIds, starts;
+    vector<uint32_t> slots;
+    vector<double> weights;
+    vector<PostingsCursor> cursors;
+    for (size_t i = 0; i < entries.size(); i++) {
+	if (i == 0 || entries[i].first != entries[i - 1].first) {
+	    termIds.push_back(entries[i].first);
+	    starts.push_back(i);
+	    cursors.push_back(index.getCursor(entries[i].first));
+	}
+	slots.push_back(entries[i].second.first);
+	weights.push_back(entries[i].second.second);
+    }
+    starts.push_back(entries.size());
+    size_t nTerms = termIds.size();
+
+    //the documents are scored a window of ids at a time, the accumulators
+    //of a document's queries one next to the other, so that the window's
+    //accumulators stay in the cache while all the lists are read
+    size_t windowSize = max(size_t(256), 32768 / batchSize);
+    accumulators.assign(windowSize * batchSize, 0);
+    vector<char> isTouched(windowSize, 0);
+    vector<double> thresholds(batchSize, 0);
+    //the work done, counted for the instrumentation
+    size_t nScanned = 0, nScored = 0, nHeapOperations = 0;
+    uint64_t windowStart = 1;
+    while (true) {
+	//the window starts at the least document of the lists after the previous one
+	uint64_t first = PostingsCursor::END;
+	for (size_t t = 0; t < nTerms; t++)
+	    first = min(first, uint64_t(cursors[t].getDocId()));
+	if (first == PostingsCursor::END)
+	    break;
+	windowStart = first;
+	uint64_t windowEnd = windowStart + windowSize;
+
+	//each list is read once for all the queries of the batch, by term id,
+	//so that the dot products are summed in the order of a single query
+	for (size_t t = 0; t < nTerms; t++) {
+	    PostingsCursor& cursor = cursors[t];
+	    const uint32_t* ids;
+	    const uint32_t* values;
+	    for (size_t n = cursor.getRun(windowEnd, ids, values); n > 0; n = cursor.getRun(windowEnd, ids, values)) {
+		nScanned += n;
+		for (size_t k = 0; k < n; k++) {
+		    double weight = index.getWeight(termIds[t], ids[k], values[k]);
+		    size_t w = ids[k] - windowStart;
+		    double* row = accumulators.data() + w * batchSize;
+		    isTouched[w] = 1;
+		    for (size_t s = starts[t]; s < starts[t + 1]; s++)
+			row[slots[s]] += weights[s] * weight;
+		}
+		cursor.advance(n);
+	    }
+	}
+
+	for (size_t w = 0; w < windowSize; w++) {
+	    if (!isTouched[w])
+		continue;
+	    isTouched[w] = 0;
+	    uint32_t docId = windowStart + w;
+	    double* row = accumulators.data() + w * batchSize;
+	    //a document with no weights has cosine 0
+	    double norm = index.getNorm(docId);
+	    for (size_t q = 0; q < batchSize; q++) {
+		if (row[q] == 0)
+		    continue;
+		double cosine = row[q] / (queryNorms[queryIds[q]] * norm);
+		nScored++;
+		row[q] = 0;
+		if (norm == 0 || !(cosine > thresholds[q]))
+		    continue;
+		vector<pair<size_t, double>>& result = results[q];
+		result.push_back(make_pair(docId, cosine));
+		push_heap(result.begin(), result.end(), Compare());
+		nHeapOperations++;
+		if (result.size() > nResponses[q]) {
+		    pop_heap(result.begin(), result.end(), Compare());
+		    result.pop_back();
+		    nHeapOperations++;
+		}
+		if (result.size() == nResponses[q])
+		    thresholds[q] = result.front().second;
+	    }
+	}
+	windowStart = windowEnd;
     }
+    INSTRUMENT_COUNT(POSTINGS_SCANNED, nScanned);
+    INSTRUMENT_COUNT(DOCUMENTS_SCORED, nScored);
+    INSTRUMENT_COUNT(HEAP_OPERATIONS, nHeapOperations);
+    INSTRUMENT_COUNT(QUERIES_EVALUATED, batchSize);
+
+    for (size_t q = 0; q < batchSize; q++)
+	completeResults(results[q], min(nResponses[q], nDocuments));
 
-    return result / (computeLength(query) * computeLength(document));
+    return results;
 }
 
 
-priority_queue<pair<size_t, double>, vector<pair<size_t, double>>, Compare> TextRetrievalEngine::getSortedSimilarities(size_t queryId, size_t nResponses) {
-    vector<double> temp(p->getNDocuments() + 1, 0);
+vector<pair<size_t, double>> TextRetrievalEngine::getSegmentedSimilarities(const vector<pair<size_t, double>>& terms, 
+    double queryNorm, size_t nResponses) const {
+    const SegmentedIndex& updates = *updatableIndex;
+    nResponses = min(nResponses, updates.getNDocuments());
+    vector<pair<size_t, double>> result;
+    if (nResponses == 0)
+	return result;
 
-    //it stores all the cosines between query with queryId and documents of the collection
-    for (size_t i = 1; i <= p->getNDocuments(); i++) {
-	temp[i] = computeCosine(weights[true][queryId], weights[false][i]);
+    //the lists are read by term id, those of the inverted index before the
+    //segments', so the dot products are summed in the order of an index built
+    //from the live documents. The bounds of the inverted index's blocks do not
+    //follow the changes of the idfs, so no document is skipped by them
+    vector<double> accumulators(updates.getMaxDocId() + 1, 0);
+    shared_ptr<const vector<shared_ptr<const Segment>>> segments = updates.getSegments();
+    //the work done, counted for the instrumentation
+    size_t nScanned = 0, nScored = 0, nHeapOperations = 0;
+    for (auto const &ent1 : terms) {
+	if (queryNorm == 0 || ent1.second <= 0 || updates.getDocumentFrequency(ent1.first) == 0)
+	    continue;
+	double idf = updates.getIdf(ent1.first);
+	if (ent1.first < index.getNTerms())
+	    for (PostingsCursor cursor = index.getCursor(ent1.first); cursor.getDocId() != PostingsCursor::END; cursor.next()) {
+		nScanned++;
+		uint32_t docId = cursor.getDocId();
+		if (!updates.isDeleted(docId))
+		    accumulators[docId] += ent1.second * (cursor.getFrequency() / double(updates.getMaxFrequency(docId)) * idf);
+	    }
+	for (auto const &segment : *segments) {
+	    size_t i = segment->find(ent1.first);
+	    if (i == segment->getNTerms())
+		continue;
+	    for (PostingsCursor cursor = segment->getCursorAt(i); cursor.getDocId() != PostingsCursor::END; cursor.next()) {
+		nScanned++;
+		uint32_t docId = cursor.getDocId();
+		if (!updates.isDeleted(docId))
+		    accumulators[docId] += ent1.second * (cursor.getFrequency() / double(updates.getMaxFrequency(docId)) * idf);
+	    }
+	}
     }
 
-    //it makes pairs of term id and its associated weight ordered by the weight
-    priority_queue<pair<size_t, double>, vector<pair<size_t, double>>, Compare> temp1;
-    for (size_t i = 1; i < temp.size(); i++) {
-	pair<size_t, double> p = make_pair(i, temp[i]);
-	temp1.push(p);
+    double threshold = 0;
+    for (size_t docId = 1; docId < accumulators.size(); docId++) {
+	//a document with no weights has cosine 0
+	double norm = updates.getNorm(docId);
+	if (accumulators[docId] == 0 || norm == 0)
+	    continue;
+	double cosine = accumulators[docId] / (queryNorm * norm);
+	nScored++;
+	if (!(cosine > threshold))
+	    continue;
+	result.push_back(make_pair(docId, cosine));
+	push_heap(result.begin(), result.end(), Compare());
+	nHeapOperations++;
+	if (result.size() > nResponses) {
+	    pop_heap(result.begin(), result.end(), Compare());
+	    result.pop_back();
+	    nHeapOperations++;
+	}
+	if (result.size() == nResponses)
+	    threshold = result.front().second;
     }
+    INSTRUMENT_COUNT(POSTINGS_SCANNED, nScanned);
+    INSTRUMENT_COUNT(DOCUMENTS_SCORED, nScored);
+    INSTRUMENT_COUNT(HEAP_OPERATIONS, nHeapOperations);
+    completeResults(result, nResponses);
+
+    return result;
+}
 
-    //it pushes nResponses pairs to a queue named result
-    priority_queue<pair<size_t, double>, vector<pair<size_t, double>>, Compare> result;
-    for (size_t i = 0; i < nResponses; i++) {
-	result.push(temp1.top());
-	temp1.pop();
+
+vector<pair<size_t, double>> TextRetrievalEngine::getQuantizedSimilarities(const vector<pair<size_t, double>>& terms, 
+    double queryNorm, size_t nResponses) const {
+    const QuantizedIndex& quantized = *quantizedIndex;
+    size_t nDocuments = quantized.getNDocuments();
+    nResponses = min(nResponses, nDocuments);
+    vector<pair<size_t, double>> result;
+    if (nResponses == 0)
+	return result;
+
+    //a term's weight times its greatest impact is the most it adds
+    //to a cosine, and the greatest of them takes the top step
+    vector<size_t> termIds;
+    vector<double> weights;
+    double greatest = 0;
+    for (auto const &ent1 : terms)
+	if (queryNorm > 0 && ent1.second > 0 && ent1.first < index.getNTerms() && quantized.getScale(ent1.first) > 0) {
+	    termIds.push_back(ent1.first);
+	    weights.push_back(ent1.second * quantized.getScale(ent1.first));
+	    greatest = max(greatest, weights.back());
+	}
+    size_t nTerms = termIds.size();
+    uint64_t steps = nTerms == 0 ? 0 : min(uint64_t(65535), uint64_t(UINT32_MAX) / (nTerms * quantized.getLevels()));
+    //the sums of a long query, such as a prefix of many terms, could only
+    //stay within 32 bits by flattening its weights
+    if (nTerms > 0 && steps < QuantizedIndex::MIN_QUERY_STEPS)
+	return getSortedSimilarities(terms, queryNorm, nResponses);
+    vector<uint32_t> levels(nTerms);
+    vector<PostingsCursor> cursors;
+    for (size_t i = 0; i < nTerms; i++) {
+	levels[i] = max(uint32_t(1), uint32_t(lround(weights[i] / greatest * steps)));
+	cursors.push_back(quantized.getCursor(termIds[i]));
     }
+    //a sum of the products stands for this fraction of a cosine
+    double unit = nTerms == 0 ? 0 : greatest / (double(steps) * quantized.getLevels() * queryNorm);
+
+    //each thread keeps its accumulators from query to query
+    const size_t windowSize = 1 << 16;
+    thread_local vector<uint32_t> accumulators;
+    accumulators.resize(windowSize);
+    uint32_t threshold = 0;
+    //the work done, counted for the instrumentation
+    size_t nScanned = 0, nScored = 0, nHeapOperations = 0;
+    for (size_t start = 1; start <= nDocuments && nTerms > 0; start += windowSize) {
+	uint64_t end = min(start + windowSize, nDocuments + 1);
+	fill(accumulators.begin(), accumulators.begin() + (end - start), 0);
+	for (size_t i = 0; i < nTerms; i++) {
+	    PostingsCursor& cursor = cursors[i];
+	    while (cursor.getDocId() < end) {
+		const uint32_t* ids;
+		const uint32_t* values;
+		size_t n = cursor.getRun(end, ids, values);
+		for (size_t j = 0; j < n; j++)
+		    accumulators[ids[j] - start] += levels[i] * (values[j] - 1);
+		nScanned += n;
+		cursor.advance(n);
+	    }
+	}
+	
+	//the heap holds the sums until the end. The documents are visited by 
+	//ascending id, so one whose sum equals the heap's least cannot enter it
+	for (size_t docId = start; docId < end; docId++) {
+	    uint32_t sum = accumulators[docId - start];
+	    if (sum == 0)
+		continue;
+	    nScored++;
+	    if (result.size() == nResponses && sum <= threshold)
+		continue;
+	    result.push_back(make_pair(docId, double(sum)));
+	    push_heap(result.begin(), result.end(), Compare());
+	    nHeapOperations++;
+	    if (result.size() > nResponses) {
+		pop_heap(result.begin(), result.end(), Compare());
+		result.pop_back();
+		nHeapOperations++;
+	    }
+	    if (result.size() == nResponses)
+		threshold = uint32_t(result.front().second);
+	}
+    }
+    for (auto &ent1 : result)
+	ent1.second *= unit;
+    INSTRUMENT_COUNT(POSTINGS_SCANNED, nScanned);
+    INSTRUMENT_COUNT(DOCUMENTS_SCORED, nScored);
+    INSTRUMENT_COUNT(HEAP_OPERATIONS, nHeapOperations);
+    completeResults(result, nResponses);
 
     return result;
 }
 
 
-void TextRetrievalEngine::displayResults() {
-    for (size_t i = 1; i <= p->getNQueries(); i++) {
-	size_t nResponses = p->getNResponses()[i];
-	cout << "Query to search: " << endl;
-	list<string>::iterator iter;
-	//it displays the query with id i
-	for (iter = p->getQueriesTokens()[i].begin(); iter != p->getQueriesTokens()[i].end(); iter++)
-	    cout << *iter << ' ';
-	cout << endl << "===================" << endl;
-	cout << "Returned documents:";
-	cout << endl << "===================" << endl;
-	priority_queue<pair<size_t, double>, vector<pair<size_t, double>>, Compare> simularities = getSortedSimilarities(i, nResponses);
-	size_t size = simularities.size();
-	for (size_t k = 0; k < size; k++) {
-	    size_t docSize = 0;
-	    pair<size_t, double> aPair = simularities.top();
-	    simularities.pop();
-	    //it displays the documents resulted from the call of getSortedSimilarities
-	    //also stores document's size and use it for a formatted display
-	    for (iter = p->getDocumentsTokens()[aPair.first].begin(); iter != p->getDocumentsTokens()[aPair.first].end(); iter++) {
-		cout << *iter << ' ';
-		docSize += iter->size();
-		docSize++;
+void TextRetrievalEngine::completeResults(vector<pair<size_t, double>>& result, size_t nResponses) const {
+    //the documents which share no term with the query follow with cosine 0
+    if (result.size() < nResponses) {
+	vector<size_t> found;
+	for (auto const &ent1 : result)
+	    found.push_back(ent1.first);
+	sort(found.begin(), found.end());
+	size_t firstDocId = p->getNShards() > 1 ? p->getFirstDocId() : 1;
+	size_t maxDocId = updatableIndex ? updatableIndex->getMaxDocId() : index.getNDocuments();
+	if (p->getNShards() > 1)
+	    maxDocId = min(maxDocId, p->getLastDocId());
+	for (size_t docId = firstDocId; docId <= maxDocId && result.size() < nResponses; docId++)
+	    if (!binary_search(found.begin(), found.end(), docId) && !(updatableIndex && updatableIndex->isDeleted(docId)))
+		result.push_back(make_pair(docId, 0.0));
+    }
+    sort(result.begin(), result.end(), Compare());
+}
+
+
+vector<pair<uint32_t, uint32_t>> TextRetrievalEngine::countTerms(string_view text, string& normalized) {
+    //the tokens are normalized and given ids as the ones of the files
+    map<uint32_t, uint32_t> counts;
+    string scratch;
+    size_t position = 0;
+    string_view token;
+    while (ProcessFiles::nextToken(text, position, text.size(), token)) {
+	token = TokenNormalizer::normalize(token, scratch);
+	uint32_t termId = lexicon.find(token);
+	if (termId == Lexicon::NOT_FOUND)
+	    termId = lexicon.size() + queryTerms.intern(token);
+	counts[termId]++;
+	normalized += token;
+	normalized += ' ';
+    }
+    
+    return vector<pair<uint32_t, uint32_t>>(counts.begin(), counts.end());
+}
+
+
+size_t TextRetrievalEngine::addDocument(string_view text) {
+    INSTRUMENT_PHASE(ADD_DOCUMENT);
+    if (!updatableIndex)
+	updatableIndex.reset(new SegmentedIndex(index));
+    
+    string normalized;
+    size_t docId = updatableIndex->addDocument(countTerms(text, normalized));
+    addedDocuments.push_back(normalized);
+    cache.invalidate();
+    
+    return docId;
+}
+
+
+void TextRetrievalEngine::quantize(unsigned bits) {
+    if (bits == 0)
+	quantizedIndex.reset();
+    else
+	quantizedIndex.reset(new QuantizedIndex(index, bits));
+    cache.invalidate();
+}
+
+
+void TextRetrievalEngine::indexPositions() {
+    INSTRUMENT_PHASE(INDEX_POSITIONS);
+    size_t nDocuments = index.getNDocuments();
+    positionalIndex.reset(new PositionalIndex(lexicon.size(), nDocuments));
+    //the stored text holds the normalized tokens, so a token's
+    //position is its rank there
+    string text;
+    vector<uint32_t> termIds;
+    for (size_t docId = 1; docId <= nDocuments; docId++) {
+	string_view document = getDocument(docId, text);
+	termIds.clear();
+	size_t position = 0;
+	string_view token;
+	while (ProcessFiles::nextToken(document, position, document.size(), token))
+	    termIds.push_back(lexicon.find(token));
+	positionalIndex->addDocument(docId, termIds);
+    }
+    positionalIndex->finish();
+}
+
+
+void TextRetrievalEngine::buildDictionary() {
+    INSTRUMENT_PHASE(BUILD_DICTIONARY);
+    termDictionary.reset(new TermDictionary(lexicon));
+}
+
+
+bool TextRetrievalEngine::deleteDocument(size_t docId) {
+    if (!updatableIndex)
+	updatableIndex.reset(new SegmentedIndex(index));
+    if (docId == 0 || docId > updatableIndex->getMaxDocId() || updatableIndex->isDeleted(docId))
+	return false;
+    
+    //the terms whose documents' frequencies drop are read from the stored text
+    string text, normalized;
+    if (!updatableIndex->deleteDocument(docId, countTerms(getDocument(docId, text), normalized)))
+	return false;
+    cache.invalidate();
+    
+    return true;
+}
+
+
+void TextRetrievalEngine::refreshWeights() {
+    //the idfs of the queries follow the changes of the documents
+    if (updatableIndex && updatableIndex->getVersion() != queryVersion) {
+	updatableIndex->refresh();
+	initializeIdfs();
+	computeDocsWeight(true);
+	queryVersion = updatableIndex->getVersion();
+    }
+}
+
+
+void TextRetrievalEngine::computeResults(QueryExecutor& executor, size_t batchSize, ResultWriter* writer) {
+    INSTRUMENT_PHASE(COMPUTE_RESULTS);
+    size_t nQueries = p->getNQueries();
+    map<size_t, size_t> nResponses = p->getNResponses();
+    vector<vector<pair<size_t, double>>> temp(nQueries + 1, vector<pair<size_t, double>>());
+    results = temp;
+    vector<string> keys(nQueries + 1);
+    vector<size_t> counts(nQueries + 1, 0);
+    for (size_t queryId = 1; queryId <= nQueries; queryId++) {
+	map<size_t, size_t>::const_iterator k = nResponses.find(queryId);
+	counts[queryId] = k == nResponses.end() ? 0 : k->second;
+	TokenArena::Tokens tokens = p->getQueriesTokens().getTokens(queryId);
+	keys[queryId] = ResultCache::makeKey(vector<string>(tokens.begin(), tokens.end()));
+    }
+    //the generation is taken first, so that results of an index
+    //which changes meanwhile are not kept
+    uint64_t generation = cache.getGeneration();
+    
+    refreshWeights();
+    
+    //the writer waits for the queries in id order, each marked
+    //ready once its results are stored
+    vector<char> isReady(nQueries + 1, 0);
+    mutex readyLock;
+    condition_variable readied;
+    auto markReady = [&](size_t queryId) {
+	{
+	    lock_guard<mutex> guard(readyLock);
+	    isReady[queryId] = 1;
+	}
+	readied.notify_one();
+    };
+    thread output;
+    if (writer != nullptr)
+	output = thread([&]() {
+	    INSTRUMENT_PHASE(WRITE_RESULTS);
+	    for (size_t queryId = 1; queryId <= nQueries; queryId++) {
+		{
+		    unique_lock<mutex> guard(readyLock);
+		    readied.wait(guard, [&]() { return isReady[queryId] != 0; });
+		}
+		writeQueryResults(*writer, queryId);
+	    }
+	    writer->flush();
+	});
+    
+    if (batchSize <= 1 || updatableIndex || quantizedIndex) {
+	//task i stands for the query with id i + 1
+	executor.run(nQueries, [&](size_t task, size_t /*worker*/) {
+	    size_t queryId = task + 1;
+	    if (!cache.find(keys[queryId], counts[queryId], results[queryId])) {
+		results[queryId] = evaluateQuery(queryId, counts[queryId]);
+		cache.insert(keys[queryId], counts[queryId], results[queryId], generation);
 	    }
-	    cout << setw(70 - docSize) << "(with weight " << aPair.second << ')' << endl; 
-        }
-        cout << endl;
+	    markReady(queryId);
+	});
+	if (output.joinable())
+	    output.join();
+	return;
+    }
+    
+    //the queries which miss the cache are evaluated once for each set of
+    //terms, for the most documents asked for it, and the others take the
+    //first of its results
+    unordered_map<string, size_t> firsts;
+    vector<size_t> representatives(nQueries + 1, 0);
+    vector<size_t> pending;
+    for (size_t queryId = 1; queryId <= nQueries; queryId++) {
+	if (cache.find(keys[queryId], counts[queryId], results[queryId])) {
+	    markReady(queryId);
+	    continue;
+	}
+	pair<unordered_map<string, size_t>::iterator, bool> found = firsts.emplace(keys[queryId], queryId);
+	representatives[queryId] = found.first->second;
+	if (found.second)
+	    pending.push_back(queryId);
+    }
+    vector<size_t> batchCounts(nQueries + 1, 0);
+    //the queries which take the results of each evaluated one
+    vector<vector<size_t>> followers(nQueries + 1);
+    for (size_t queryId = 1; queryId <= nQueries; queryId++)
+	if (representatives[queryId] != 0) {
+	    batchCounts[representatives[queryId]] = max(batchCounts[representatives[queryId]], counts[queryId]);
+	    followers[representatives[queryId]].push_back(queryId);
+	}
+    
+    //the queries whose longest lists are the same are put in the same
+    //batches, so that the lists which cost the most are read the fewest times
+    vector<size_t> longest(nQueries + 1, 0);
+    for (auto const queryId : pending) {
+	size_t length = 0;
+	for (auto const &ent1 : queryWeights[queryId])
+	    if (ent1.first < index.getNTerms() && index.getDocumentFrequency(ent1.first) > length) {
+		length = index.getDocumentFrequency(ent1.first);
+		longest[queryId] = ent1.first;
+	    }
+    }
+    stable_sort(pending.begin(), pending.end(), [&longest](size_t a, size_t b) { return longest[a] < longest[b]; });
+    
+    //each worker keeps its accumulators from batch to batch
+    vector<vector<double>> accumulators(executor.getNThreads());
+    size_t nBatches = (pending.size() + batchSize - 1) / batchSize;
+    executor.run(nBatches, [&](size_t task, size_t worker) {
+	vector<size_t> queryIds(pending.begin() + task * batchSize, pending.begin() + min(pending.size(), (task + 1) * batchSize));
+	vector<size_t> batchResponses;
+	for (auto const queryId : queryIds)
+	    batchResponses.push_back(batchCounts[queryId]);
+	vector<vector<pair<size_t, double>>> batch = getBatchSimilarities(queryIds, batchResponses, accumulators[worker]);
+	for (size_t i = 0; i < queryIds.size(); i++) {
+	    cache.insert(keys[queryIds[i]], batchResponses[i], batch[i], generation);
+	    for (auto const queryId : followers[queryIds[i]]) {
+		results[queryId].assign(batch[i].begin(), batch[i].begin() + min(counts[queryId], batch[i].size()));
+		markReady(queryId);
+	    }
+	}
+    });
+    if (output.joinable())
+	output.join();
+}
+
+
+vector<pair<size_t, double>> TextRetrievalEngine::evaluateQuery(size_t queryId, size_t nResponses) const {
+    INSTRUMENT_PHASE(EVALUATE_QUERY);
+    INSTRUMENT_COUNT(QUERIES_EVALUATED, 1);
+    
+    return getSimilarities(queryWeights[queryId], queryNorms[queryId], nResponses);
+}
+
+
+/**
+ * it finds the end of a run of equal values in a sorted vector
+ * @param values is the vector
+ * @param start is the position of the run's first value
+ * @param size is the number of values of the vector which are used
+ * @return the position after the run's last value
+ */
+template<class T>
+static size_t getRunEnd(const vector<T>& values, size_t start, size_t size) {
+    size_t end = start + 1;
+    while (end < size && values[end] == values[start])
+	end++;
+    
+    return end;
+}
+
+
+vector<pair<size_t, double>> TextRetrievalEngine::search(string_view text, size_t nResponses) const {
+    INSTRUMENT_PHASE(SEARCH);
+    INSTRUMENT_COUNT(QUERIES_EVALUATED, 1);
+    //the buffers of a thread are kept from one text to the next, so that
+    //a text allocates nothing once they have grown. The terms are kept by
+    //id, the ones which no document contains by their text, and sorted so
+    //that the same terms are next to each other
+    thread_local vector<uint32_t> termIds;
+    thread_local vector<string> unknownTerms;
+    thread_local vector<pair<size_t, double>> terms;
+    thread_local string scratch;
+    thread_local vector<uint32_t> candidates;
+    thread_local vector<uint32_t> expansions;
+    //the words ending with * are prefixes of terms unless the dictionary
+    //misses the terms of added documents
+    const TermDictionary* dictionary = updatableIndex ? nullptr : termDictionary.get();
+    //a Boolean query selects the documents, which are ranked by its
+    //words which are not negated
+    bool isBoolean = !updatableIndex && BooleanQuery::isBoolean(text);
+    BooleanQuery query(isBoolean ? text : string_view(), lexicon, dictionary);
+    //a query too long or too deeply nested to be parsed selects nothing
+    if (isBoolean && !query.getIsParsed())
+	return vector<pair<size_t, double>>();
+    if (isBoolean) {
+	query.evaluate(index, positionalIndex.get(), candidates);
+	text = query.getWords();
+    }
+    //a ranked text shares the cache with the queries of the same terms,
+    //keyed on the terms it is scored by. The generation is taken first,
+    //so that results of an index which changes meanwhile are not kept
+    bool isCached = !isBoolean && cache.getCapacity() > 0;
+    uint64_t generation = cache.getGeneration();
+    vector<string> keyTerms;
+    termIds.clear();
+    size_t nUnknown = 0;
+    size_t position = 0;
+    string_view token;
+    //the operators are words unless there are positions to answer them
+    bool isFiltered = positionalIndex && !updatableIndex;
+    size_t distance;
+    while (ProcessFiles::nextToken(text, position, text.size(), token)) {
+	if (isFiltered && BooleanQuery::isNearOperator(token, distance))
+	    continue;
+	token = TokenNormalizer::normalize(token, scratch);
+	if (isCached)
+	    keyTerms.emplace_back(token);
+	//a prefix stands for each of its terms, as if the text held them all
+	if (dictionary != nullptr && TermDictionary::isWildcard(token)) {
+	    dictionary->findPrefix(token.substr(0, token.size() - 1), expansions);
+	    termIds.insert(termIds.end(), expansions.begin(), expansions.end());
+	    if (!expansions.empty())
+		continue;
+	}
+	uint32_t termId = lexicon.find(token);
+	if (termId == Lexicon::NOT_FOUND) {
+	    uint32_t queryTermId = queryTerms.find(token);
+	    if (queryTermId != Lexicon::NOT_FOUND)
+		termId = lexicon.size() + queryTermId;
+	}
+	if (termId != Lexicon::NOT_FOUND)
+	    termIds.push_back(termId);
+	else {
+	    if (nUnknown == unknownTerms.size())
+		unknownTerms.emplace_back();
+	    unknownTerms[nUnknown++].assign(token);
+	}
+    }
+    sort(termIds.begin(), termIds.end());
+    sort(unknownTerms.begin(), unknownTerms.begin() + nUnknown);
+    
+    size_t maxFrequency = 1;
+    for (size_t i = 0; i < termIds.size(); i = getRunEnd(termIds, i, termIds.size()))
+	maxFrequency = max(getRunEnd(termIds, i, termIds.size()) - i, maxFrequency);
+    for (size_t i = 0; i < nUnknown; i = getRunEnd(unknownTerms, i, nUnknown))
+	maxFrequency = max(getRunEnd(unknownTerms, i, nUnknown) - i, maxFrequency);
+    
+    //the idfs are the ones of computeIdfs, computed for the terms of the
+    //text only, so that no weights of the queries file are needed
+    terms.clear();
+    double queryNorm = 0;
+    for (size_t i = 0, end; i < termIds.size(); i = end) {
+	end = getRunEnd(termIds, i, termIds.size());
+	double weight = (end - i) / double(maxFrequency) * 0.5 * computeIdf(termIds[i], getNDocuments());
+	terms.push_back(make_pair(termIds[i], weight));
+	queryNorm += weight * weight;
+    }
+    //the terms which no document contains add nothing to the cosines
+    //but their weights, taken with nt = 1, are part of the norm
+    for (size_t i = 0, end; i < nUnknown; i = end) {
+	end = getRunEnd(unknownTerms, i, nUnknown);
+	double weight = (end - i) / double(maxFrequency) * 0.5 * log(double(getNDocuments()));
+	queryNorm += weight * weight;
+    }
+    
+    if (isBoolean || (isFiltered && findCandidates(text, candidates)))
+	return getCandidateSimilarities(terms, sqrt(queryNorm), candidates, nResponses);
+    
+    vector<pair<size_t, double>> result;
+    string key = isCached ? ResultCache::makeKey(move(keyTerms)) : string();
+    if (isCached && cache.find(key, nResponses, result))
+	return result;
+    result = getSimilarities(terms, sqrt(queryNorm), nResponses);
+    if (isCached)
+	cache.insert(key, nResponses, result, generation);
+    
+    return result;
+}
+
+
+bool TextRetrievalEngine::findCandidates(string_view text, vector<uint32_t>& candidates) const {
+    //the operands are words and quoted phrases, each with the distance of
+    //the NEAR/k which joins it to the operand before, if any
+    const size_t none = SIZE_MAX;
+    vector<vector<uint32_t>> operands;
+    vector<char> isQuoted;
+    vector<size_t> distances;
+    string scratch;
+    size_t position = 0, distance, nearDistance = none;
+    string_view token;
+    bool isInPhrase = false;
+    while (ProcessFiles::nextToken(text, position, text.size(), token)) {
+	if (!isInPhrase && BooleanQuery::isNearOperator(token, distance)) {
+	    if (!operands.empty())
+		nearDistance = distance;
+	    continue;
+	}
+	bool isOpening = !isInPhrase && token.front() == '"';
+	bool isClosing = (isInPhrase || (isOpening && token.size() > 1)) && token.back() == '"';
+	if (!isInPhrase) {
+	    operands.emplace_back();
+	    isQuoted.push_back(isOpening);
+	    distances.push_back(nearDistance);
+	    nearDistance = none;
+	}
+	string_view term = TokenNormalizer::normalize(token, scratch);
+	if (!term.empty())
+	    operands.back().push_back(lexicon.find(term));
+	isInPhrase = (isInPhrase || isOpening) && !isClosing;
+    }
+    
+    //the documents of each operator are intersected, an operator
+    //with an empty operand being left out
+    bool isFound = false;
+    vector<uint32_t> common;
+    auto keep = [&](const vector<uint32_t>& docIds) {
+	if (!isFound)
+	    candidates = docIds;
+	else {
+	    DocumentSets::intersect(candidates, docIds, common);
+	    candidates.swap(common);
+	}
+	isFound = true;
+    };
+    for (size_t i = 1; i < operands.size(); i++)
+	if (distances[i] != none && !operands[i - 1].empty() && !operands[i].empty())
+	    keep(positionalIndex->findNear(operands[i - 1], operands[i], distances[i]));
+    //a phrase joined by NEAR/k is found by it
+    for (size_t i = 0; i < operands.size(); i++)
+	if (isQuoted[i] && !operands[i].empty() && distances[i] == none 
+	    && (i + 1 == operands.size() || distances[i + 1] == none))
+	    keep(positionalIndex->findPhrase(operands[i]));
+    
+    return isFound;
+}
+
+
+vector<pair<size_t, double>> TextRetrievalEngine::getCandidateSimilarities(const vector<pair<size_t, double>>& terms, 
+    double queryNorm, const vector<uint32_t>& candidates, size_t nResponses) const {
+    vector<pair<size_t, double>> result;
+    if (nResponses == 0)
+	return result;
+    vector<size_t> termIds;
+    vector<double> weights;
+    vector<PostingsCursor> cursors;
+    for (auto const &ent1 : terms) {
+	if (ent1.second > 0 && ent1.first < index.getNTerms() && index.getDocumentFrequency(ent1.first) > 0) {
+	    termIds.push_back(ent1.first);
+	    weights.push_back(ent1.second);
+	    cursors.push_back(index.getCursor(ent1.first));
+	}
     }
+    
+    //the dot product of a document is summed by term id, as in an exhaustive pass
+    for (auto const docId : candidates) {
+	double dot = 0;
+	for (size_t t = 0; t < cursors.size(); t++) {
+	    cursors[t].nextGeq(docId);
+	    if (cursors[t].getDocId() == docId)
+		dot += weights[t] * index.getWeight(termIds[t], docId, cursors[t].getFrequency());
+	}
+	double scale = queryNorm * index.getNorm(docId);
+	result.push_back(make_pair(docId, scale > 0 ? dot / scale : 0));
+	push_heap(result.begin(), result.end(), Compare());
+	if (result.size() > nResponses) {
+	    pop_heap(result.begin(), result.end(), Compare());
+	    result.pop_back();
+	}
+    }
+    INSTRUMENT_COUNT(DOCUMENTS_SCORED, candidates.size());
+    sort_heap(result.begin(), result.end(), Compare());
+    
+    return result;
+}
+
+
+vector<pair<size_t, double>> TextRetrievalEngine::getSimilarities(const vector<pair<size_t, double>>& terms, 
+    double queryNorm, size_t nResponses) const {
+    if (updatableIndex)
+	return getSegmentedSimilarities(terms, queryNorm, nResponses);
+    if (quantizedIndex)
+	return getQuantizedSimilarities(terms, queryNorm, nResponses);
+    
+    return getSortedSimilarities(terms, queryNorm, nResponses);
+}
+
+
+void TextRetrievalEngine::recordMemory() const {
+#ifndef NO_INSTRUMENTATION
+    //the views of an attached lexicon or index take the same bytes in the mapping
+    INSTRUMENT_BYTES("lexicon", lexicon.getCharacters().size() + (lexicon.size() + 1) * sizeof(uint64_t) 
+	+ lexicon.getNSlots() * sizeof(uint32_t));
+    INSTRUMENT_BYTES("queryTerms", queryTerms.getCharacters().size() + (queryTerms.size() + 1) * sizeof(uint64_t) 
+	+ queryTerms.getNSlots() * sizeof(uint32_t));
+    INSTRUMENT_BYTES("invertedIndex", index.getPostingsSize() + (index.getNTerms() + 1) * sizeof(uint64_t) 
+	+ index.getNTerms() * (sizeof(uint32_t) + sizeof(float) + sizeof(double)) 
+	+ (index.getNDocuments() + 1) * (sizeof(double) + sizeof(uint64_t)));
+    size_t documentsBytes = p->getDocuments().getMemoryUsage() + documentStore.getMemoryUsage();
+    for (auto const &document : addedDocuments)
+	documentsBytes += sizeof(string) + document.capacity();
+    INSTRUMENT_BYTES("documents", documentsBytes);
+    size_t queriesBytes = p->getQueriesTokens().getMemoryUsage(), weightsBytes = 0, resultsBytes = 0;
+    for (size_t i = 0; i < queryWeights.size(); i++) {
+	weightsBytes += queryWeights[i].capacity() * sizeof(pair<size_t, double>) + sizeof(double);
+	//a node of a map holds three pointers and its color besides the pair
+	weightsBytes += frequencies[i].size() * (sizeof(pair<const uint32_t, size_t>) + 4 * sizeof(void*));
+    }
+    for (auto const &result : results)
+	resultsBytes += result.capacity() * sizeof(pair<size_t, double>);
+    INSTRUMENT_BYTES("queries", queriesBytes);
+    INSTRUMENT_BYTES("queryWeights", weightsBytes);
+    INSTRUMENT_BYTES("results", resultsBytes);
+    INSTRUMENT_BYTES("resultCache", cache.getSize());
+    INSTRUMENT_BYTES("segmentedIndex", updatableIndex ? updatableIndex->getMemoryUsage() : 0);
+    INSTRUMENT_BYTES("quantizedIndex", quantizedIndex ? quantizedIndex->getMemoryUsage() : 0);
+    INSTRUMENT_BYTES("positionalIndex", positionalIndex ? positionalIndex->getMemoryUsage() : 0);
+    INSTRUMENT_BYTES("termDictionary", termDictionary ? termDictionary->getMemoryUsage() : 0);
+#endif
+}
+
+
+void TextRetrievalEngine::displayResults() {
+    INSTRUMENT_PHASE(DISPLAY_RESULTS);
+    ResultWriter writer(cout);
+    writeResults(writer);
+}
+
+
+bool TextRetrievalEngine::writeResults(ResultWriter& writer) const {
+    for (size_t i = 1; i <= p->getNQueries(); i++)
+	writeQueryResults(writer, i);
+    
+    return writer.flush();
+}
+
+
+void TextRetrievalEngine::writeQueryResults(ResultWriter& writer, size_t queryId) const {
+    //it writes the query with id queryId and the documents resulted
+    //from the call of getSortedSimilarities
+    writer.beginQuery(queryId, p->getQueriesTokens().getTokens(queryId), results[queryId].size());
+    string text;
+    for (auto const &aPair : results[queryId])
+	writer.addResult(aPair.first, writer.hasDocuments() ? getDocument(aPair.first, text) : string_view(), aPair.second);
+    writer.endQuery();
 }
@@ -33,24 +33,47 @@
 #define TEXTRETRIEVALENGINE_H
 #include "ProcessFiles.h"
 #include "Compare.h"
+#include "InvertedIndex.h"
+#include "IndexFile.h"
+#include "QueryExecutor.h"
+#include "ResultCache.h"
+#include "ResultWriter.h"
+#include "SegmentedIndex.h"
+#include "QuantizedIndex.h"
+#include "PositionalIndex.h"
+#include "BooleanQuery.h"
+#include "TermDictionary.h"
+#include "DocumentSets.h"
+#include "Instrumentation.h"
 #include <iostream>
-#include <set>
 #include <algorithm>
 #include <queue>
 #include <iomanip>
+#include <cmath>
+#include <unordered_map>
+#include <memory>
+#include <thread>
+#include <condition_variable>
 
 class TextRetrievalEngine {
 public:
 	TextRetrievalEngine();
-	TextRetrievalEngine(ProcessFiles* p);
-	TextRetrievalEngine(const TextRetrievalEngine& orig);
+
+	/**
+	* it takes the documents and the queries read by p, moving them 
+	* instead of copying them, so p is left empty and they are read
+	* through getP afterwards
+	* @param p are the read files
+	*/
+	TextRetrievalEngine(ProcessFiles&& p);
+	TextRetrievalEngine(const TextRetrievalEngine& orig) = delete;
 	virtual ~TextRetrievalEngine();
 
 	/**
-	* getter for private member terms
-	* @return the set terms
+	* getter for private member lexicon
+	* @return the lexicon of the terms
 	*/
-	set<string> getTerms() const { return terms; };
+	const Lexicon& getLexicon() const { return lexicon; }
 
 	/**
 	* getter for private member maxFrequencies
@@ -60,9 +83,15 @@ public:
 
 	/**
 	* getter for private member frequencies
-	* @return the map frequencies
+	* @return the frequencies of the queries' terms
 	*/
-	map<bool, vector<map<string, size_t>>> getFrequencies() const { return frequencies; }
+	vector<map<uint32_t, size_t>> getFrequencies() const { return frequencies; }
+
+	/**
+	* getter for private member termFrequencies
+	* @return for each term id the pairs document id - frequency
+	*/
+	vector<vector<pair<size_t, size_t>>> getTermFrequencies() const { return termFrequencies; }
 
 	/**
 	* getter for private member p
@@ -71,35 +100,247 @@ public:
 	ProcessFiles* getP() const { return p; }
 
 	/**
-	* getter for private member weights
-	* @return the vector weights
+	* getter for private member index
+	* @return the inverted index of the documents
+	*/
+	const InvertedIndex& getIndex() const { return index; }
+
+	/**
+	* getter for private member queryWeights
+	* @return the sparse weights vectors of the queries
+	*/
+	vector<vector<pair<size_t, double>>> getQueryWeights() const { return queryWeights; }
+
+	/**
+	* getter for private member cache
+	* @return the cache of the queries' results
+	*/
+	ResultCache& getCache() { return cache; }
+
+	/**
+	* getter for private member updatableIndex
+	* @return the index of the added and deleted documents, nullptr until
+	* a document is added or deleted
+	*/
+	const SegmentedIndex* getUpdatableIndex() const { return updatableIndex.get(); }
+
+	/**
+	* getter for private member quantizedIndex
+	* @return the index of the quantized impacts, nullptr unless quantize was called
+	*/
+	const QuantizedIndex* getQuantizedIndex() const { return quantizedIndex.get(); }
+
+	/**
+	* getter for private member positionalIndex
+	* @return the index of the terms' positions, nullptr unless indexPositions was called
+	*/
+	const PositionalIndex* getPositionalIndex() const { return positionalIndex.get(); }
+
+	/**
+	* getter for private member termDictionary
+	* @return the sorted dictionary of the terms, nullptr unless buildDictionary was called
+	*/
+	const TermDictionary* getTermDictionary() const { return termDictionary.get(); }
+
+	/**
+	* getter for private member results
+	* @return for each query the pairs document id - cosine of its results
 	*/
-	vector<vector<double>> getWeights(bool isQuery) { return weights[isQuery]; };
+	const vector<vector<pair<size_t, double>>>& getResults() const { return results; }
 
 	/**
-	* It initializes the private members: frequenciesOfTerms (a list of maps) and terms (a set of strings)
+	* It takes the terms of the whole collection and the number of its documents
+	* containing each of them, when the documents read are a shard of it. The
+	* shard's terms take the ids of the collection's terms and the idfs are computed
+	* from the collection's counts, so the weights, the norms and the cosines of the
+	* shard's documents equal the ones of an index of the whole collection. It must
+	* be called before computeFrequencies
+	* @param terms is the lexicon of the collection's terms
+	* @param documentFrequencies is the number of documents containing each term
 	*/
-	void computeFrequencies();
+	void setCollectionStatistics(const Lexicon& terms, const vector<uint32_t>& documentFrequencies);
 
 	/**
-	* It initializes the private member idfs to two vectors of size terms.size()
+	* It initializes the private members: lexicon, termFrequencies and maxFrequencies
+	* of the documents, taking them from the counts which builder computed while the
+	* documents file was read, and frequencies of the queries. The terms of a shard
+	* keep the ids of setCollectionStatistics. The counts are moved out of builder,
+	* which is left empty
+	* @param builder contains the counts of the documents' terms
+	*/
+	void computeFrequencies(IndexBuilder&& builder);
+
+	/**
+	* It takes the lexicon and the inverted index of the documents from a loaded
+	* index file, in place of computeFrequencies and computeDocsWeight(false), and
+	* computes the frequencies of the queries
+	* @param file is the loaded index file. It must outlive the engine
+	*/
+	void loadIndex(const IndexFile& file);
+
+	/**
+	* It saves the lexicon, the inverted index and the text of the documents
+	* to an index file, once computeDocsWeight(false) is called. Documents added
+	* or deleted later are not saved
+	* @param fileName is the path of the file
+	* @return false if the file could not be written
+	*/
+	bool saveIndex(const string& fileName) const;
+
+	/**
+	* It initializes the private member idfs to two vectors of size the number
+	* of terms of the documents and the queries
 	*/
 	void initializeIdfs();
 
 	/**
-	* It computes the weights of all queries or documents calling
-	* function computeDocWeight
+	* It computes the weights of all queries calling function computeDocWeight
+	* or of all documents calling function addTermPostings. Documents' postings
+	* are compressed by the inverted index and their norms are computed once all are added
 	* @param isQuery true stands for query, false for document
 	*/
 	void computeDocsWeight(bool isQuery);
 
+	/**
+	* It computes the impact of each posting of the inverted index and quantizes it,
+	* so that the queries are evaluated by getQuantizedSimilarities, adding integers,
+	* with cosines close to the exact ones. Once documents are added or deleted the
+	* queries are evaluated exactly again. It must be called after computeDocsWeight(false)
+	* or loadIndex, which drop the quantized impacts
+	* @param bits is the width of an impact, 8 or 16, or 0 to evaluate exactly
+	*/
+	void quantize(unsigned bits);
+
+	/**
+	* It makes the index of the positions of the terms in the documents, reading their
+	* normalized text once, so that the texts given to search may hold phrases and NEAR/k
+	* operators, which are then answered without reading any document. It must be called
+	* after computeDocsWeight(false) or loadIndex, which drop the positions. Once documents
+	* are added or deleted the operators are taken as words again
+	*/
+	void indexPositions();
+
+	/**
+	* It makes the sorted dictionary of the terms of the lexicon, so that the words of
+	* the texts given to search may end with * to stand for all the terms beginning with
+	* what comes before it. It must be called after computeDocsWeight(false) or loadIndex,
+	* which drop the dictionary. Once documents are added or deleted such words are taken
+	* as they are again
+	*/
+	void buildDictionary();
+
+	/**
+	* It adds a document to the collection without building the index again.
+	* The document goes to the private member updatableIndex, which is made
+	* from the inverted index by the first change, and the terms which do not
+	* appear in the documents the index was built from take ids as the terms
+	* of the queries do. Its weights, and the ones of all the documents, are computed
+	* with the idfs of the live documents when the queries are evaluated. It must not
+	* be called while queries are evaluated
+	* @param text is the text of the document, its terms separated by white space
+	* @return the id of the document, after the ids of all the documents before
+	*/
+	size_t addDocument(string_view text);
+
+	/**
+	* It deletes a document from the collection, so that it is returned by
+	* no query. It must not be called while queries are evaluated
+	* @param docId is the id of the document
+	* @return false if there is no such document
+	*/
+	bool deleteDocument(size_t docId);
+
+	/**
+	* It computes the results of all queries in parallel. The queries are shared
+	* among the workers of executor and the results are stored by query id to the
+	* private member results. The results of a query whose terms were evaluated
+	* before, for at least as many documents, are taken from the private member cache.
+	* Once documents have been added or deleted, the queries' weights are computed
+	* again from the current documents' frequencies and the queries are evaluated
+	* one at a time by getSegmentedSimilarities.
+	* In batches the queries are evaluated by getBatchSimilarities, which reads each
+	* postings list once for all the queries of a batch containing its term, and the
+	* queries of the same terms are evaluated once.
+	* When a writer is given, the results are written by a thread of their own while
+	* the queries are evaluated, each query's once it and all the queries before it
+	* have their results, so that writing them overlaps the evaluation
+	* @param executor is the pool of threads which evaluates the queries
+	* @param batchSize is the number of queries of a batch, 0 or 1 evaluates
+	* them one at a time by getSortedSimilarities
+	* @param writer is the sink of the results, nullptr to only keep them
+	*/
+	void computeResults(QueryExecutor& executor, size_t batchSize = 0, ResultWriter* writer = nullptr);
+
+	/**
+	* It evaluates a single query without the cache, by getSegmentedSimilarities
+	* once documents have been added or deleted, by getQuantizedSimilarities once
+	* the index is quantized and by getSortedSimilarities otherwise. It only reads the engine, so it may be called by many threads
+	* at once, after computeDocsWeight(true) and, when documents were added or
+	* deleted since, computeResults, which computes the weights for them
+	* @param queryId is the id of the query
+	* @param nResponses the number of documents to be returned
+	* @return the pairs document id - cosine sorted by descending cosine and
+	* ascending document id
+	*/
+	vector<pair<size_t, double>> evaluateQuery(size_t queryId, size_t nResponses) const;
+
+	/**
+	* It evaluates a text which is not a query of the queries file, as evaluateQuery does,
+	* looking its results up in the cache and keeping them there, keyed on its terms
+	* as the queries of the file are, unless it is Boolean or its phrases and NEAR/k
+	* operators select documents. Its tokens are normalized as the ones of the files and its
+	* weights are computed with the formula of computeDocWeight, the idfs of its terms
+	* taken from the documents' frequencies and the terms which no document contains
+	* taking nt = 1, so a text equal to a query of the file has the same results. No term
+	* is added to the lexicons and no weights of the queries are read, so it may be called
+	* by many threads at once on an index of the documents only, once computeDocsWeight(false)
+	* or loadIndex is done and, when documents were added or deleted since, refreshWeights.
+	* Once indexPositions is called, the phrases and NEAR/k operators of the text keep
+	* only the documents which satisfy them, ranked by their cosines to all its words.
+	* A text with AND, OR or NOT is a Boolean query, parsed by BooleanQuery, whose
+	* documents are ranked by their cosines to its words which are not negated; its
+	* phrases and NEAR/k operators are taken as AND when there are no positions. It is
+	* not answered once documents are added or deleted, when its words are ranked instead,
+	* and one beyond BooleanQuery::MAX_TOKENS or MAX_DEPTH returns no documents.
+	* Once buildDictionary is called, a word ending with * stands for the terms of its
+	* prefix, each taken once, or joined by OR in a Boolean query
+	* @param text is the text of the query, its terms separated by white space
+	* @param nResponses the number of documents to be returned
+	* @return the pairs document id - cosine sorted by descending cosine and
+	* ascending document id
+	*/
+	vector<pair<size_t, double>> search(string_view text, size_t nResponses) const;
+
+	/**
+	* It makes the added documents searchable and computes the documents' norms, the
+	* idfs and the queries' weights again when documents were added or deleted since
+	* they were computed.
+	* computeResults calls it before the queries are evaluated
+	*/
+	void refreshWeights();
+
+	/**
+	* It records to the instrumentation the bytes which the lexicons, the inverted
+	* index, the texts of the documents, the queries, their weights and results,
+	* the cache and the index of the added documents take
+	*/
+	void recordMemory() const;
+
 	/**
 	* It displays the results. Given the queries and documents it is
 	* displayed a list of queries and their associated documents sorted
-	* by their weight
+	* by their weight. The results are computed by computeResults, in
+	* query id order
 	*/
 	void displayResults();
 
+	/**
+	* It writes the results computed by computeResults to a sink, in query id order
+	* @param writer is the sink of the results
+	* @return false if the sink's stream failed
+	*/
+	bool writeResults(ResultWriter& writer) const;
+
 private:
 	//it contains the data from queries and documents files
 	ProcessFiles*								p;
@@ -107,45 +348,109 @@ private:
 	//private member terms. Boolean part stands for
 	//queries when it is true, documents when is false
 	map<bool, vector<double>>						idfs;
-	//a set of the terms appeared in documents and queries
-	set<string>								terms;
-	//it contains for each vector of terms the frequency
-	//of the particular term. Boolean part stands for 
-	//queries when it is true, documents when is false
-	map<bool, vector<map<string, size_t>>>					frequencies;
+	//it gives an id to each term appeared in documents
+	Lexicon									lexicon;
+	//it gives an id to each term appeared only in queries,
+	//which is offset by the size of lexicon
+	Lexicon									queryTerms;
+	//the index file the documents were loaded from, if any
+	const IndexFile*							indexFile;
+	//the texts of the documents of the index file, read
+	//in place
+	DocumentStore								documentStore;
+	//it contains for each query the frequency of its
+	//terms, keyed by term id
+	vector<map<uint32_t, size_t>>						frequencies;
+	//it contains for each term id the pairs document
+	//id - frequency of the term in the document, sorted
+	//by document id
+	vector<vector<pair<size_t, size_t>>>					termFrequencies;
 	//it represents the frequency of the most often
 	//appeared term in a vector of terms. Boolean part
 	//stands for queries when it is true, documents when
 	//is false
 	map<bool, vector<size_t>>						maxFrequencies;
-	//it represents the weight of a term in a particular
-	//vector of terms. Boolean part stands for queries 
-	//when it is true, documents when is false
-	map<bool, vector<vector<double>>>					weights;
+	//for each term the postings list of the documents
+	//containing it with the term's weight in them
+	InvertedIndex								index;
+	//for each query the pairs term id - weight of its
+	//terms, sorted by term id
+	vector<vector<pair<size_t, double>>>					queryWeights;
+	//the Euclidean norm of each query's weights vector
+	vector<double>								queryNorms;
+	//for each query the pairs document id - cosine of 
+	//the returned documents, sorted by their cosine
+	vector<vector<pair<size_t, double>>>					results;
+	//the results of the queries evaluated so far, keyed
+	//on their terms, also filled by search. It is
+	//invalidated whenever the index changes
+	mutable ResultCache							cache;
+	//the documents added and deleted after the inverted
+	//index was built, made by the first change
+	unique_ptr<SegmentedIndex>						updatableIndex;
+	//the normalized text of each added document, by
+	//document id after the ones of the inverted index
+	vector<string>								addedDocuments;
+	//the version of updatableIndex which the queries'
+	//weights were computed for
+	uint64_t								queryVersion;
+	//the quantized impacts of the inverted index,
+	//made by quantize
+	unique_ptr<QuantizedIndex>						quantizedIndex;
+	//the positions of the terms in the documents of
+	//the inverted index, made by indexPositions
+	unique_ptr<PositionalIndex>						positionalIndex;
+	//the terms of the lexicon in sorted order, made
+	//by buildDictionary
+	unique_ptr<TermDictionary>						termDictionary;
+	//the number of documents of the whole collection
+	//containing each term, when the documents are a
+	//shard of it
+	vector<uint32_t>							collectionFrequencies;
 
 	/**
-	* It computes the frequency of a particular term in a particular document or query
-	* @param term is the term whose frequency is computed
-	* @param docId is the document or query id where the term belongs
-	* @param isTermOfQuery checks if term belongs in a query or in a document
-	* @return the frequency of the term
+	* It computes the greatest frequency of the terms in the current query
+	* and store it to maxFrequencies private member
+	* @param queryId is the id of the query to search in
 	*/
-	size_t computeFreqOfTerm(const string& term, size_t docId, bool isTermOfQuery);
+	void computeMaxFreq(size_t queryId);
 
 	/**
-	* It computes the greatest frequency of the terms in the current document or query
-	* and store it to maxFrequencies private member
-	* @param docId is the id of the document or query to search in
-	* @param isQuery true stands for query and false for document
+	* It returns the number of documents with the current term
+	* @param termId is the id of the term
+	* @return the number of documents with the current term
 	*/
-	void computeMaxFreq(size_t docId, bool isQuery);
+	size_t getNDocsWithTerm(size_t termId) const;
 
 	/**
-	* It computes the number of documents with the current term
-	* @param term is the term which the function searches among the documents
-	* @return the number of documents with the current term
+	* It returns the number of documents of the collection
+	* @return the number of live documents
+	*/
+	size_t getNDocuments() const;
+
+	/**
+	* It computes the frequencies of the queries' terms, giving an id to
+	* the terms which do not appear in the documents
+	*/
+	void computeQueryFrequencies();
+
+	/**
+	* It returns the normalized text of a document, decompressing it from the
+	* store of the index file or of the documents file
+	* @param docId is the id of the document
+	* @param text is scratch space which may hold the text
+	* @return a view of the text, valid until text changes
 	*/
-	size_t getNDocsWithTerm(const string term);
+	string_view getDocument(size_t docId, string& text) const;
+
+	/**
+	* It computes the IDF of a term according to the formula IDF = ln(N/nt),
+	* nt = 0 taken as 1
+	* @param termId is the id of the term
+	* @param nDocuments is N, the number of documents of the collection
+	* @return the idf of the term
+	*/
+	double computeIdf(size_t termId, size_t nDocuments) const;
 
 	/**
 	* It computes the IDFs according to the formula IDF = ln(N/nt)/ln(N).
@@ -167,7 +472,7 @@ private:
 	* @param isTermOfQuery checks if term belongs in a query or in a document
 	* @return the normalized frequency
 	*/
-	double computeNormalizedFreq(const string term, const size_t documentId, bool isTermOfQuery);
+	double computeNormalizedFreq(size_t frequency, const size_t documentId, bool isTermOfQuery);
 
 	/**
 	* It computes the weight of each term in a particular document according to the formula
@@ -175,38 +480,164 @@ private:
 	* In the case of a query it is TF = 0.5 * ft,q / maxx(fx,q) and IDF = ln(N/nt)
 	* N is the number of documents of the collection,
 	* nt is the number of documents which contain the term.
-	* These values are stored to the private member weights.
-	* @param documentId is the id of the document or query where the term belongs
-	* @param isQuery checks if term belongs in a query or in a document
+	* Only the terms of the query are visited and their weights are stored to the
+	* private member queryWeights.
+	* @param queryId is the id of the query where the terms belong
+	*/
+	void computeDocWeight(const size_t queryId);
+
+	/**
+	* It appends the postings of a term, the documents which contain it and its
+	* frequency in them, to the private member index, which computes their weights
+	* with the formula of computeDocWeight from the idfs and maxFrequencies it is given.
+	* @param termId is the id of the term
+	*/
+	void addTermPostings(const size_t termId);
+
+	/**
+	* It computes the nResponses documents with the greatest cosine to a query,
+	* keeping the best documents found so far in a bounded heap. The documents
+	* are scored a window of ids at a time. In a window each term of the query is
+	* bounded by its weight times the greatest impact of its blocks there, and the
+	* terms whose bounds sum to no more than the heap's least cosine cannot bring
+	* a document into the heap on their own. Only the lists of the other terms are
+	* read to find the documents to be scored, the rest are probed for them from
+	* the greatest bound down, each first bounded by its block which would hold 
+	* the document, and a document is dropped as soon as it cannot reach the heap.
+	* A window where no term is needed is skipped. The cosines are summed in the
+	* order of the terms' ids, so they equal the ones of an exhaustive evaluation.
+	* When fewer documents share a term with the query, the rest are returned
+	* with cosine 0 by ascending id. It only reads the engine, so it may be called
+	* by many threads at once
+	* @param terms are the pairs term id - weight of the query's terms, by term id
+	* @param queryNorm is the Euclidean norm of the query's weights vector
+	* @param nResponses the number of documents to be returned, at most the
+	* number of documents
+	* @return the pairs document id - cosine sorted by descending cosine and
+	* ascending document id
+	*/
+	vector<pair<size_t, double>> getSortedSimilarities(const vector<pair<size_t, double>>& terms, double queryNorm, 
+	    size_t nResponses) const;
+
+	/**
+	* It computes the documents with the greatest cosine to each query of a batch
+	* together. The postings lists of the batch's terms are read a window of
+	* documents at a time, each once, by term id, and the weight of each posting
+	* is added to the accumulators of the queries containing the term, which keep
+	* the queries of a document next to each other. The documents are not skipped
+	* by bounds, but the lists shared by the queries are decoded once for all of
+	* them, and the results equal the ones of getSortedSimilarities. It only reads
+	* the engine, so it may be called by many threads at once
+	* @param queryIds are the ids of the queries of the batch
+	* @param nResponses is the number of documents to be returned for each query
+	* @param accumulators is scratch space, kept by the caller between batches
+	* @return for each query of the batch the pairs document id - cosine sorted
+	* by descending cosine and ascending document id
+	*/
+	vector<vector<pair<size_t, double>>> getBatchSimilarities(const vector<size_t>& queryIds, 
+	    const vector<size_t>& nResponses, vector<double>& accumulators) const;
+
+	/**
+	* It computes the documents with the greatest cosine to a query once documents
+	* have been added or deleted. The postings lists of the query's terms are read
+	* in the inverted index and in all the segments of updatableIndex, skipping the
+	* deleted documents, and the weights and norms are computed with the idfs of the
+	* live documents, so the cosines are the ones of an index built from them. The
+	* documents are not skipped by bounds, since the bounds of the inverted index's
+	* blocks do not follow the changes of the idfs
+	* @param terms are the pairs term id - weight of the query's terms, by term id
+	* @param queryNorm is the Euclidean norm of the query's weights vector
+	* @param nResponses the number of documents to be returned
+	* @return the pairs document id - cosine sorted by descending cosine and
+	* ascending document id
+	*/
+	vector<pair<size_t, double>> getSegmentedSimilarities(const vector<pair<size_t, double>>& terms, double queryNorm, 
+	    size_t nResponses) const;
+
+	/**
+	* It writes the results of a query to a sink, with the text of the documents
+	* when the sink's format has it
+	* @param writer is the sink of the results
+	* @param queryId is the id of the query
+	*/
+	void writeQueryResults(ResultWriter& writer, size_t queryId) const;
+
+	/**
+	* It computes the documents with the greatest cosine to a query from the quantized
+	* impacts. Each term's weight in the query, times the greatest impact of the term, is
+	* quantized too, to as many steps as keep the sum of the products of a document
+	* within 32 bits, and the products are added to 32-bit accumulators, a window of
+	* documents at a time. The documents are ranked by their sums, and their cosines
+	* are the sums scaled back, so they differ from the exact ones by the rounding
+	* of the impacts and the weights. A query with so many terms that fewer than
+	* QuantizedIndex::MIN_QUERY_STEPS steps would be left is scored exactly by
+	* getSortedSimilarities. It only reads the engine, so it may be called by many
+	* threads at once
+	* @param terms are the pairs term id - weight of the query's terms, by term id
+	* @param queryNorm is the Euclidean norm of the query's weights vector
+	* @param nResponses the number of documents to be returned
+	* @return the pairs document id - cosine sorted by descending cosine and
+	* ascending document id
+	*/
+	vector<pair<size_t, double>> getQuantizedSimilarities(const vector<pair<size_t, double>>& terms, double queryNorm, 
+	    size_t nResponses) const;
+
+	/**
+	* It computes the documents with the greatest cosine to a query by getSegmentedSimilarities
+	* once documents have been added or deleted, by getQuantizedSimilarities once the
+	* index is quantized and by getSortedSimilarities otherwise
+	* @param terms are the pairs term id - weight of the query's terms, by term id
+	* @param queryNorm is the Euclidean norm of the query's weights vector
+	* @param nResponses the number of documents to be returned
+	* @return the pairs document id - cosine sorted by descending cosine and
+	* ascending document id
+	*/
+	vector<pair<size_t, double>> getSimilarities(const vector<pair<size_t, double>>& terms, double queryNorm, 
+	    size_t nResponses) const;
+
+	/**
+	* It finds the documents which satisfy the operators of a text: each phrase in
+	* double quotes must appear in them and, for each "a NEAR/k b", the words or
+	* phrases a and b must start at most k positions apart. They are looked up in
+	* the positional index, so it must be built
+	* @param text is the text of the query
+	* @param candidates is set to the ascending ids of the documents
+	* @return false if the text has no operators
 	*/
-	void computeDocWeight(const size_t documentId, bool isQuery);
+	bool findCandidates(string_view text, vector<uint32_t>& candidates) const;
 
 	/**
-	* It computes the angle between two vectors using their inner product.
-	* More precisely we use this function to find the similarity between 
-	* two vectors: query and document. The larger is the computed value the 
-	* more similar are the two vectors.
-	* @param query is the vector with the weights of a query
-	* @param document is the vector with the weights of a document
-	* @return the computed angle's cosine between query and document
+	* It computes the documents with the greatest cosine to a query among some
+	* documents only, scoring each of them exactly from the inverted index. It only
+	* reads the engine, so it may be called by many threads at once
+	* @param terms are the pairs term id - weight of the query's terms, by term id
+	* @param queryNorm is the Euclidean norm of the query's weights vector
+	* @param candidates are the ascending ids of the documents
+	* @param nResponses the number of documents to be returned
+	* @return the pairs document id - cosine sorted by descending cosine and
+	* ascending document id, of candidates only
 	*/
-	double computeCosine(vector<double> query, vector<double> document);
+	vector<pair<size_t, double>> getCandidateSimilarities(const vector<pair<size_t, double>>& terms, double queryNorm, 
+	    const vector<uint32_t>& candidates, size_t nResponses) const;
 
 	/**
-	* It computes a vector's length according to Euclidean norm
-	* @param aVector a vector whose length is computed
-	* @return the computed length
+	* It adds to the results of a query the live documents which share no term with
+	* it, with cosine 0 by ascending id, up to the number asked for, and sorts them.
+	* A shard adds only documents of its own
+	* @param result are the pairs document id - cosine found for the query
+	* @param nResponses the number of documents to be returned, at most the
+	* number of documents
 	*/
-	double computeLength(vector<double> aVector);
+	void completeResults(vector<pair<size_t, double>>& result, size_t nResponses) const;
 
 	/**
-	* It computes a sorted by its weight structure which contains the weight and 
-	* the associated document id
-	* @param queryId is the query's id for which the weights are computed
-	* @param nResponses the number of weights we need to store for this query
-	* @return a structure of a priority list with pairs weight-docId
+	* It counts the terms of a document's text, normalized as the ones of the files.
+	* The terms which are not in lexicon take ids as the terms of the queries do
+	* @param text is the text of the document
+	* @param normalized is appended the normalized tokens, each followed by a blank
+	* @return the pairs term id - frequency of the document's terms, by term id
 	*/
-	priority_queue<pair<size_t, double>, vector<pair<size_t, double>>, Compare> getSortedSimilarities(size_t queryId, size_t nResponses);
+	vector<pair<uint32_t, uint32_t>> countTerms(string_view text, string& normalized);
 };
 
 #endif /* TEXTRETRIEVALENGINE_H */
@@ -0,0 +1,99 @@
+/*
+ * The MIT License
+ *
+ * Copyright 2017 Theomeli.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+/* 
+ * File:   TokenArena.cpp
+ * Author: Theomeli
+ * 
+ * Created on October 21, 2026, 2:30 PM
+ */
+
+#include "TokenArena.h"
+#include <algorithm>
+
+TokenArena::TokenArena(): offsets(1, 0) {
+}
+
+
+TokenArena::~TokenArena() {
+}
+
+
+size_t TokenArena::getMemoryUsage() const {
+    return characters.capacity() + offsets.capacity() * sizeof(uint64_t) + parts.capacity() * sizeof(Part);
+}
+
+
+void TokenArena::startText(size_t id) {
+    Part part = { id, characters.size(), characters.size() };
+    parts.push_back(part);
+}
+
+
+void TokenArena::addToken(string_view token) {
+    if (parts.empty())
+        startText(0);
+    characters += token;
+    characters += ' ';
+    parts.back().end = characters.size();
+}
+
+
+void TokenArena::append(const TokenArena& other) {
+    uint64_t shift = characters.size();
+    characters += other.characters;
+    for (auto const &part : other.parts) {
+        Part shifted = { part.id, part.start + shift, part.end + shift };
+        parts.push_back(shifted);
+    }
+}
+
+
+void TokenArena::finish(size_t nTexts) {
+    bool isOrdered = true;
+    for (size_t i = 0; i < parts.size(); i++) {
+        nTexts = max(nTexts, parts[i].id + 1);
+        if (i > 0 && parts[i].id < parts[i - 1].id)
+            isOrdered = false;
+    }
+    
+    offsets.assign(nTexts + 1, 0);
+    for (auto const &part : parts)
+        offsets[part.id + 1] += part.end - part.start;
+    for (size_t id = 0; id < nTexts; id++)
+        offsets[id + 1] += offsets[id];
+    //the parts are added one after the other, so texts given in order
+    //of ids are in place already and the others are moved to theirs
+    if (!isOrdered) {
+        string ordered(characters.size(), ' ');
+        vector<uint64_t> positions(offsets.begin(), offsets.end() - 1);
+        for (auto const &part : parts) {
+            memcpy(&ordered[positions[part.id]], characters.data() + part.start, part.end - part.start);
+            positions[part.id] += part.end - part.start;
+        }
+        characters.swap(ordered);
+    }
+    vector<Part>().swap(parts);
+}
@@ -0,0 +1,194 @@
+/*
+ * The MIT License
+ *
+ * Copyright 2017 Theomeli.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+/* 
+ * File:   TokenArena.h
+ * Author: Theomeli
+ *
+ * Created on October 21, 2026, 2:30 PM
+ */
+
+#ifndef TOKENARENA_H
+#define TOKENARENA_H
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace std;
+
+/**
+ * the normalized tokens of many texts, such as the documents or the queries,
+ * kept in a single buffer of characters. Each token is followed by a blank,
+ * which no token contains, and the texts lie one after the other in id order,
+ * so a text is a view into the buffer from its offset to the next one's. The
+ * tokens are added text by text, in any order of ids, and finish puts the
+ * texts in order. The arena owns its storage, which is freed at once, and it 
+ * is moved rather than copied
+ */
+class TokenArena {
+public:
+    /**
+     * the tokens of a text, walked in place as views into the arena
+     */
+    class Tokens {
+    public:
+        class Iterator {
+        public:
+            using iterator_category = forward_iterator_tag;
+            using value_type = string_view;
+            using difference_type = ptrdiff_t;
+            using pointer = const string_view*;
+            using reference = string_view;
+            
+            Iterator(const char* position, const char* last): position(position), last(last) { findEnd(); }
+            
+            string_view operator *() const { return string_view(position, tokenEnd - position); }
+            Iterator& operator ++() {
+                position = tokenEnd + 1;
+                findEnd();
+                return *this;
+            }
+            bool operator ==(const Iterator& rightSide) const { return position == rightSide.position; }
+            bool operator !=(const Iterator& rightSide) const { return position != rightSide.position; }
+        private:
+            //the start of the current token
+            const char*							position;
+            //the end of the text
+            const char*							last;
+            //the blank after the current token
+            const char*							tokenEnd;
+            
+            void findEnd() { 
+                tokenEnd = position < last ? (const char*)memchr(position, ' ', last - position) : last; 
+            }
+        };
+        
+        Tokens(string_view text): text(text) {}
+        
+        Iterator begin() const { return Iterator(text.data(), text.data() + text.size()); }
+        Iterator end() const { return Iterator(text.data() + text.size(), text.data() + text.size()); }
+        bool empty() const { return text.empty(); }
+    private:
+        //the tokens, each followed by a blank
+        string_view							text;
+    };
+    
+    TokenArena();
+    TokenArena(const TokenArena& orig) = delete;
+    TokenArena& operator =(const TokenArena& rightSide) = delete;
+    TokenArena(TokenArena&& orig) = default;
+    TokenArena& operator =(TokenArena&& rightSide) = default;
+    virtual ~TokenArena();
+    
+    /**
+     * getter for the number of texts, once the arena is finished
+     * @return the number of texts
+     */
+     size_t size() const { return offsets.size() - 1; }
+    
+    /**
+     * getter for a text of a finished arena
+     * @param id is the id of the text
+     * @return a view of its tokens, each followed by a blank
+     */
+     string_view getText(size_t id) const { 
+         return string_view(characters.data() + offsets[id], offsets[id + 1] - offsets[id]); 
+     }
+    
+    /**
+     * getter for the tokens of a text of a finished arena
+     * @param id is the id of the text
+     * @return the tokens
+     */
+     Tokens getTokens(size_t id) const { return Tokens(getText(id)); }
+    
+    /**
+     * getters for the storage of a finished arena. Offsets have size() + 1
+     * entries, the start of each text in characters and the end of the last one
+     */
+     string_view getCharacters() const { return characters; }
+     const uint64_t* getOffsets() const { return offsets.data(); }
+    
+    /**
+     * it computes the bytes which the arena takes
+     * @return the bytes of its storage
+     */
+    size_t getMemoryUsage() const;
+    
+    /**
+     * it reserves the characters of the tokens to be added
+     * @param nBytes is the number of bytes of the tokens and their blanks
+     */
+    void reserve(size_t nBytes) { characters.reserve(nBytes); }
+    
+    /**
+     * it starts a text, to which the tokens added next belong. A text whose
+     * id was started before gets the tokens after its former ones
+     * @param id is the id of the text
+     */
+    void startText(size_t id);
+    
+    /**
+     * it adds a token to the last started text, or to text 0 if no text was started
+     * @param token is the token, without blanks
+     */
+    void addToken(string_view token);
+    
+    /**
+     * it adds the texts of an arena which is not finished after the ones
+     * of this arena, as if their tokens were added to it
+     * @param other is the arena
+     */
+    void append(const TokenArena& other);
+    
+    /**
+     * it puts the texts in order of their ids, so that they can be read.
+     * The texts whose ids were never started are empty
+     * @param nTexts is the least number of texts, ids from 0 to nTexts - 1
+     */
+    void finish(size_t nTexts);
+private:
+    //the tokens of a text added at once, before the arena is finished
+    struct Part {
+        size_t								id;
+        uint64_t							start;
+        uint64_t							end;
+    };
+    
+    //the tokens of all the texts, each followed by a blank
+    string									characters;
+    //the start of each text in characters followed
+    //by the end of the last text
+    vector<uint64_t>							offsets;
+    //the parts of the texts in the order they were added,
+    //until the arena is finished
+    vector<Part>								parts;
+};
+
+#endif /* TOKENARENA_H */
@@ -0,0 +1,270 @@
+/*
+ * The MIT License
+ *
+ * Copyright 2017 Theomeli.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/* 
+ * File:   TokenNormalizer.cpp
+ * Author: Theomeli
+ * 
+ * Created on October 18, 2026, 10:20 AM
+ */
+
+#include "TokenNormalizer.h"
+#include <cstring>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+const array<unsigned char, 256> TokenNormalizer::classes = TokenNormalizer::makeClasses();
+TokenNormalizer::Kernel TokenNormalizer::kernel = TokenNormalizer::detectKernel();
+
+
+array<unsigned char, 256> TokenNormalizer::makeClasses() {
+    array<unsigned char, 256> temp;
+    temp.fill(KEEP);
+    for (int c = 'A'; c <= 'Z'; c++)
+        temp[c] = UPPER;
+    for (unsigned char c : string(",;:.?!'\" \n")) //includes a blank
+        temp[c] = PUNCT;
+    
+    return temp;
+}
+
+
+TokenNormalizer::Kernel TokenNormalizer::detectKernel() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        return AVX2;
+    if (__builtin_cpu_supports("sse2"))
+        return SSE2;
+#endif
+    return SCALAR;
+}
+
+
+void TokenNormalizer::setKernel(Kernel k) {
+    Kernel best = detectKernel();
+    kernel = k < best ? k : best;
+}
+
+
+string_view TokenNormalizer::normalize(string_view token, string& scratch) {
+    size_t i = findChange(token.data(), token.size());
+    if (i == token.size())
+        return token;
+    
+    //the token changes from position i on
+    scratch.resize(token.size());
+    memcpy(&scratch[0], token.data(), i);
+    scratch.resize(i + normalize(token.data() + i, token.size() - i, &scratch[i]));
+    
+    return scratch;
+}
+
+
+size_t TokenNormalizer::normalize(const char* in, size_t n, char* out) {
+    //most words are shorter than a block of the vector kernels
+    if (n < 16)
+        return normalizeScalar(in, n, out);
+    switch (kernel) {
+#if defined(__x86_64__) || defined(__i386__)
+        case AVX2:
+            return normalizeAvx2(in, n, out);
+        case SSE2:
+            return normalizeSse2(in, n, out);
+#endif
+        default:
+            return normalizeScalar(in, n, out);
+    }
+}
+
+
+size_t TokenNormalizer::findChange(const char* in, size_t n) {
+    if (n < 16)
+        return findChangeScalar(in, n);
+    switch (kernel) {
+#if defined(__x86_64__) || defined(__i386__)
+        case AVX2:
+            return findChangeAvx2(in, n);
+        case SSE2:
+            return findChangeSse2(in, n);
+#endif
+        default:
+            return findChangeScalar(in, n);
+    }
+}
+
+
+size_t TokenNormalizer::normalizeScalar(const char* in, size_t n, char* out) {
+    size_t o = 0;
+    for (size_t i = 0; i < n; i++) {
+        unsigned char c = in[i];
+        switch (classes[c]) {
+            case KEEP:
+                out[o++] = c;
+                break;
+            case UPPER:
+                out[o++] = c + ('a' - 'A');
+                break;
+        }
+    }
+    
+    return o;
+}
+
+
+size_t TokenNormalizer::findChangeScalar(const char* in, size_t n) {
+    size_t i = 0;
+    while (i < n && classes[(unsigned char)in[i]] == KEEP)
+        i++;
+    
+    return i;
+}
+
+
+#if defined(__x86_64__) || defined(__i386__)
+//the masks of the upper case and punctuation bytes of a block. The
+//comparisons are signed, so bytes above 127 are never upper case
+#define UPPER_MASK(set1, cmpgt, andOp, c) \
+    andOp(cmpgt(c, set1('A' - 1)), cmpgt(set1('Z' + 1), c))
+#define PUNCT_MASK(set1, cmpeq, orOp, c) \
+    orOp(orOp(orOp(orOp(cmpeq(c, set1(',')), cmpeq(c, set1(';'))), orOp(cmpeq(c, set1(':')), cmpeq(c, set1('.')))), \
+        orOp(orOp(cmpeq(c, set1('?')), cmpeq(c, set1('!'))), orOp(cmpeq(c, set1('\'')), cmpeq(c, set1('"'))))), \
+        orOp(cmpeq(c, set1(' ')), cmpeq(c, set1('\n'))))
+
+
+__attribute__((target("sse2")))
+size_t TokenNormalizer::normalizeSse2(const char* in, size_t n, char* out) {
+    size_t i = 0;
+    size_t o = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i c = _mm_loadu_si128((const __m128i*)(in + i));
+        __m128i upper = UPPER_MASK(_mm_set1_epi8, _mm_cmpgt_epi8, _mm_and_si128, c);
+        __m128i lowered = _mm_add_epi8(c, _mm_and_si128(upper, _mm_set1_epi8('a' - 'A')));
+        unsigned punct = _mm_movemask_epi8(PUNCT_MASK(_mm_set1_epi8, _mm_cmpeq_epi8, _mm_or_si128, c));
+        //out is never ahead of in, so a whole block may be stored
+        if (punct == 0) {
+            _mm_storeu_si128((__m128i*)(out + o), lowered);
+            o += 16;
+        }
+        else {
+            alignas(16) char block[16];
+            _mm_store_si128((__m128i*)block, lowered);
+            for (size_t j = 0; j < 16; j++)
+                if (!(punct >> j & 1))
+                    out[o++] = block[j];
+        }
+    }
+    
+    return o + normalizeScalar(in + i, n - i, out + o);
+}
+
+
+__attribute__((target("sse2")))
+size_t TokenNormalizer::findChangeSse2(const char* in, size_t n) {
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i c = _mm_loadu_si128((const __m128i*)(in + i));
+        __m128i change = _mm_or_si128(UPPER_MASK(_mm_set1_epi8, _mm_cmpgt_epi8, _mm_and_si128, c), 
+            PUNCT_MASK(_mm_set1_epi8, _mm_cmpeq_epi8, _mm_or_si128, c));
+        unsigned mask = _mm_movemask_epi8(change);
+        if (mask != 0)
+            return i + __builtin_ctz(mask);
+    }
+    
+    return i + findChangeScalar(in + i, n - i);
+}
+
+
+__attribute__((target("avx2")))
+size_t TokenNormalizer::normalizeAvx2(const char* in, size_t n, char* out) {
+    size_t i = 0;
+    size_t o = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i c = _mm256_loadu_si256((const __m256i*)(in + i));
+        __m256i upper = UPPER_MASK(_mm256_set1_epi8, _mm256_cmpgt_epi8, _mm256_and_si256, c);
+        __m256i lowered = _mm256_add_epi8(c, _mm256_and_si256(upper, _mm256_set1_epi8('a' - 'A')));
+        unsigned punct = _mm256_movemask_epi8(PUNCT_MASK(_mm256_set1_epi8, _mm256_cmpeq_epi8, _mm256_or_si256, c));
+        //out is never ahead of in, so a whole block may be stored
+        if (punct == 0) {
+            _mm256_storeu_si256((__m256i*)(out + o), lowered);
+            o += 32;
+        }
+        else {
+            alignas(32) char block[32];
+            _mm256_store_si256((__m256i*)block, lowered);
+            for (size_t j = 0; j < 32; j++)
+                if (!(punct >> j & 1))
+                    out[o++] = block[j];
+        }
+    }
+    
+    //the tail is not handed to normalizeSse2, whose legacy encoded
+    //instructions would stall after the 256 bit ones
+    for (; i + 16 <= n; i += 16) {
+        __m128i c = _mm_loadu_si128((const __m128i*)(in + i));
+        __m128i upper = UPPER_MASK(_mm_set1_epi8, _mm_cmpgt_epi8, _mm_and_si128, c);
+        __m128i lowered = _mm_add_epi8(c, _mm_and_si128(upper, _mm_set1_epi8('a' - 'A')));
+        unsigned punct = _mm_movemask_epi8(PUNCT_MASK(_mm_set1_epi8, _mm_cmpeq_epi8, _mm_or_si128, c));
+        if (punct == 0) {
+            _mm_storeu_si128((__m128i*)(out + o), lowered);
+            o += 16;
+        }
+        else {
+            alignas(16) char block[16];
+            _mm_store_si128((__m128i*)block, lowered);
+            for (size_t j = 0; j < 16; j++)
+                if (!(punct >> j & 1))
+                    out[o++] = block[j];
+        }
+    }
+    
+    return o + normalizeScalar(in + i, n - i, out + o);
+}
+
+
+__attribute__((target("avx2")))
+size_t TokenNormalizer::findChangeAvx2(const char* in, size_t n) {
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i c = _mm256_loadu_si256((const __m256i*)(in + i));
+        __m256i change = _mm256_or_si256(UPPER_MASK(_mm256_set1_epi8, _mm256_cmpgt_epi8, _mm256_and_si256, c), 
+            PUNCT_MASK(_mm256_set1_epi8, _mm256_cmpeq_epi8, _mm256_or_si256, c));
+        unsigned mask = _mm256_movemask_epi8(change);
+        if (mask != 0)
+            return i + __builtin_ctz(mask);
+    }
+    
+    for (; i + 16 <= n; i += 16) {
+        __m128i c = _mm_loadu_si128((const __m128i*)(in + i));
+        __m128i change = _mm_or_si128(UPPER_MASK(_mm_set1_epi8, _mm_cmpgt_epi8, _mm_and_si128, c), 
+            PUNCT_MASK(_mm_set1_epi8, _mm_cmpeq_epi8, _mm_or_si128, c));
+        unsigned mask = _mm_movemask_epi8(change);
+        if (mask != 0)
+            return i + __builtin_ctz(mask);
+    }
+    
+    return i + findChangeScalar(in + i, n - i);
+}
+#endif
@@ -0,0 +1,126 @@
+/*
+ * The MIT License
+ *
+ * Copyright 2017 Theomeli.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/* 
+ * File:   TokenNormalizer.h
+ * Author: Theomeli
+ *
+ * Created on October 18, 2026, 10:20 AM
+ */
+
+#ifndef TOKENNORMALIZER_H
+#define TOKENNORMALIZER_H
+#include <cstddef>
+#include <array>
+#include <string>
+#include <string_view>
+
+using namespace std;
+
+/**
+ * it transforms tokens to their lower case and removes their punctuation
+ * in a single pass. Each byte is classified by a table of 256 entries and,
+ * on x86, blocks of 16 or 32 bytes are handled with SSE2 or AVX2, chosen
+ * once at runtime. The result is the same as lowering the token with 
+ * tolower and then removing the characters ,;:.?!'" blank and newline
+ */
+class TokenNormalizer {
+public:
+    //the kernels which may normalize the bytes
+    enum Kernel { SCALAR, SSE2, AVX2 };
+    
+    /**
+     * getter for the kernel chosen for this processor
+     * @return the kernel used by normalize
+     */
+     static Kernel getKernel() { return kernel; }
+    
+    /**
+     * it chooses the kernel used by normalize. A kernel the processor does
+     * not support falls back to the best one it supports
+     * @param k is the kernel to be used
+     */
+    static void setKernel(Kernel k);
+    
+    /**
+     * it normalizes a token. A token which needs no change is returned as
+     * it is, so no byte is copied
+     * @param token is the token to be normalized
+     * @param scratch is the buffer where a changed token is written
+     * @return a view to token or to scratch
+     */
+    static string_view normalize(string_view token, string& scratch);
+    
+    /**
+     * it normalizes a sequence of bytes
+     * @param in is the start of the bytes
+     * @param n is the number of bytes
+     * @param out is where the normalized bytes are written, at most n
+     * @return the number of bytes written to out
+     */
+    static size_t normalize(const char* in, size_t n, char* out);
+private:
+    //the class of a byte: kept as it is, lowered or removed
+    enum ByteClass { KEEP, UPPER, PUNCT };
+    
+    //the class of each byte
+    static const array<unsigned char, 256>					classes;
+    //the kernel chosen for this processor
+    static Kernel								kernel;
+    
+    /**
+     * it finds the first byte which is upper case or punctuation
+     * @param in is the start of the bytes
+     * @param n is the number of bytes
+     * @return the position of the byte or n if there is none
+     */
+    static size_t findChange(const char* in, size_t n);
+    
+    /**
+     * the kernels of normalize and findChange
+     */
+    static size_t normalizeScalar(const char* in, size_t n, char* out);
+    static size_t findChangeScalar(const char* in, size_t n);
+#if defined(__x86_64__) || defined(__i386__)
+    static size_t normalizeSse2(const char* in, size_t n, char* out);
+    static size_t findChangeSse2(const char* in, size_t n);
+    static size_t normalizeAvx2(const char* in, size_t n, char* out);
+    static size_t findChangeAvx2(const char* in, size_t n);
+#endif
+    
+    /**
+     * it builds the table of the bytes' classes
+     * @return the class of each byte
+     */
+    static array<unsigned char, 256> makeClasses();
+    
+    /**
+     * it finds the best kernel the processor supports
+     * @return the kernel
+     */
+    static Kernel detectKernel();
+};
+
+#endif /* TOKENNORMALIZER_H */
+
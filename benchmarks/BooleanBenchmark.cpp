@@ -0,0 +1,247 @@
+/*
+ * The MIT License
+ *
+ * Copyright 2017 Theomeli.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+/* 
+ * File:   BooleanBenchmark.cpp
+ * Author: Theomeli
+ *
+ * Created on October 26, 2026, 6:30 PM
+ *
+ * It measures the intersection of two sets of documents by DocumentSets with
+ * each of its kernels and by galloping, for sets of several ratios of sizes,
+ * against std::set_intersection, checking that all of them give the same set.
+ * Then it indexes a synthetic collection made by CorpusGenerator and evaluates
+ * the queries of the collection as Boolean queries joining their words by AND,
+ * reporting their latency and the documents scored against the same words
+ * ranked over the whole collection, and checks that queries nested or long
+ * beyond the bounds of BooleanQuery return no documents:
+ *     ./booleanBenchmark --documents 100000 --vocabulary 50000 --zipf 1.0 \
+ *         --document-length 100 --queries 1000 --query-length 3 --responses 10
+ * Every option may be left out. The files of the collection are written to
+ * the current directory and removed at the end. Built by the booleanBenchmark
+ * target of CMakeLists.txt.
+ */
+
+#include "CorpusGenerator.h"
+#include "TextRetrievalEngine.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+
+using namespace std;
+
+
+/**
+ * it finds a percentile of sorted samples, by the nearest rank
+ */
+double getPercentile(const vector<double>& sorted, double percentile) {
+    size_t rank = size_t(percentile / 100 * sorted.size() + 0.999999);
+    
+    return sorted[min(sorted.size(), max(size_t(1), rank)) - 1];
+}
+
+
+/**
+ * it draws a set of documents, each id taken with a probability
+ */
+vector<uint32_t> makeSet(mt19937& random, size_t nDocuments, double probability) {
+    bernoulli_distribution isTaken(probability);
+    vector<uint32_t> docIds;
+    for (uint32_t docId = 1; docId <= nDocuments; docId++)
+        if (isTaken(random))
+            docIds.push_back(docId);
+    
+    return docIds;
+}
+
+
+/**
+ * it runs an intersection until enough time has passed
+ * @return the microseconds of one intersection
+ */
+template<class Intersection>
+double measure(Intersection intersect) {
+    size_t checksum = 0;
+    size_t rounds = 0;
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    chrono::duration<double> elapsed;
+    do {
+        checksum += intersect();
+        rounds++;
+        elapsed = chrono::steady_clock::now() - start;
+    } while (elapsed.count() < 0.3);
+    //the checksum keeps the compiler from dropping the work
+    if (checksum == 1)
+        cout << ' ';
+    
+    return elapsed.count() / rounds * 1e6;
+}
+
+
+int main(int argc, char** argv) {
+    CorpusGenerator::Options options;
+    options.nDocuments = 100000;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        string argument = argv[i];
+        const char* value = argv[i + 1];
+        if (argument == "--documents")
+            options.nDocuments = strtoull(value, nullptr, 10);
+        else if (argument == "--vocabulary")
+            options.vocabularySize = strtoull(value, nullptr, 10);
+        else if (argument == "--zipf")
+            options.exponent = atof(value);
+        else if (argument == "--document-length")
+            options.documentLength = strtoull(value, nullptr, 10);
+        else if (argument == "--queries")
+            options.nQueries = strtoull(value, nullptr, 10);
+        else if (argument == "--query-length")
+            options.queryLength = strtoull(value, nullptr, 10);
+        else if (argument == "--responses")
+            options.nResponses = strtoull(value, nullptr, 10);
+        else {
+            cout << "unknown option " << argument << endl;
+            return 1;
+        }
+    }
+    
+    //the sets are drawn from one million documents, the larger one holding 30% of them
+    const char* kernelNames[] = { "scalar", "sse2" };
+    DocumentSets::Kernel best = DocumentSets::getKernel();
+    mt19937 random(17);
+    cout << "intersection of sets of 1000000 documents, microseconds" << endl;
+    cout << setw(10) << left << "sizes" << setw(18) << right << "set_intersection";
+    for (int k = DocumentSets::SCALAR; k <= best; k++)
+        cout << setw(10) << kernelNames[k];
+    cout << setw(10) << "gallop" << endl;
+    for (double ratio : { 1.0, 4.0, 32.0, 1000.0 }) {
+        vector<uint32_t> large = makeSet(random, 1000000, 0.3), small = makeSet(random, 1000000, 0.3 / ratio);
+        vector<uint32_t> expected, out;
+        double former = measure([&]() {
+            expected.clear();
+            set_intersection(small.begin(), small.end(), large.begin(), large.end(), back_inserter(expected));
+            return expected.size();
+        });
+        cout << setw(10) << left << ("1:" + to_string(int(ratio))) << fixed << setprecision(1) << right 
+            << setw(18) << former;
+        //the kernels merge sets whose sizes are within GALLOP_RATIO, else intersect gallops with any of them
+        for (int k = DocumentSets::SCALAR; k <= best; k++) {
+            DocumentSets::setKernel(DocumentSets::Kernel(k));
+            cout << setw(10) << measure([&]() {
+                DocumentSets::intersect(small, large, out);
+                return out.size();
+            });
+            if (out != expected) {
+                cout << endl << kernelNames[k] << " kernel differs" << endl;
+                return 1;
+            }
+        }
+        DocumentSets::setKernel(best);
+        cout << setw(10) << measure([&]() {
+            out.clear();
+            const uint32_t* position = large.data();
+            for (auto const docId : small) {
+                position = DocumentSets::gallop(position, large.data() + large.size(), docId);
+                if (position != large.data() + large.size() && *position == docId)
+                    out.push_back(docId);
+            }
+            return out.size();
+        }) << endl;
+        if (out != expected) {
+            cout << "gallop differs" << endl;
+            return 1;
+        }
+    }
+    cout << endl;
+    
+    string documentsFileName = "benchmarkDocuments.txt", queriesFileName = "benchmarkQueries.txt";
+    CorpusGenerator generator(options);
+    if (!generator.write(documentsFileName, queriesFileName)) {
+        cout << "corpus files writing failed." << endl;
+        return 1;
+    }
+    QueryExecutor executor(0);
+    
+    //the index of the documents only, as the server has it
+    ProcessFiles documents(documentsFileName, "");
+    IndexBuilder builder;
+    documents.readDocumentsFile(documents.getDocumentsMapping(), builder, executor);
+    TextRetrievalEngine t(move(documents));
+    t.computeFrequencies(move(builder));
+    t.initializeIdfs();
+    t.computeDocsWeight(false);
+    
+    //the queries file gives the words of the queries
+    ProcessFiles p(documentsFileName, queriesFileName);
+    p.readQueriesFile(p.getQueriesMapping());
+    remove(documentsFileName.c_str());
+    remove(queriesFileName.c_str());
+    size_t nQueries = p.getNQueries();
+    cout << options.nDocuments << " documents, " << t.getLexicon().size() << " terms, " << nQueries << " queries of " 
+        << options.queryLength << " words, top " << options.nResponses << endl;
+    cout << setw(12) << left << "queries" << setw(12) << right << "mean ms" << setw(12) << "p50 ms" 
+        << setw(12) << "p99 ms" << setw(20) << "documents scored" << endl;
+    for (string join : { " ", " AND " }) {
+        vector<double> samples;
+        uint64_t scored = Instrumentation::get(Instrumentation::DOCUMENTS_SCORED);
+        for (size_t queryId = 1; queryId <= nQueries; queryId++) {
+            string text;
+            for (auto const token : p.getQueriesTokens().getTokens(queryId))
+                text += (text.empty() ? "" : join) + string(token);
+            chrono::steady_clock::time_point start = chrono::steady_clock::now();
+            t.search(text, options.nResponses);
+            samples.push_back(chrono::duration<double>(chrono::steady_clock::now() - start).count());
+        }
+        scored = Instrumentation::get(Instrumentation::DOCUMENTS_SCORED) - scored;
+        sort(samples.begin(), samples.end());
+        double total = 0;
+        for (auto const sample : samples)
+            total += sample;
+        cout << setw(12) << left << (join == " " ? "ranked" : "AND") << fixed << setprecision(3) << right 
+            << setw(12) << total / samples.size() * 1e3 << setw(12) << getPercentile(samples, 50) * 1e3 
+            << setw(12) << getPercentile(samples, 99) * 1e3 << setw(19) << setprecision(2) 
+            << 100.0 * scored / nQueries / options.nDocuments << "%" << endl;
+    }
+    
+    //texts beyond the bounds of the parser must return no documents, not
+    //overflow the stack. The first one crashed a server before the bounds
+    string nots = "aa AND ", parentheses;
+    for (size_t i = 0; i < 100000; i++)
+        nots += "NOT ";
+    nots += "aa";
+    parentheses.assign(200000, '(');
+    parentheses += "aa AND aa";
+    string deep = "aa AND ";
+    for (size_t i = 0; i <= BooleanQuery::MAX_DEPTH; i++)
+        deep += "( ";
+    deep += "aa";
+    for (auto const &text : { nots, parentheses, deep })
+        if (!t.search(text, options.nResponses).empty()) {
+            cout << "a query beyond the bounds of the parser returned documents" << endl;
+            return 1;
+        }
+    cout << "queries beyond the bounds of the parser: none answered" << endl;
+}
@@ -0,0 +1,128 @@
+/*
+ * The MIT License
+ *
+ * Copyright 2017 Theomeli.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/* 
+ * File:   CorpusGenerator.cpp
+ * Author: Theomeli
+ * 
+ * Created on October 20, 2026, 10:30 AM
+ */
+
+#include "CorpusGenerator.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+
+CorpusGenerator::CorpusGenerator(const Options& options)
+    :options(options), random(options.seed), cumulative(max(size_t(1), options.vocabularySize)) {
+    double sum = 0;
+    for (size_t i = 0; i < cumulative.size(); i++) {
+        sum += 1 / pow(i + 1, options.exponent);
+        cumulative[i] = sum;
+    }
+    for (auto &ent1 : cumulative)
+        ent1 /= sum;
+    for (size_t i = 0; i < cumulative.size(); i++)
+        words.push_back(getWord(i));
+}
+
+
+CorpusGenerator::~CorpusGenerator() {
+}
+
+
+string CorpusGenerator::getWord(size_t rank) {
+    //the ranks are written in base 26, the words of two letters first
+    string word;
+    size_t n = rank + 26;
+    do {
+        word += char('a' + n % 26);
+        n /= 26;
+    } while (n > 0);
+    word[word.size() - 1]--;
+    
+    return word;
+}
+
+
+size_t CorpusGenerator::drawRank() {
+    double u = uniform_real_distribution<double>(0, 1)(random);
+    
+    return min(size_t(lower_bound(cumulative.begin(), cumulative.end(), u) - cumulative.begin()), cumulative.size() - 1);
+}
+
+
+void CorpusGenerator::appendWord(size_t rank, string& text) {
+    static const char punct[] = ",;:.?!";
+    size_t start = text.size();
+    text += words[rank];
+    uint64_t percent = random() % 100;
+    if (percent < 5)
+        text[start] = toupper(text[start]);
+    else if (percent < 15)
+        text += punct[random() % 6];
+}
+
+
+string CorpusGenerator::makeDocuments() {
+    string text = to_string(options.nDocuments) + '\n';
+    size_t minLength = (options.documentLength + 1) / 2;
+    uniform_int_distribution<size_t> length(minLength, options.documentLength + options.documentLength / 2);
+    for (size_t docId = 1; docId <= options.nDocuments; docId++) {
+        text += to_string(docId);
+        for (size_t i = length(random); i > 0; i--) {
+            text += ' ';
+            appendWord(drawRank(), text);
+        }
+        text += '\n';
+    }
+    
+    return text;
+}
+
+
+string CorpusGenerator::makeQueries() {
+    string text = to_string(options.nQueries) + '\n';
+    for (size_t queryId = 1; queryId <= options.nQueries; queryId++) {
+        text += to_string(queryId) + ' ' + to_string(options.nResponses);
+        for (size_t i = 0; i < options.queryLength; i++) {
+            text += ' ';
+            appendWord(drawRank(), text);
+        }
+        text += '\n';
+    }
+    
+    return text;
+}
+
+
+bool CorpusGenerator::write(const string& documentsFileName, const string& queriesFileName) {
+    ofstream documents(documentsFileName, ios::binary);
+    documents << makeDocuments();
+    ofstream queries(queriesFileName, ios::binary);
+    queries << makeQueries();
+    
+    return documents.good() && queries.good();
+}
+
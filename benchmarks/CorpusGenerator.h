@@ -0,0 +1,141 @@
+/*
+ * The MIT License
+ *
+ * Copyright 2017 Theomeli.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/* 
+ * File:   CorpusGenerator.h
+ * Author: Theomeli
+ *
+ * Created on October 20, 2026, 10:30 AM
+ */
+
+#ifndef CORPUSGENERATOR_H
+#define CORPUSGENERATOR_H
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/**
+ * it makes synthetic documents and queries files in the format which
+ * ProcessFiles reads. The words are drawn from a vocabulary with probability
+ * proportional to 1/rank^s, as the words of a natural language follow Zipf's 
+ * law, and some of them are capitalized or followed by punctuation, so that
+ * they are normalized as the ones of a real text. The same options and seed
+ * always give the same files
+ */
+class CorpusGenerator {
+public:
+    /**
+     * the options of a collection
+     */
+    struct Options {
+        //the number of documents
+        size_t nDocuments = 10000;
+        //the number of distinct words
+        size_t vocabularySize = 50000;
+        //the exponent s of Zipf's law
+        double exponent = 1.0;
+        //the mean number of words of a document, the lengths
+        //are uniform from half of it to one and a half of it
+        size_t documentLength = 100;
+        //the number of queries
+        size_t nQueries = 1000;
+        //the number of words of a query
+        size_t queryLength = 3;
+        //the number of documents a query asks for
+        size_t nResponses = 10;
+        //the seed of the random numbers
+        uint64_t seed = 17;
+    };
+    
+    CorpusGenerator(const Options& options);
+    CorpusGenerator(const CorpusGenerator& orig) = delete;
+    CorpusGenerator& operator =(const CorpusGenerator& rightSide) = delete;
+    virtual ~CorpusGenerator();
+    
+    /**
+     * getter for private member options
+     * @return the options of the collection
+     */
+     const Options& getOptions() const { return options; }
+    
+    /**
+     * it makes the word of a rank of the vocabulary. Words of different
+     * ranks are different and the most frequent ones are the shortest
+     * @param rank is the rank of the word, from 0
+     * @return the word, of lower case letters
+     */
+    static string getWord(size_t rank);
+    
+    /**
+     * it draws a word from the vocabulary, following Zipf's law, for the
+     * benchmarks which need the ranks of the words instead of a text
+     * @return the rank of the word
+     */
+    size_t drawRank();
+    
+    /**
+     * it makes the content of the documents file
+     * @return the number of documents followed by a line for each document
+     */
+    string makeDocuments();
+    
+    /**
+     * it makes the content of the queries file
+     * @return the number of queries followed by a line for each query
+     */
+    string makeQueries();
+    
+    /**
+     * it writes the documents and the queries files
+     * @param documentsFileName is the path of the documents file
+     * @param queriesFileName is the path of the queries file
+     * @return false if a file could not be written
+     */
+    bool write(const string& documentsFileName, const string& queriesFileName);
+private:
+    //the options of the collection
+    Options									options;
+    //the random numbers
+    mt19937_64								random;
+    //the probability of the ranks up to each one, 
+    //from 0 to 1
+    vector<double>								cumulative;
+    //the words of the vocabulary by rank
+    vector<string>								words;
+    
+    /**
+     * it appends a word as it could appear in a text, sometimes
+     * capitalized or followed by punctuation
+     * @param rank is the rank of the word
+     * @param text is the text to append to
+     */
+    void appendWord(size_t rank, string& text);
+};
+
+#endif /* CORPUSGENERATOR_H */
+
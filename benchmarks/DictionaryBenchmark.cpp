@@ -0,0 +1,244 @@
+/*
+ * The MIT License
+ *
+ * Copyright 2017 Theomeli.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+/* 
+ * File:   DictionaryBenchmark.cpp
+ * Author: Theomeli
+ *
+ * Created on October 27, 2026, 11:10 AM
+ *
+ * It measures the memory of the terms of a vocabulary kept in a std::set of
+ * strings, in the Lexicon and in a TermDictionary, and the time of a lookup,
+ * of finding a term by its id and of finding the terms of a prefix by each of
+ * them, checking that the dictionary gives the terms of the lexicon. The terms
+ * are the words of the vocabulary of CorpusGenerator or the normalized tokens
+ * of a text file:
+ *     ./dictionaryBenchmark --vocabulary 200000 --prefixes 1000
+ *     ./dictionaryBenchmark --words text.txt
+ * Every option may be left out. The memory is the growth of the bytes which
+ * malloc gives out, so it counts the overhead of each allocation. Built by
+ * the dictionaryBenchmark target of CMakeLists.txt.
+ */
+
+#include "CorpusGenerator.h"
+#include "TermDictionary.h"
+#include "TokenNormalizer.h"
+#include "ProcessFiles.h"
+#include <malloc.h>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <iterator>
+#include <random>
+#include <set>
+
+using namespace std;
+
+
+/**
+ * getter for the bytes which malloc has given out and not taken back
+ */
+size_t getAllocatedBytes() {
+    return mallinfo2().uordblks;
+}
+
+
+/**
+ * it runs a function over some inputs until enough time has passed
+ * @return the nanoseconds of one call
+ */
+template<class Input, class Function>
+double measure(const vector<Input>& inputs, Function function) {
+    size_t checksum = 0;
+    size_t rounds = 0;
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    chrono::duration<double> elapsed;
+    do {
+        for (auto const &input : inputs)
+            checksum += function(input);
+        rounds++;
+        elapsed = chrono::steady_clock::now() - start;
+    } while (elapsed.count() < 0.5);
+    //the checksum keeps the compiler from dropping the work
+    if (checksum == 1)
+        cout << ' ';
+    
+    return elapsed.count() / rounds / inputs.size() * 1e9;
+}
+
+
+int main(int argc, char** argv) {
+    size_t vocabularySize = 200000, nPrefixes = 1000;
+    string wordsFileName;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        string argument = argv[i];
+        const char* value = argv[i + 1];
+        if (argument == "--vocabulary")
+            vocabularySize = strtoull(value, nullptr, 10);
+        else if (argument == "--prefixes")
+            nPrefixes = strtoull(value, nullptr, 10);
+        else if (argument == "--words")
+            wordsFileName = value;
+        else {
+            cout << "unknown option " << argument << endl;
+            return 1;
+        }
+    }
+    
+    vector<string> words;
+    if (wordsFileName.empty())
+        for (size_t rank = 0; rank < vocabularySize; rank++)
+            words.push_back(CorpusGenerator::getWord(rank));
+    else {
+        ifstream wordsFile(wordsFileName, ios::binary);
+        if (!wordsFile) {
+            cout << "words file opening failed." << endl;
+            return 1;
+        }
+        string text((istreambuf_iterator<char>(wordsFile)), istreambuf_iterator<char>()), scratch;
+        size_t position = 0;
+        string_view token;
+        while (ProcessFiles::nextToken(text, position, text.size(), token)) {
+            token = TokenNormalizer::normalize(token, scratch);
+            if (!token.empty() && !isdigit((unsigned char)token[0]))
+                words.push_back(string(token));
+        }
+    }
+    
+    //each structure is measured by the bytes it takes from malloc
+    size_t before = getAllocatedBytes();
+    set<string> terms(words.begin(), words.end());
+    size_t setBytes = getAllocatedBytes() - before;
+    before = getAllocatedBytes();
+    Lexicon lexicon;
+    for (auto const &word : words)
+        lexicon.intern(word);
+    size_t lexiconBytes = getAllocatedBytes() - before;
+    before = getAllocatedBytes();
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    TermDictionary dictionary(lexicon);
+    double buildTime = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    size_t dictionaryBytes = getAllocatedBytes() - before;
+    vector<string>().swap(words);
+    
+    size_t nTerms = lexicon.size(), nCharacters = lexicon.getCharacters().size();
+    cout << nTerms << " terms of " << fixed << setprecision(1) << double(nCharacters) / nTerms << " bytes on average, " 
+        << "the dictionary built in " << setprecision(1) << buildTime * 1e3 << " ms" << endl;
+    cout << setw(16) << left << "memory" << setw(12) << right << "MB" << setw(16) << "bytes/term" << endl;
+    for (auto const &row : { make_pair("std::set", setBytes), make_pair("Lexicon", lexiconBytes), 
+        make_pair("TermDictionary", dictionaryBytes) })
+        cout << setw(16) << left << row.first << setw(12) << right << setprecision(2) << row.second / 1e6 
+            << setw(16) << setprecision(1) << double(row.second) / nTerms << endl;
+    cout << endl;
+    
+    //the dictionary must give the lexicon's terms and ids
+    string scratch;
+    vector<string_view> all;
+    vector<uint32_t> termIds(nTerms);
+    for (uint32_t termId = 0; termId < nTerms; termId++) {
+        string_view term = lexicon.getTerm(termId);
+        if (dictionary.find(term) != termId || dictionary.getTerm(termId, scratch) != term) {
+            cout << "the dictionary differs on " << term << endl;
+            return 1;
+        }
+        all.push_back(term);
+        termIds[termId] = termId;
+    }
+    mt19937 random(17);
+    shuffle(termIds.begin(), termIds.end(), random);
+    vector<string> lookups, misses;
+    for (size_t i = 0; i < min(nTerms, size_t(100000)); i++) {
+        lookups.push_back(string(lexicon.getTerm(termIds[i])));
+        misses.push_back(lookups.back() + "zq");
+    }
+    for (auto const &miss : misses)
+        if (dictionary.find(miss) != lexicon.find(miss)) {
+            cout << "the dictionary finds " << miss << endl;
+            return 1;
+        }
+    
+    //the prefixes are the first one to three letters of terms
+    vector<string> prefixes;
+    uniform_int_distribution<size_t> length(1, 3);
+    for (size_t i = 0; i < nPrefixes && nTerms > 0; i++) {
+        string_view term = lexicon.getTerm(termIds[i % nTerms]);
+        prefixes.push_back(string(term.substr(0, min(term.size(), length(random)))));
+    }
+    size_t nExpanded = 0;
+    vector<uint32_t> expansions, expected;
+    for (auto const &prefix : prefixes) {
+        dictionary.findPrefix(prefix, expansions);
+        expected.clear();
+        for (uint32_t termId = 0; termId < nTerms; termId++)
+            if (lexicon.getTerm(termId).substr(0, prefix.size()) == prefix)
+                expected.push_back(termId);
+        sort(expected.begin(), expected.end(), [&lexicon](uint32_t a, uint32_t b) { 
+            return lexicon.getTerm(a) < lexicon.getTerm(b); 
+        });
+        if (expansions != expected) {
+            cout << "the dictionary differs on the prefix " << prefix << endl;
+            return 1;
+        }
+        nExpanded += expansions.size();
+    }
+    
+    cout << setw(16) << left << "ns" << setw(12) << right << "found" << setw(12) << "missed" << setw(12) << "term" 
+        << setw(12) << "prefix" << endl;
+    cout << setw(16) << left << "std::set" << setprecision(1) << right 
+        << setw(12) << measure(lookups, [&terms](const string& term) { return terms.count(term); })
+        << setw(12) << measure(misses, [&terms](const string& term) { return terms.count(term); })
+        << setw(12) << "-"
+        << setw(12) << measure(prefixes, [&terms](const string& prefix) {
+            size_t n = 0;
+            for (set<string>::const_iterator i = terms.lower_bound(prefix); i != terms.end() 
+                && i->compare(0, prefix.size(), prefix) == 0; ++i)
+                n++;
+            return n;
+        }) << endl;
+    cout << setw(16) << left << "Lexicon" << right
+        << setw(12) << measure(lookups, [&lexicon](const string& term) { return size_t(lexicon.find(term)); })
+        << setw(12) << measure(misses, [&lexicon](const string& term) { return size_t(lexicon.find(term)); })
+        << setw(12) << measure(termIds, [&lexicon](uint32_t termId) { return lexicon.getTerm(termId).size(); })
+        << setw(12) << measure(prefixes, [&all](const string& prefix) {
+            //the lexicon is not sorted, so all its terms are scanned
+            size_t n = 0;
+            for (auto const &term : all)
+                n += term.substr(0, prefix.size()) == prefix;
+            return n;
+        }) << endl;
+    cout << setw(16) << left << "TermDictionary" << right
+        << setw(12) << measure(lookups, [&dictionary](const string& term) { return size_t(dictionary.find(term)); })
+        << setw(12) << measure(misses, [&dictionary](const string& term) { return size_t(dictionary.find(term)); })
+        << setw(12) << measure(termIds, [&dictionary, &scratch](uint32_t termId) { 
+            return dictionary.getTerm(termId, scratch).size(); 
+        })
+        << setw(12) << measure(prefixes, [&dictionary, &expansions](const string& prefix) { 
+            dictionary.findPrefix(prefix, expansions);
+            return expansions.size();
+        }) << endl;
+    cout << "terms of a prefix on average: " << setprecision(1) << double(nExpanded) / max(size_t(1), prefixes.size()) << endl;
+}
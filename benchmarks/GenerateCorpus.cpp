@@ -0,0 +1,87 @@
+/*
+ * The MIT License
+ *
+ * Copyright 2017 Theomeli.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/* 
+ * File:   GenerateCorpus.cpp
+ * Author: Theomeli
+ *
+ * Created on October 20, 2026, 11:15 AM
+ *
+ * It writes a synthetic documents file and queries file made by
+ * CorpusGenerator, which the engine reads as the files of a real collection:
+ *     ./generateCorpus --documents 100000 --vocabulary 50000 --zipf 1.1 \
+ *         --document-length 100 --queries 1000 --query-length 3 --responses 10 \
+ *         --seed 17 --documents-file documentsText.txt --queries-file queriesText.txt
+ * Every option may be left out. Built by the generateCorpus target of
+ * CMakeLists.txt.
+ */
+
+#include "CorpusGenerator.h"
+#include <cstdlib>
+#include <iostream>
+
+using namespace std;
+
+
+int main(int argc, char** argv) {
+    CorpusGenerator::Options options;
+    string documentsFileName = "documentsText.txt", queriesFileName = "queriesText.txt";
+    for (int i = 1; i + 1 < argc; i += 2) {
+        string argument = argv[i];
+        const char* value = argv[i + 1];
+        if (argument == "--documents")
+            options.nDocuments = strtoull(value, nullptr, 10);
+        else if (argument == "--vocabulary")
+            options.vocabularySize = strtoull(value, nullptr, 10);
+        else if (argument == "--zipf")
+            options.exponent = atof(value);
+        else if (argument == "--document-length")
+            options.documentLength = strtoull(value, nullptr, 10);
+        else if (argument == "--queries")
+            options.nQueries = strtoull(value, nullptr, 10);
+        else if (argument == "--query-length")
+            options.queryLength = strtoull(value, nullptr, 10);
+        else if (argument == "--responses")
+            options.nResponses = strtoull(value, nullptr, 10);
+        else if (argument == "--seed")
+            options.seed = strtoull(value, nullptr, 10);
+        else if (argument == "--documents-file")
+            documentsFileName = value;
+        else if (argument == "--queries-file")
+            queriesFileName = value;
+        else {
+            cout << "unknown option " << argument << endl;
+            return 1;
+        }
+    }
+    
+    CorpusGenerator generator(options);
+    if (!generator.write(documentsFileName, queriesFileName)) {
+        cout << "corpus files writing failed." << endl;
+        return 1;
+    }
+    cout << options.nDocuments << " documents written to " << documentsFileName << ", " 
+        << options.nQueries << " queries written to " << queriesFileName << endl;
+}
+
@@ -0,0 +1,186 @@
+/*
+ * The MIT License
+ *
+ * Copyright 2017 Theomeli.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/* 
+ * File:   NormalizerBenchmark.cpp
+ * Author: Theomeli
+ *
+ * Created on October 18, 2026, 11:45 AM
+ *
+ * It measures the bytes per second which TokenNormalizer normalizes with
+ * each of its kernels against the former makeLower and removePunct of
+ * ProcessFiles, and checks that all of them give the same tokens.
+ * Built by the normalizerBenchmark target of CMakeLists.txt.
+ */
+
+#include "TokenNormalizer.h"
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <vector>
+
+using namespace std;
+
+
+/**
+ * the former ProcessFiles::makeLower
+ */
+string makeLower(const string& s) {
+    size_t sLength = s.length();
+    string temp(s);
+    for (size_t i = 0; i < sLength; i++) {
+        temp[i] = tolower(s[i]);
+    }
+    
+    return temp;
+}
+
+
+/**
+ * the former ProcessFiles::removePunct
+ */
+string removePunct(const string& s, const string& punct) {
+    string noPunct; //initialized to empty string
+    size_t sLength = s.length();
+    for (size_t i = 0; i < sLength; i++) {
+        string aChar = s.substr(i,1); //A one-character string
+        size_t location = punct.find(aChar, 0);
+        //Find location of successive characters of src in punct.
+        if (location == string::npos)
+            noPunct += aChar;//aChar is not in punct, so keep it
+    }
+
+    return noPunct;
+}
+
+
+/**
+ * the former ProcessFiles::lowerRemovedPunct
+ */
+string lowerRemovedPunct(const string& s) {
+    string punct(",;:.?!'\" \n"); //includes a blank
+    string str(s);
+    str = makeLower(str);
+    
+    return removePunct(str, punct);
+}
+
+
+/**
+ * it makes tokens of words of a given length range, some of them
+ * capitalized or followed by punctuation, like the ones of a text
+ */
+vector<string> makeTokens(size_t nTokens, size_t minLength, size_t maxLength) {
+    mt19937 random(17);
+    uniform_int_distribution<size_t> length(minLength, maxLength);
+    uniform_int_distribution<int> letter('a', 'z');
+    uniform_int_distribution<int> percent(0, 99);
+    const string punct(",;:.?!'\"");
+    vector<string> tokens;
+    for (size_t i = 0; i < nTokens; i++) {
+        string token;
+        for (size_t j = length(random); j > 0; j--)
+            token += char(letter(random));
+        if (percent(random) < 15)
+            token[0] = toupper(token[0]);
+        if (percent(random) < 5)
+            for (auto &c : token)
+                c = toupper(c);
+        if (percent(random) < 20)
+            token += punct[percent(random) % punct.size()];
+        tokens.push_back(token);
+    }
+    
+    return tokens;
+}
+
+
+/**
+ * it runs a normalizer over the tokens until enough time has passed
+ * @return the bytes normalized per second
+ */
+template<class Normalizer>
+double measure(const vector<string>& tokens, Normalizer normalize) {
+    size_t nBytes = 0;
+    for (auto const &token : tokens)
+        nBytes += token.size();
+    
+    size_t checksum = 0;
+    size_t rounds = 0;
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    chrono::duration<double> elapsed;
+    do {
+        for (auto const &token : tokens)
+            checksum += normalize(token);
+        rounds++;
+        elapsed = chrono::steady_clock::now() - start;
+    } while (elapsed.count() < 0.5);
+    //the checksum keeps the compiler from dropping the work
+    if (checksum == 1)
+        cout << ' ';
+    
+    return nBytes * rounds / elapsed.count();
+}
+
+
+int main() {
+    const char* kernelNames[] = { "scalar", "sse2", "avx2" };
+    TokenNormalizer::Kernel best = TokenNormalizer::getKernel();
+    struct { const char* name; size_t minLength, maxLength; } workloads[] = {
+        { "words", 2, 10 },
+        { "long tokens", 32, 256 }
+    };
+    
+    for (auto const &workload : workloads) {
+        vector<string> tokens = makeTokens(200000, workload.minLength, workload.maxLength);
+        
+        //all the kernels must give the tokens of the former path
+        for (int k = TokenNormalizer::SCALAR; k <= best; k++) {
+            TokenNormalizer::setKernel(TokenNormalizer::Kernel(k));
+            string scratch;
+            for (auto const &token : tokens)
+                if (TokenNormalizer::normalize(token, scratch) != lowerRemovedPunct(token)) {
+                    cout << kernelNames[k] << " kernel differs on " << token << endl;
+                    return 1;
+                }
+        }
+        
+        cout << workload.name << " (" << workload.minLength << " to " << workload.maxLength << " bytes)" << endl;
+        double former = measure(tokens, [](const string& token) { return lowerRemovedPunct(token).size(); });
+        cout << setw(24) << left << "makeLower + removePunct" << fixed << setprecision(1) 
+            << setw(10) << right << former / 1e6 << " MB/s" << endl;
+        for (int k = TokenNormalizer::SCALAR; k <= best; k++) {
+            TokenNormalizer::setKernel(TokenNormalizer::Kernel(k));
+            string scratch;
+            double rate = measure(tokens, [&scratch](const string& token) { 
+                return TokenNormalizer::normalize(token, scratch).size(); 
+            });
+            cout << setw(24) << left << kernelNames[k] << setw(10) << right << rate / 1e6 << " MB/s" 
+                << setw(8) << rate / former << "x" << endl;
+        }
+        cout << endl;
+    }
+    TokenNormalizer::setKernel(best);
+}
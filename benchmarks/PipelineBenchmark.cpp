@@ -0,0 +1,264 @@
+/*
+ * The MIT License
+ *
+ * Copyright 2017 Theomeli.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/* 
+ * File:   PipelineBenchmark.cpp
+ * Author: Theomeli
+ *
+ * Created on October 20, 2026, 12:05 PM
+ *
+ * It runs the phases of the engine on synthetic collections made by
+ * CorpusGenerator at several scales: the reading of the documents file by
+ * ProcessFiles::readDocumentsFile, computeFrequencies, the building of the
+ * index by computeDocsWeight(false), the queries' weights by
+ * computeDocsWeight(true), each query alone and all the queries by
+ * computeResults. For each phase it reports its throughput and the
+ * percentiles of its latency, over the repetitions or, for single queries,
+ * over the queries, and writes them as JSON:
+ *     ./pipelineBenchmark --scales 10000,100000 --vocabulary 50000 --zipf 1.0 \
+ *         --document-length 100 --queries 1000 --query-length 3 --responses 10 \
+ *         --repetitions 3 --threads 0 --json pipelineBenchmark.json
+ * Every option may be left out. The files of the collections are written to
+ * the current directory and removed at the end. Built by the pipelineBenchmark
+ * target of CMakeLists.txt.
+ */
+
+#include "CorpusGenerator.h"
+#include "TextRetrievalEngine.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+
+using namespace std;
+
+
+/**
+ * the measures of a phase
+ */
+struct Phase {
+    //the name of the phase
+    string name;
+    //the unit of the throughput
+    string unit;
+    //the units of work of a sample, such as the bytes read
+    double work;
+    //the seconds of each sample
+    vector<double> samples;
+};
+
+
+/**
+ * it returns the seconds since a time point
+ */
+double getSeconds(chrono::steady_clock::time_point start) {
+    return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+
+/**
+ * it finds a percentile of sorted samples, by the nearest rank
+ */
+double getPercentile(const vector<double>& sorted, double percentile) {
+    size_t rank = size_t(percentile / 100 * sorted.size() + 0.999999);
+    
+    return sorted[min(sorted.size(), max(size_t(1), rank)) - 1];
+}
+
+
+/**
+ * it parses a list of numbers separated by commas
+ */
+vector<size_t> parseList(const string& list) {
+    vector<size_t> numbers;
+    stringstream stream(list);
+    string item;
+    while (getline(stream, item, ','))
+        numbers.push_back(strtoull(item.c_str(), nullptr, 10));
+    
+    return numbers;
+}
+
+
+/**
+ * it runs all the phases once on a collection and adds their samples
+ */
+void runPhases(const string& documentsFileName, const string& queriesFileName, size_t nThreads, 
+    vector<Phase>& phases, map<string, size_t>& counts) {
+    QueryExecutor executor(nThreads);
+    ProcessFiles p(documentsFileName, queriesFileName);
+    IndexBuilder builder;
+    
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    p.readDocumentsFile(p.getDocumentsMapping(), builder, executor);
+    p.readQueriesFile(p.getQueriesMapping());
+    phases[0].samples.push_back(getSeconds(start));
+    
+    TextRetrievalEngine t(move(p));
+    t.getCache().setCapacity(0);
+    start = chrono::steady_clock::now();
+    t.computeFrequencies(move(builder));
+    phases[1].samples.push_back(getSeconds(start));
+    
+    start = chrono::steady_clock::now();
+    t.initializeIdfs();
+    t.computeDocsWeight(false);
+    phases[2].samples.push_back(getSeconds(start));
+    
+    start = chrono::steady_clock::now();
+    t.computeDocsWeight(true);
+    phases[3].samples.push_back(getSeconds(start));
+    
+    //the checksum keeps the compiler from dropping the work
+    size_t checksum = 0;
+    map<size_t, size_t> nResponses = t.getP()->getNResponses();
+    for (size_t queryId = 1; queryId <= t.getP()->getNQueries(); queryId++) {
+        start = chrono::steady_clock::now();
+        checksum += t.evaluateQuery(queryId, nResponses[queryId]).size();
+        phases[4].samples.push_back(getSeconds(start));
+    }
+    
+    start = chrono::steady_clock::now();
+    t.computeResults(executor);
+    phases[5].samples.push_back(getSeconds(start));
+    
+    counts["documents"] = t.getP()->getNDocuments();
+    counts["terms"] = t.getLexicon().size();
+    counts["postings"] = 0;
+    for (size_t termId = 0; termId < t.getIndex().getNTerms(); termId++)
+        counts["postings"] += t.getIndex().getDocumentFrequency(termId);
+    counts["postingsBytes"] = t.getIndex().getPostingsSize();
+    counts["checksum"] = checksum;
+}
+
+
+int main(int argc, char** argv) {
+    CorpusGenerator::Options options;
+    vector<size_t> scales = { 10000, 100000 };
+    size_t repetitions = 3, nThreads = 0;
+    string jsonFileName = "pipelineBenchmark.json";
+    for (int i = 1; i + 1 < argc; i += 2) {
+        string argument = argv[i];
+        const char* value = argv[i + 1];
+        if (argument == "--scales")
+            scales = parseList(value);
+        else if (argument == "--vocabulary")
+            options.vocabularySize = strtoull(value, nullptr, 10);
+        else if (argument == "--zipf")
+            options.exponent = atof(value);
+        else if (argument == "--document-length")
+            options.documentLength = strtoull(value, nullptr, 10);
+        else if (argument == "--queries")
+            options.nQueries = strtoull(value, nullptr, 10);
+        else if (argument == "--query-length")
+            options.queryLength = strtoull(value, nullptr, 10);
+        else if (argument == "--responses")
+            options.nResponses = strtoull(value, nullptr, 10);
+        else if (argument == "--repetitions")
+            repetitions = max(size_t(1), size_t(strtoull(value, nullptr, 10)));
+        else if (argument == "--threads")
+            nThreads = strtoull(value, nullptr, 10);
+        else if (argument == "--json")
+            jsonFileName = value;
+        else {
+            cout << "unknown option " << argument << endl;
+            return 1;
+        }
+    }
+    
+    ostringstream json;
+    json << fixed << setprecision(6);
+    json << "{\n  \"benchmark\": \"PipelineBenchmark\",\n  \"threads\": " << QueryExecutor(nThreads).getNThreads() 
+        << ",\n  \"repetitions\": " << repetitions << ",\n  \"scales\": [";
+    for (size_t s = 0; s < scales.size(); s++) {
+        options.nDocuments = scales[s];
+        string documentsFileName = "benchmarkDocuments.txt", queriesFileName = "benchmarkQueries.txt";
+        CorpusGenerator generator(options);
+        if (!generator.write(documentsFileName, queriesFileName)) {
+            cout << "corpus files writing failed." << endl;
+            return 1;
+        }
+        ifstream documentsFile(documentsFileName, ios::binary | ios::ate);
+        double nBytes = documentsFile.tellg();
+        
+        vector<Phase> phases = {
+            { "parse", "MB/s", nBytes / 1e6, {} },
+            { "frequencies", "documents/s", double(options.nDocuments), {} },
+            { "index", "documents/s", double(options.nDocuments), {} },
+            { "queryWeights", "queries/s", double(options.nQueries), {} },
+            { "query", "queries/s", 1, {} },
+            { "computeResults", "queries/s", double(options.nQueries), {} }
+        };
+        map<string, size_t> counts;
+        for (size_t r = 0; r < repetitions; r++)
+            runPhases(documentsFileName, queriesFileName, nThreads, phases, counts);
+        remove(documentsFileName.c_str());
+        remove(queriesFileName.c_str());
+        
+        cout << options.nDocuments << " documents, " << counts["terms"] << " terms, " << counts["postings"] 
+            << " postings, " << options.nQueries << " queries of " << options.queryLength << " words" << endl;
+        cout << setw(14) << left << "phase" << setw(14) << right << "throughput" << setw(13) << left << "" 
+            << setw(12) << right << "p50 ms" << setw(12) << "p90 ms" << setw(12) << "p99 ms" << setw(12) << "max ms" << endl;
+        json << (s > 0 ? "," : "") << "\n    {\n      \"documents\": " << options.nDocuments 
+            << ",\n      \"vocabulary\": " << options.vocabularySize << ",\n      \"zipf\": " << options.exponent
+            << ",\n      \"documentLength\": " << options.documentLength << ",\n      \"queries\": " << options.nQueries
+            << ",\n      \"queryLength\": " << options.queryLength << ",\n      \"responses\": " << options.nResponses 
+            << ",\n      \"bytes\": " << size_t(nBytes) << ",\n      \"terms\": " << counts["terms"] 
+            << ",\n      \"postings\": " << counts["postings"] << ",\n      \"postingsBytes\": " << counts["postingsBytes"]
+            << ",\n      \"phases\": [";
+        for (size_t i = 0; i < phases.size(); i++) {
+            Phase& phase = phases[i];
+            vector<double> sorted = phase.samples;
+            sort(sorted.begin(), sorted.end());
+            double total = 0;
+            for (auto const sample : sorted)
+                total += sample;
+            double throughput = phase.work * sorted.size() / total;
+            cout << setw(14) << left << phase.name << fixed << setprecision(1) << setw(14) << right << throughput 
+                << ' ' << setw(12) << left << phase.unit << setprecision(3) << setw(12) << right 
+                << getPercentile(sorted, 50) * 1e3 << setw(12) << getPercentile(sorted, 90) * 1e3 
+                << setw(12) << getPercentile(sorted, 99) * 1e3 << setw(12) << sorted.back() * 1e3 << endl;
+            json << (i > 0 ? "," : "") << "\n        { \"name\": \"" << phase.name << "\", \"unit\": \"" << phase.unit 
+                << "\", \"throughput\": " << throughput << ", \"samples\": " << sorted.size() 
+                << ", \"latencyMs\": { \"p50\": " << getPercentile(sorted, 50) * 1e3 << ", \"p90\": " 
+                << getPercentile(sorted, 90) * 1e3 << ", \"p99\": " << getPercentile(sorted, 99) * 1e3 
+                << ", \"max\": " << sorted.back() * 1e3 << " } }";
+        }
+        json << "\n      ]\n    }";
+        cout << endl;
+    }
+    json << "\n  ]\n}\n";
+    
+    ofstream jsonFile(jsonFileName);
+    jsonFile << json.str();
+    if (!jsonFile.good()) {
+        cout << "JSON file writing failed." << endl;
+        return 1;
+    }
+    cout << "results written to " << jsonFileName << endl;
+}
+
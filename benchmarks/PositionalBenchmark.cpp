@@ -0,0 +1,215 @@
+/*
+ * The MIT License
+ *
+ * Copyright 2017 Theomeli.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+/* 
+ * File:   PositionalBenchmark.cpp
+ * Author: Theomeli
+ *
+ * Created on October 25, 2026, 6:15 PM
+ *
+ * It indexes the positions of the terms of a synthetic collection made by
+ * CorpusGenerator and evaluates with search phrases of 2 and 3 words and
+ * pairs of words NEAR/k each other, taken from random documents, one at a
+ * time on one thread. Each query is also answered as it was before the
+ * positions were indexed, ranking all the documents by the query's words and
+ * reading their text until k of them hold the phrase or the near words, and
+ * the results of both must be the same. It reports the time and the bytes of
+ * the positions and the latency of both ways:
+ *     ./positionalBenchmark --documents 100000 --vocabulary 50000 --zipf 1.0 \
+ *         --document-length 100 --queries 300 --responses 10
+ * Every option may be left out. The files of the collection are written to
+ * the current directory and removed at the end. Built by the positionalBenchmark
+ * target of CMakeLists.txt.
+ */
+
+#include "CorpusGenerator.h"
+#include "TextRetrievalEngine.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+
+using namespace std;
+
+
+/**
+ * it finds a percentile of sorted samples, by the nearest rank
+ */
+double getPercentile(const vector<double>& sorted, double percentile) {
+    size_t rank = size_t(percentile / 100 * sorted.size() + 0.999999);
+    
+    return sorted[min(sorted.size(), max(size_t(1), rank)) - 1];
+}
+
+
+/**
+ * it splits a normalized text to its tokens
+ */
+vector<string> getTokens(string_view text) {
+    vector<string> tokens;
+    size_t position = 0;
+    string_view token;
+    while (ProcessFiles::nextToken(text, position, text.size(), token))
+        tokens.push_back(string(token));
+    
+    return tokens;
+}
+
+
+/**
+ * it checks if a document's tokens hold a phrase or, when distance is
+ * given, the first token of the phrase at most distance positions from its
+ * last token, as the operators of search are defined
+ */
+bool isMatch(const vector<string>& tokens, const vector<string>& phrase, size_t distance) {
+    for (size_t i = 0; i < tokens.size(); i++) {
+        if (tokens[i] != phrase.front())
+            continue;
+        if (distance == SIZE_MAX) {
+            if (i + phrase.size() <= tokens.size() && equal(phrase.begin(), phrase.end(), tokens.begin() + i))
+                return true;
+            continue;
+        }
+        for (size_t j = i > distance ? i - distance : 0; j < tokens.size() && j <= i + distance; j++)
+            if (tokens[j] == phrase.back())
+                return true;
+    }
+    
+    return false;
+}
+
+
+int main(int argc, char** argv) {
+    CorpusGenerator::Options options;
+    options.nDocuments = 100000;
+    options.nQueries = 300;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        string argument = argv[i];
+        const char* value = argv[i + 1];
+        if (argument == "--documents")
+            options.nDocuments = strtoull(value, nullptr, 10);
+        else if (argument == "--vocabulary")
+            options.vocabularySize = strtoull(value, nullptr, 10);
+        else if (argument == "--zipf")
+            options.exponent = atof(value);
+        else if (argument == "--document-length")
+            options.documentLength = strtoull(value, nullptr, 10);
+        else if (argument == "--queries")
+            options.nQueries = strtoull(value, nullptr, 10);
+        else if (argument == "--responses")
+            options.nResponses = strtoull(value, nullptr, 10);
+        else {
+            cout << "unknown option " << argument << endl;
+            return 1;
+        }
+    }
+    
+    string documentsFileName = "benchmarkDocuments.txt", queriesFileName = "benchmarkQueries.txt";
+    CorpusGenerator generator(options);
+    if (!generator.write(documentsFileName, queriesFileName)) {
+        cout << "corpus files writing failed." << endl;
+        return 1;
+    }
+    QueryExecutor executor(0);
+    ProcessFiles p(documentsFileName, "");
+    IndexBuilder builder;
+    p.readDocumentsFile(p.getDocumentsMapping(), builder, executor);
+    remove(documentsFileName.c_str());
+    remove(queriesFileName.c_str());
+    TextRetrievalEngine t(move(p));
+    t.computeFrequencies(move(builder));
+    t.initializeIdfs();
+    t.computeDocsWeight(false);
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    t.indexPositions();
+    double indexTime = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    cout << options.nDocuments << " documents, " << t.getLexicon().size() << " terms, top " << options.nResponses << endl;
+    cout << "positions: " << fixed << setprecision(2) << t.getPositionalIndex()->getMemoryUsage() / 1e6 
+        << " MB in " << indexTime << " s, postings " << t.getIndex().getPostingsSize() / 1e6 << " MB" << endl;
+    
+    cout << setw(12) << left << "queries" << setw(12) << right << "matches" << setw(12) << "mean ms" 
+        << setw(12) << "p50 ms" << setw(12) << "p99 ms" << setw(16) << "filter mean ms" << setw(14) << "filter p99 ms" 
+        << setw(12) << "docs read" << endl;
+    mt19937 random(17);
+    size_t nDifferent = 0;
+    string text;
+    for (string kind : { "phrase 2", "phrase 3", "NEAR/3" }) {
+        vector<double> samples, filterSamples;
+        size_t nMatches = 0, nRead = 0;
+        for (size_t q = 0; q < options.nQueries; q++) {
+            //the words are taken from a random document, so most queries match
+            size_t length = kind == "phrase 3" ? 3 : 2;
+            vector<string> tokens;
+            while (tokens.size() < length + 3)
+                tokens = getTokens(t.getP()->getDocuments().getDocument(random() % options.nDocuments + 1, text));
+            size_t first = random() % (tokens.size() - length - 2);
+            vector<string> phrase(tokens.begin() + first, tokens.begin() + first + length);
+            size_t distance = SIZE_MAX;
+            string query = "\"" + phrase[0] + " " + phrase[1] + (length == 3 ? " " + phrase[2] : "") + "\"";
+            if (kind == "NEAR/3") {
+                distance = 3;
+                phrase[1] = tokens[first + 1 + random() % 3];
+                query = phrase[0] + " NEAR/3 " + phrase[1];
+            }
+            
+            start = chrono::steady_clock::now();
+            vector<pair<size_t, double>> result = t.search(query, options.nResponses);
+            samples.push_back(chrono::duration<double>(chrono::steady_clock::now() - start).count());
+            nMatches += result.size();
+            
+            //all the documents ranked by the words, whose text is read until enough hold them
+            string words;
+            for (auto const &word : phrase)
+                words += word + " ";
+            start = chrono::steady_clock::now();
+            vector<pair<size_t, double>> filtered;
+            for (auto const &ent1 : t.search(words, options.nDocuments)) {
+                if (filtered.size() == options.nResponses || ent1.second == 0)
+                    break;
+                nRead++;
+                if (isMatch(getTokens(t.getP()->getDocuments().getDocument(ent1.first, text)), phrase, distance))
+                    filtered.push_back(ent1);
+            }
+            filterSamples.push_back(chrono::duration<double>(chrono::steady_clock::now() - start).count());
+            nDifferent += filtered != result;
+        }
+        
+        sort(samples.begin(), samples.end());
+        sort(filterSamples.begin(), filterSamples.end());
+        double total = 0, filterTotal = 0;
+        for (size_t i = 0; i < samples.size(); i++) {
+            total += samples[i];
+            filterTotal += filterSamples[i];
+        }
+        cout << setw(12) << left << kind << setw(12) << right << nMatches << setprecision(3) 
+            << setw(12) << total / samples.size() * 1e3 << setw(12) << getPercentile(samples, 50) * 1e3 
+            << setw(12) << getPercentile(samples, 99) * 1e3 << setw(16) << filterTotal / samples.size() * 1e3 
+            << setw(14) << getPercentile(filterSamples, 99) * 1e3 << setw(12) << nRead << endl;
+    }
+    cout << "queries whose results differ: " << nDifferent << endl;
+    
+    return nDifferent > 0;
+}
@@ -0,0 +1,170 @@
+/*
+ * The MIT License
+ *
+ * Copyright 2017 Theomeli.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/* 
+ * File:   PostingsBenchmark.cpp
+ * Author: Theomeli
+ *
+ * Created on October 19, 2026, 4:40 PM
+ *
+ * It builds the postings lists of a synthetic collection whose terms follow
+ * Zipf's law and measures the size of the lists compressed by PostingsCodec
+ * against the former postings of a size_t id and a double weight, and the
+ * postings per second which each kernel decodes. It checks that all the
+ * kernels give back the lists which were encoded.
+ * Built by the postingsBenchmark target of CMakeLists.txt.
+ */
+
+#include "PostingsCodec.h"
+#include "CorpusGenerator.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <map>
+
+using namespace std;
+
+
+/**
+ * it makes the postings lists of nDocuments documents of nTokens tokens
+ * each, drawn by CorpusGenerator from nTerms terms with probability 
+ * proportional to 1/rank^s
+ * @return for each term the ascending document ids and their frequencies
+ */
+vector<pair<vector<uint32_t>, vector<uint32_t>>> makeLists(size_t nDocuments, size_t nTokens, size_t nTerms, double s) {
+    CorpusGenerator::Options options;
+    options.vocabularySize = nTerms;
+    options.exponent = s;
+    CorpusGenerator generator(options);
+    vector<pair<vector<uint32_t>, vector<uint32_t>>> lists(nTerms);
+    map<uint32_t, uint32_t> frequencies;
+    for (uint32_t docId = 1; docId <= nDocuments; docId++) {
+        frequencies.clear();
+        for (size_t i = 0; i < nTokens; i++)
+            frequencies[generator.drawRank()]++;
+        for (auto const &ent1 : frequencies) {
+            lists[ent1.first].first.push_back(docId);
+            lists[ent1.first].second.push_back(ent1.second);
+        }
+    }
+    
+    return lists;
+}
+
+
+/**
+ * it decodes all the lists until enough time has passed
+ * @return the postings decoded per second
+ */
+double measure(const vector<uint8_t>& data, const vector<size_t>& offsets, const vector<size_t>& sizes) {
+    uint32_t docIds[PostingsCodec::BLOCK_SIZE], frequencies[PostingsCodec::BLOCK_SIZE];
+    size_t nPostings = 0;
+    for (auto const &size : sizes)
+        nPostings += size;
+    
+    size_t checksum = 0;
+    size_t rounds = 0;
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    chrono::duration<double> elapsed;
+    do {
+        for (size_t termId = 0; termId < sizes.size(); termId++) {
+            const uint8_t* block = data.data() + offsets[termId];
+            uint32_t previous = 0;
+            for (size_t first = 0; first < sizes[termId]; first += PostingsCodec::BLOCK_SIZE) {
+                size_t count = min(PostingsCodec::BLOCK_SIZE, sizes[termId] - first);
+                block = PostingsCodec::decode(block, count, previous, docIds, frequencies);
+                previous = docIds[count - 1];
+                checksum += frequencies[count - 1];
+            }
+            checksum += previous;
+        }
+        rounds++;
+        elapsed = chrono::steady_clock::now() - start;
+    } while (elapsed.count() < 0.5);
+    //the checksum keeps the compiler from dropping the work
+    if (checksum == 1)
+        cout << ' ';
+    
+    return nPostings * rounds / elapsed.count();
+}
+
+
+int main() {
+    const char* kernelNames[] = { "scalar", "sse2" };
+    PostingsCodec::Kernel best = PostingsCodec::getKernel();
+    struct { const char* name; size_t nDocuments, nTokens, nTerms; double s; } workloads[] = {
+        { "short documents", 200000, 40, 50000, 1.0 },
+        { "long documents", 20000, 1000, 200000, 1.1 }
+    };
+    
+    for (auto const &workload : workloads) {
+        vector<pair<vector<uint32_t>, vector<uint32_t>>> lists = makeLists(workload.nDocuments, workload.nTokens, 
+            workload.nTerms, workload.s);
+        vector<uint8_t> data;
+        vector<size_t> offsets, sizes;
+        size_t nPostings = 0;
+        for (auto const &list : lists) {
+            offsets.push_back(data.size());
+            sizes.push_back(list.first.size());
+            PostingsCodec::encode(list.first.data(), list.second.data(), nullptr, list.first.size(), data);
+            nPostings += list.first.size();
+        }
+        
+        //all the kernels must give back the encoded lists
+        for (int k = PostingsCodec::SCALAR; k <= best; k++) {
+            PostingsCodec::setKernel(PostingsCodec::Kernel(k));
+            uint32_t docIds[PostingsCodec::BLOCK_SIZE], frequencies[PostingsCodec::BLOCK_SIZE];
+            for (size_t termId = 0; termId < lists.size(); termId++) {
+                const uint8_t* block = data.data() + offsets[termId];
+                uint32_t previous = 0;
+                for (size_t first = 0; first < sizes[termId]; first += PostingsCodec::BLOCK_SIZE) {
+                    size_t count = min(PostingsCodec::BLOCK_SIZE, sizes[termId] - first);
+                    block = PostingsCodec::decode(block, count, previous, docIds, frequencies);
+                    if (!equal(docIds, docIds + count, lists[termId].first.begin() + first) 
+                        || !equal(frequencies, frequencies + count, lists[termId].second.begin() + first)) {
+                        cout << kernelNames[k] << " kernel differs on term " << termId << endl;
+                        return 1;
+                    }
+                    previous = docIds[count - 1];
+                }
+            }
+        }
+        
+        cout << workload.name << " (" << workload.nDocuments << " documents, " << nPostings << " postings)" << endl;
+        double former = nPostings * double(sizeof(size_t) + sizeof(double));
+        cout << setw(24) << left << "size_t id + double" << fixed << setprecision(1) 
+            << setw(10) << right << former / 1e6 << " MB" << setw(8) << 8.0 * former / nPostings << " bits/posting" << endl;
+        cout << setw(24) << left << "compressed" << setw(10) << right << data.size() / 1e6 << " MB" 
+            << setw(8) << 8.0 * data.size() / nPostings << " bits/posting" << setw(8) << former / data.size() << "x" << endl;
+        for (int k = PostingsCodec::SCALAR; k <= best; k++) {
+            PostingsCodec::setKernel(PostingsCodec::Kernel(k));
+            double rate = measure(data, offsets, sizes);
+            cout << setw(24) << left << (string("decode ") + kernelNames[k]) << setw(10) << right << rate / 1e6 
+                << " M postings/s" << endl;
+        }
+        cout << endl;
+    }
+    PostingsCodec::setKernel(best);
+}
@@ -0,0 +1,169 @@
+/*
+ * The MIT License
+ *
+ * Copyright 2017 Theomeli.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+/* 
+ * File:   QuantizationBenchmark.cpp
+ * Author: Theomeli
+ *
+ * Created on October 22, 2026, 5:10 PM
+ *
+ * It evaluates the queries of a synthetic collection made by CorpusGenerator
+ * exactly and from the postings' impacts quantized to 8 and 16 bits, one 
+ * query at a time on one thread. For each mode it reports the bytes of the
+ * postings and of the tables read per document, the latency of a query and
+ * the ranking's quality against the exact one: the mean overlap of the top k
+ * documents, the share of queries whose top k are the same in the same order
+ * and the greatest difference of a returned cosine:
+ *     ./quantizationBenchmark --documents 100000 --vocabulary 50000 --zipf 1.0 \
+ *         --document-length 100 --queries 1000 --query-length 3 --responses 10
+ * Every option may be left out. The files of the collection are written to
+ * the current directory and removed at the end. Built by the quantizationBenchmark
+ * target of CMakeLists.txt.
+ */
+
+#include "CorpusGenerator.h"
+#include "TextRetrievalEngine.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+
+using namespace std;
+
+
+/**
+ * it finds a percentile of sorted samples, by the nearest rank
+ */
+double getPercentile(const vector<double>& sorted, double percentile) {
+    size_t rank = size_t(percentile / 100 * sorted.size() + 0.999999);
+    
+    return sorted[min(sorted.size(), max(size_t(1), rank)) - 1];
+}
+
+
+int main(int argc, char** argv) {
+    CorpusGenerator::Options options;
+    options.nDocuments = 100000;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        string argument = argv[i];
+        const char* value = argv[i + 1];
+        if (argument == "--documents")
+            options.nDocuments = strtoull(value, nullptr, 10);
+        else if (argument == "--vocabulary")
+            options.vocabularySize = strtoull(value, nullptr, 10);
+        else if (argument == "--zipf")
+            options.exponent = atof(value);
+        else if (argument == "--document-length")
+            options.documentLength = strtoull(value, nullptr, 10);
+        else if (argument == "--queries")
+            options.nQueries = strtoull(value, nullptr, 10);
+        else if (argument == "--query-length")
+            options.queryLength = strtoull(value, nullptr, 10);
+        else if (argument == "--responses")
+            options.nResponses = strtoull(value, nullptr, 10);
+        else {
+            cout << "unknown option " << argument << endl;
+            return 1;
+        }
+    }
+    
+    string documentsFileName = "benchmarkDocuments.txt", queriesFileName = "benchmarkQueries.txt";
+    CorpusGenerator generator(options);
+    if (!generator.write(documentsFileName, queriesFileName)) {
+        cout << "corpus files writing failed." << endl;
+        return 1;
+    }
+    QueryExecutor executor(0);
+    ProcessFiles p(documentsFileName, queriesFileName);
+    IndexBuilder builder;
+    p.readDocumentsFile(p.getDocumentsMapping(), builder, executor);
+    p.readQueriesFile(p.getQueriesMapping());
+    remove(documentsFileName.c_str());
+    remove(queriesFileName.c_str());
+    TextRetrievalEngine t(move(p));
+    t.computeFrequencies(move(builder));
+    t.initializeIdfs();
+    t.computeDocsWeight(false);
+    t.computeDocsWeight(true);
+    
+    const InvertedIndex& index = t.getIndex();
+    size_t nQueries = t.getP()->getNQueries();
+    map<size_t, size_t> nResponses = t.getP()->getNResponses();
+    cout << options.nDocuments << " documents, " << t.getLexicon().size() << " terms, " << nQueries 
+        << " queries of " << options.queryLength << " words, top " << options.nResponses << endl;
+    cout << setw(8) << left << "mode" << setw(16) << right << "postings MB" << setw(16) << "bytes/document" 
+        << setw(12) << "mean ms" << setw(12) << "p50 ms" << setw(12) << "p99 ms" << setw(12) << "overlap@k" 
+        << setw(12) << "same top k" << setw(14) << "cosine error" << endl;
+    
+    vector<vector<pair<size_t, double>>> exact(nQueries + 1);
+    for (unsigned bits : { 0u, 16u, 8u }) {
+        t.quantize(bits);
+        vector<double> samples;
+        double overlap = 0, error = 0;
+        size_t nSame = 0;
+        for (size_t queryId = 1; queryId <= nQueries; queryId++) {
+            chrono::steady_clock::time_point start = chrono::steady_clock::now();
+            vector<pair<size_t, double>> result = t.evaluateQuery(queryId, nResponses[queryId]);
+            samples.push_back(chrono::duration<double>(chrono::steady_clock::now() - start).count());
+            if (bits == 0) {
+                exact[queryId] = result;
+                continue;
+            }
+            
+            //the overlap of the documents returned, in any order
+            vector<size_t> expected, found;
+            for (size_t i = 0; i < result.size(); i++) {
+                expected.push_back(exact[queryId][i].first);
+                found.push_back(result[i].first);
+                error = max(error, fabs(result[i].second - exact[queryId][i].second));
+            }
+            nSame += expected == found;
+            sort(expected.begin(), expected.end());
+            sort(found.begin(), found.end());
+            vector<size_t> common;
+            set_intersection(expected.begin(), expected.end(), found.begin(), found.end(), back_inserter(common));
+            overlap += result.empty() ? 1 : double(common.size()) / result.size();
+        }
+        
+        //the exact scores read a document's norm and greatest frequency
+        //besides its postings, the quantized ones only the postings
+        size_t postingsBytes = bits == 0 ? index.getPostingsSize() : t.getQuantizedIndex()->getMemoryUsage();
+        size_t documentBytes = bits == 0 ? sizeof(double) + sizeof(uint64_t) : 0;
+        sort(samples.begin(), samples.end());
+        double total = 0;
+        for (auto const sample : samples)
+            total += sample;
+        cout << setw(8) << left << (bits == 0 ? "exact" : to_string(bits) + " bits") << fixed << setprecision(2) 
+            << setw(16) << right << postingsBytes / 1e6 << setw(16) << documentBytes << setprecision(3) 
+            << setw(12) << total / samples.size() * 1e3 << setw(12) << getPercentile(samples, 50) * 1e3 
+            << setw(12) << getPercentile(samples, 99) * 1e3;
+        if (bits == 0)
+            cout << setw(12) << "-" << setw(12) << "-" << setw(14) << "-" << endl;
+        else
+            cout << setw(12) << overlap / nQueries << setw(12) << double(nSame) / nQueries << scientific 
+                << setprecision(2) << setw(14) << error << endl;
+    }
+}
@@ -0,0 +1,164 @@
+/*
+ * The MIT License
+ *
+ * Copyright 2017 Theomeli.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+/* 
+ * File:   SearchBenchmark.cpp
+ * Author: Theomeli
+ *
+ * Created on October 25, 2026, 10:20 AM
+ *
+ * It builds the index of the documents of a synthetic collection made by
+ * CorpusGenerator without any queries file, as a server does, and evaluates
+ * the texts of the generated queries with search, one at a time on one thread.
+ * It checks that the results are the ones of the same queries read from a
+ * queries file and evaluated by evaluateQuery, and that the lexicons do not
+ * grow, and reports the microseconds a text takes with and without a word
+ * which no document contains:
+ *     ./searchBenchmark --documents 100000 --vocabulary 50000 --zipf 1.0 \
+ *         --document-length 100 --queries 1000 --query-length 3 --responses 10
+ * Every option may be left out. The files of the collection are written to
+ * the current directory and removed at the end. Built by the searchBenchmark
+ * target of CMakeLists.txt.
+ */
+
+#include "CorpusGenerator.h"
+#include "TextRetrievalEngine.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+
+using namespace std;
+
+
+/**
+ * it finds a percentile of sorted samples, by the nearest rank
+ */
+double getPercentile(const vector<double>& sorted, double percentile) {
+    size_t rank = size_t(percentile / 100 * sorted.size() + 0.999999);
+    
+    return sorted[min(sorted.size(), max(size_t(1), rank)) - 1];
+}
+
+
+int main(int argc, char** argv) {
+    CorpusGenerator::Options options;
+    options.nDocuments = 100000;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        string argument = argv[i];
+        const char* value = argv[i + 1];
+        if (argument == "--documents")
+            options.nDocuments = strtoull(value, nullptr, 10);
+        else if (argument == "--vocabulary")
+            options.vocabularySize = strtoull(value, nullptr, 10);
+        else if (argument == "--zipf")
+            options.exponent = atof(value);
+        else if (argument == "--document-length")
+            options.documentLength = strtoull(value, nullptr, 10);
+        else if (argument == "--queries")
+            options.nQueries = strtoull(value, nullptr, 10);
+        else if (argument == "--query-length")
+            options.queryLength = strtoull(value, nullptr, 10);
+        else if (argument == "--responses")
+            options.nResponses = strtoull(value, nullptr, 10);
+        else {
+            cout << "unknown option " << argument << endl;
+            return 1;
+        }
+    }
+    
+    string documentsFileName = "benchmarkDocuments.txt", queriesFileName = "benchmarkQueries.txt";
+    CorpusGenerator generator(options);
+    if (!generator.write(documentsFileName, queriesFileName)) {
+        cout << "corpus files writing failed." << endl;
+        return 1;
+    }
+    QueryExecutor executor(0);
+    
+    //the index of the documents only, weighted once
+    ProcessFiles documents(documentsFileName, "");
+    IndexBuilder builder;
+    documents.readDocumentsFile(documents.getDocumentsMapping(), builder, executor);
+    TextRetrievalEngine t(move(documents));
+    t.computeFrequencies(move(builder));
+    t.initializeIdfs();
+    t.computeDocsWeight(false);
+    size_t nTerms = t.getLexicon().size();
+    
+    //the same collection with the queries file, for the expected results
+    ProcessFiles p(documentsFileName, queriesFileName);
+    IndexBuilder expectedBuilder;
+    p.readDocumentsFile(p.getDocumentsMapping(), expectedBuilder, executor);
+    p.readQueriesFile(p.getQueriesMapping());
+    remove(documentsFileName.c_str());
+    remove(queriesFileName.c_str());
+    TextRetrievalEngine expected(move(p));
+    expected.computeFrequencies(move(expectedBuilder));
+    expected.initializeIdfs();
+    expected.computeDocsWeight(false);
+    expected.computeDocsWeight(true);
+    
+    size_t nQueries = expected.getP()->getNQueries();
+    map<size_t, size_t> nResponses = expected.getP()->getNResponses();
+    vector<string> texts(nQueries + 1);
+    for (size_t queryId = 1; queryId <= nQueries; queryId++)
+        for (auto const token : expected.getP()->getQueriesTokens().getTokens(queryId))
+            texts[queryId] += string(token) + " ";
+    cout << options.nDocuments << " documents, " << nTerms << " terms, " << nQueries << " queries of " 
+        << options.queryLength << " words, top " << options.nResponses << endl;
+    
+    size_t nDifferent = 0;
+    for (size_t queryId = 1; queryId <= nQueries; queryId++)
+        nDifferent += t.search(texts[queryId], nResponses[queryId]) != expected.evaluateQuery(queryId, nResponses[queryId]);
+    cout << "results different from the queries file's: " << nDifferent << endl;
+    
+    cout << setw(24) << left << "texts" << setw(12) << right << "mean us" << setw(12) << "p50 us" 
+        << setw(12) << "p99 us" << endl;
+    for (string unknown : { "", "zzzunknownzzz" }) {
+        vector<double> samples;
+        size_t checksum = 0;
+        for (size_t queryId = 1; queryId <= nQueries; queryId++) {
+            string text = texts[queryId] + unknown;
+            chrono::steady_clock::time_point start = chrono::steady_clock::now();
+            checksum += t.search(text, nResponses[queryId]).size();
+            samples.push_back(chrono::duration<double>(chrono::steady_clock::now() - start).count());
+        }
+        //the checksum keeps the compiler from dropping the work
+        if (checksum == 1)
+            cout << ' ';
+        sort(samples.begin(), samples.end());
+        double total = 0;
+        for (auto const sample : samples)
+            total += sample;
+        cout << setw(24) << left << (unknown.empty() ? "queries" : "queries + unknown word") << fixed 
+            << setprecision(1) << setw(12) << right << total / samples.size() * 1e6 
+            << setw(12) << getPercentile(samples, 50) * 1e6 << setw(12) << getPercentile(samples, 99) * 1e6 << endl;
+    }
+    
+    cout << "terms after the searches: " << t.getLexicon().size() << (t.getLexicon().size() == nTerms ? " (unchanged)" : "") << endl;
+    
+    return nDifferent > 0;
+}
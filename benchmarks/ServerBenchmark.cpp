@@ -0,0 +1,183 @@
+/*
+ * The MIT License
+ *
+ * Copyright 2017 Theomeli.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+/* 
+ * File:   ServerBenchmark.cpp
+ * Author: Theomeli
+ *
+ * Created on October 24, 2026, 3:40 PM
+ *
+ * It sends the queries of a queries file to a server started with --serve,
+ * over several connections at once, each keeping a number of requests in
+ * flight, and reports the requests per second and the percentiles of the
+ * time from a request's sending to its response's arrival:
+ *     ./TextRetrievalEngine --serve engine.sock &
+ *     ./serverBenchmark --socket engine.sock --queries queriesText.txt \
+ *         --connections 4 --pipeline 8 --rounds 3
+ * Every option may be left out. Built by the serverBenchmark target of
+ * CMakeLists.txt.
+ */
+
+#include "Message.h"
+#include "ProcessFiles.h"
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <iomanip>
+#include <thread>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+using namespace std;
+
+
+/**
+ * it finds a percentile of sorted samples, by the nearest rank
+ */
+double getPercentile(const vector<double>& sorted, double percentile) {
+    size_t rank = size_t(percentile / 100 * sorted.size() + 0.999999);
+    
+    return sorted[min(sorted.size(), max(size_t(1), rank)) - 1];
+}
+
+
+/**
+ * it connects to the socket of a server
+ * @return the descriptor of the socket or -1
+ */
+int connectTo(const string& socketName) {
+    sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strncpy(address.sun_path, socketName.c_str(), sizeof(address.sun_path) - 1);
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd >= 0 && connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        close(fd);
+        return -1;
+    }
+    
+    return fd;
+}
+
+
+int main(int argc, char** argv) {
+    string socketName = "engine.sock", queriesName = "queriesText.txt";
+    size_t nConnections = 4, pipeline = 8, nRounds = 3;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        string argument = argv[i];
+        if (argument == "--socket")
+            socketName = argv[i + 1];
+        else if (argument == "--queries")
+            queriesName = argv[i + 1];
+        else if (argument == "--connections")
+            nConnections = max(1ull, strtoull(argv[i + 1], nullptr, 10));
+        else if (argument == "--pipeline")
+            pipeline = max(1ull, strtoull(argv[i + 1], nullptr, 10));
+        else if (argument == "--rounds")
+            nRounds = max(1ull, strtoull(argv[i + 1], nullptr, 10));
+        else {
+            cout << "unknown option " << argument << endl;
+            return 1;
+        }
+    }
+    
+    ProcessFiles p("", queriesName);
+    if (p.fail()) {
+        cout << p.getError() << endl;
+        return 1;
+    }
+    p.readQueriesFile(p.getQueriesMapping());
+    map<size_t, size_t> nResponses = p.getNResponses();
+    vector<string> requests;
+    for (size_t queryId = 1; queryId <= p.getNQueries(); queryId++) {
+        Message request;
+        request.putNumber(nResponses[queryId]);
+        request.putString(p.getQueriesTokens().getText(queryId));
+        requests.push_back(request.getBytes());
+    }
+    if (requests.empty()) {
+        cout << "no queries." << endl;
+        return 1;
+    }
+    
+    //each connection sends the queries from its own start, keeping
+    //pipeline requests in flight
+    size_t nRequests = requests.size() * nRounds;
+    vector<vector<double>> latencies(nConnections);
+    vector<bool> isFailed(nConnections, false);
+    vector<thread> clients;
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for (size_t c = 0; c < nConnections; c++)
+        clients.push_back(thread([&, c]() {
+            int fd = connectTo(socketName);
+            if (fd < 0) {
+                isFailed[c] = true;
+                return;
+            }
+            deque<chrono::steady_clock::time_point> sent;
+            Message message;
+            size_t nSent = 0, nReceived = 0;
+            while (nReceived < nRequests) {
+                while (nSent < nRequests && sent.size() < pipeline) {
+                    message.setBytes(requests[(c * requests.size() / nConnections + nSent) % requests.size()]);
+                    sent.push_back(chrono::steady_clock::now());
+                    if (!message.write(fd))
+                        break;
+                    nSent++;
+                }
+                if (!message.read(fd)) {
+                    isFailed[c] = true;
+                    break;
+                }
+                latencies[c].push_back(chrono::duration<double>(chrono::steady_clock::now() - sent.front()).count());
+                sent.pop_front();
+                nReceived++;
+            }
+            close(fd);
+        }));
+    for (auto &ent1 : clients)
+        ent1.join();
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    
+    vector<double> sorted;
+    for (size_t c = 0; c < nConnections; c++) {
+        if (isFailed[c]) {
+            cout << "connection " << c << " failed." << endl;
+            return 1;
+        }
+        sorted.insert(sorted.end(), latencies[c].begin(), latencies[c].end());
+    }
+    sort(sorted.begin(), sorted.end());
+    cout << sorted.size() << " requests over " << nConnections << " connections, " << pipeline 
+        << " in flight on each" << endl;
+    cout << fixed << setprecision(0) << setw(16) << left << "requests/s" << sorted.size() / seconds << endl;
+    cout << setprecision(3);
+    for (double percentile : { 50.0, 90.0, 99.0 })
+        cout << "p" << setw(15) << left << int(percentile) << getPercentile(sorted, percentile) * 1e3 << " ms" << endl;
+    cout << setw(16) << left << "max" << sorted.back() * 1e3 << " ms" << endl;
+}
@@ -31,24 +31,317 @@
 
 #include "ProcessFiles.h"
 #include "TextRetrievalEngine.h"
+#include "ShardCoordinator.h"
+#include "ShardWorker.h"
+#include "SearchServer.h"
+#include <csignal>
+#include <algorithm>
+#include <fstream>
 
 using namespace std;
 
+//the server stopped by SIGINT and SIGTERM
+static SearchServer* runningServer = nullptr;
+
+//the arguments which the program takes, printed when one is not known
+static const char* const USAGE = "usage: TextRetrievalEngine [THREADS] [--documents FILE] [--queries FILE] "
+    "[--save-index FILE | --load-index FILE [--verify-index]] [--cache-size BYTES] [--cache-stats] "
+    "[--batch-size N] [--updates FILE] [--stats FILE] [--trace FILE] [--output FILE] "
+    "[--format text|tsv|jsonl|binary] [--quantize 8|16] [--shards N] [--serve SOCKET] [--positions] "
+    "[--wildcards]\n";
+
+
+/**
+ * it checks if an argument is a number, as the number of threads is
+ * @param argument is the argument
+ * @return true if it is not empty and only has digits
+ */
+static bool isNumber(const string& argument) {
+    return !argument.empty() && all_of(argument.begin(), argument.end(), [](char c) { return isdigit(c); });
+}
+
+
+/**
+ * it stops the running server, so that it closes its socket
+ */
+static void stopServer(int) {
+    if (runningServer != nullptr)
+        runningServer->stop();
+}
+
 
 int main(int argc, char** argv) {
 
-    ProcessFiles p;
-    ifstream& i1 = p.getDocumentsText();
-    p.readDocumentsFile(i1);
+    //a number argument is the number of threads reading the documents
+    //and evaluating the queries. By default one thread per core is used.
+    //Any other argument which is not an option below is rejected and 
+    //--help prints the options.
+    //--documents FILE reads the documents from FILE instead of documentsText.txt
+    //and --queries FILE the queries from FILE instead of queriesText.txt.
+    //--save-index FILE saves the built index and --load-index FILE takes
+    //the index from a saved file instead of reading the documents file,
+    //checking the whole file against its checksums if --verify-index is given.
+    //--cache-size BYTES bounds the cache of the queries' results, 0 turns it
+    //off, and --cache-stats prints its counters to the standard error.
+    //--batch-size N evaluates the queries N at a time, reading each postings
+    //list once for all the queries of a batch.
+    //--updates FILE changes the collection before the queries are evaluated,
+    //each line of the file adding a document, "+ text", or deleting one, "- id".
+    //--stats FILE writes the times of the phases, the counters and the bytes of
+    //the structures as JSON and --trace FILE the phases as a Chrome trace.
+    //--output FILE writes the results to a file instead of the standard output
+    //and --format text|tsv|jsonl|binary chooses how they are written.
+    //--quantize 8|16 evaluates the queries from the postings' impacts
+    //quantized to that many bits, adding integers, instead of exactly.
+    //--shards N splits the documents in N shards of consecutive ids, each
+    //indexed and searched by a process of its own, whose results are merged.
+    //--serve SOCKET keeps the index in memory and answers the queries sent to
+    //a Unix domain socket until it is interrupted, without a queries file.
+    //--positions indexes the positions of the terms, so that the queries sent
+    //to the server may ask for "quoted phrases" and words NEAR/k each other.
+    //--wildcards sorts the terms in a dictionary, so that the words of the
+    //queries sent to the server may end with * to ask for the terms of a prefix.
+    size_t nThreads = 0;
+    string documentsName = "documentsText.txt", queriesName = "queriesText.txt";
+    string saveIndexName, loadIndexName;
+    bool isVerified = false;
+    size_t cacheSize = ResultCache::DEFAULT_CAPACITY;
+    bool isCacheReported = false;
+    size_t batchSize = 0;
+    string updatesName, statsName, traceName, outputName, socketName;
+    ResultWriter::Format format = ResultWriter::TEXT;
+    unsigned quantizationBits = 0;
+    size_t nShards = 0;
+    bool isPositional = false;
+    bool isWildcarded = false;
+    for (int i = 1; i < argc; i++) {
+        string argument = argv[i];
+        if (argument == "--documents" && i + 1 < argc)
+            documentsName = argv[++i];
+        else if (argument == "--queries" && i + 1 < argc)
+            queriesName = argv[++i];
+        else if (argument == "--save-index" && i + 1 < argc)
+            saveIndexName = argv[++i];
+        else if (argument == "--load-index" && i + 1 < argc)
+            loadIndexName = argv[++i];
+        else if (argument == "--verify-index")
+            isVerified = true;
+        else if (argument == "--cache-size" && i + 1 < argc)
+            cacheSize = strtoull(argv[++i], nullptr, 10);
+        else if (argument == "--cache-stats")
+            isCacheReported = true;
+        else if (argument == "--batch-size" && i + 1 < argc)
+            batchSize = strtoull(argv[++i], nullptr, 10);
+        else if (argument == "--updates" && i + 1 < argc)
+            updatesName = argv[++i];
+        else if (argument == "--stats" && i + 1 < argc)
+            statsName = argv[++i];
+        else if (argument == "--trace" && i + 1 < argc)
+            traceName = argv[++i];
+        else if (argument == "--output" && i + 1 < argc)
+            outputName = argv[++i];
+        else if (argument == "--quantize" && i + 1 < argc) {
+            quantizationBits = atoi(argv[++i]);
+            if (quantizationBits != 0 && quantizationBits != 8 && quantizationBits != 16) {
+                cout << "impacts are quantized to 8 or 16 bits.";
+                exit(1);
+            }
+        }
+        else if (argument == "--serve" && i + 1 < argc)
+            socketName = argv[++i];
+        else if (argument == "--positions")
+            isPositional = true;
+        else if (argument == "--wildcards")
+            isWildcarded = true;
+        else if (argument == "--shards" && i + 1 < argc)
+            nShards = strtoull(argv[++i], nullptr, 10);
+        else if (argument == "--format" && i + 1 < argc) {
+            if (!ResultWriter::parseFormat(argv[++i], format)) {
+                cout << "unknown results format " << argv[i] << '.';
+                exit(1);
+            }
+        }
+        else if (isNumber(argument))
+            nThreads = strtoull(argv[i], nullptr, 10);
+        else if (argument == "--help") {
+            cout << USAGE;
+            return 0;
+        }
+        else {
+            cout << "unknown argument " << argument << ", or one without its value.\n" << USAGE;
+            exit(1);
+        }
+    }
+    Instrumentation::setTracing(!traceName.empty());
+    //the updated documents are scored exactly, so quantized impacts would
+    //be dropped by the first update
+    if (quantizationBits != 0 && !updatesName.empty()) {
+        cout << "quantization cannot be combined with updates.";
+        exit(1);
+    }
+    
+    //the shards are forked before any thread is started or file is read
+    ShardCoordinator coordinator;
+    if (nShards > 0) {
+        if (!saveIndexName.empty() || !loadIndexName.empty() || !updatesName.empty() || quantizationBits != 0 
+            || !socketName.empty() || isPositional || isWildcarded) {
+            cout << "index files, updates, quantization, serving, positions and wildcards cannot be combined with shards.";
+            exit(1);
+        }
+        //the shards only stop on a missing file, so it is reported here
+        ProcessFiles documents(documentsName, "");
+        if (documents.fail()) {
+            cout << documents.getError();
+            exit(1);
+        }
+        size_t shardThreads = nThreads > 0 ? nThreads : max(size_t(1), size_t(thread::hardware_concurrency()) / nShards);
+        bool isStarted = coordinator.start(nShards, [&](size_t shardId, int fd) {
+            return ShardWorker(shardId, nShards, fd).run(documentsName, shardThreads, batchSize, cacheSize);
+        });
+        if (!isStarted) {
+            cout << "shards starting failed.";
+            exit(1);
+        }
+    }
+    
+    ofstream outputFile;
+    if (!outputName.empty()) {
+        outputFile.open(outputName, ios::binary);
+        if (!outputFile) {
+            cout << "results file opening failed.";
+            exit(1);
+        }
+    }
+    ResultWriter writer(outputName.empty() ? cout : outputFile, format);
     
-    ifstream& i2 = p.getQueriesText();
-    p.readQueriesFile(i2);
+    if (nShards > 0) {
+        ProcessFiles p("", queriesName);
+        if (p.fail()) {
+            cout << p.getError();
+            exit(1);
+        }
+        p.readQueriesFile(p.getQueriesMapping());
+        if (!coordinator.exchangeStatistics() || !coordinator.search(p, p.getQueriesMapping().getView())) {
+            cout << "shards search failed.";
+            exit(1);
+        }
+        if (!coordinator.writeResults(writer, p)) {
+            cout << "results writing failed.";
+            exit(1);
+        }
+        if (!coordinator.stop()) {
+            cout << "a shard failed.";
+            exit(1);
+        }
+        if (!statsName.empty() && !Instrumentation::writeReport(statsName)) {
+            cout << "stats file writing failed.";
+            exit(1);
+        }
+        if (!traceName.empty() && !Instrumentation::writeTrace(traceName)) {
+            cout << "trace file writing failed.";
+            exit(1);
+        }
+        return 0;
+    }
+    QueryExecutor executor(nThreads);
     
-    TextRetrievalEngine t(&p);
-    t.computeFrequencies();
-    t.initializeIdfs();
-    t.computeDocsWeight(false);
-    t.computeDocsWeight(true);
+    //a server takes its queries from its socket
+    ProcessFiles p(loadIndexName.empty() ? documentsName : "", socketName.empty() ? queriesName : "");
+    if (p.fail()) {
+        cout << p.getError();
+        exit(1);
+    }
+    IndexBuilder builder;
+    IndexFile indexFile;
+    //both files are read through their memory mappings
+    if (loadIndexName.empty())
+        p.readDocumentsFile(p.getDocumentsMapping(), builder, executor);
+    if (socketName.empty())
+        p.readQueriesFile(p.getQueriesMapping());
+    
+    TextRetrievalEngine t(move(p));
+    t.getCache().setCapacity(cacheSize);
+    if (loadIndexName.empty()) {
+        t.computeFrequencies(move(builder));
+        t.initializeIdfs();
+        t.computeDocsWeight(false);
+    }
+    else {
+        if (!indexFile.load(loadIndexName, isVerified)) {
+            cout << indexFile.getError();
+            exit(1);
+        }
+        t.loadIndex(indexFile);
+        t.initializeIdfs();
+    }
+    if (!saveIndexName.empty() && !t.saveIndex(saveIndexName)) {
+        cout << "index file saving failed.";
+        exit(1);
+    }
+    t.quantize(quantizationBits);
+    if (isPositional)
+        t.indexPositions();
+    if (isWildcarded)
+        t.buildDictionary();
+    if (!updatesName.empty()) {
+        ifstream updates(updatesName);
+        if (!updates) {
+            cout << "updates file opening failed.";
+            exit(1);
+        }
+        string line;
+        while (getline(updates, line)) {
+            if (line.size() > 0 && line[0] == '+')
+                t.addDocument(string_view(line).substr(1));
+            else if (line.size() > 0 && line[0] == '-')
+                t.deleteDocument(strtoull(line.c_str() + 1, nullptr, 10));
+        }
+    }
 
-    t.displayResults();
+    //a server weights the terms of each query as it comes, from the
+    //documents' frequencies, so only the queries file is weighted here
+    if (!socketName.empty()) {
+        t.refreshWeights();
+        SearchServer server(t, executor);
+        if (!server.listen(socketName)) {
+            cout << "socket opening failed.";
+            exit(1);
+        }
+        runningServer = &server;
+        signal(SIGINT, stopServer);
+        signal(SIGTERM, stopServer);
+        bool isServed = server.run();
+        runningServer = nullptr;
+        cerr << "served " << server.getNRequests() << " requests" << endl;
+        if (!isServed) {
+            cout << "serving failed.";
+            exit(1);
+        }
+    }
+    else {
+        t.computeDocsWeight(true);
+        //the results are written while the queries are evaluated
+        t.computeResults(executor, batchSize, &writer);
+        if (!writer.flush()) {
+            cout << "results writing failed.";
+            exit(1);
+        }
+    }
+    
+    t.recordMemory();
+    if (!statsName.empty() && !Instrumentation::writeReport(statsName)) {
+        cout << "stats file writing failed.";
+        exit(1);
+    }
+    if (!traceName.empty() && !Instrumentation::writeTrace(traceName)) {
+        cout << "trace file writing failed.";
+        exit(1);
+    }
+    
+    if (isCacheReported) {
+        const ResultCache& cache = t.getCache();
+        cerr << "result cache: " << cache.getHits() << " hits, " << cache.getMisses() << " misses, " 
+            << cache.getEvictions() << " evictions, " << cache.getSize() << " of " << cache.getCapacity() 
+            << " bytes" << endl;
+    }
 }